@@ -0,0 +1,350 @@
+/*
+ * Graph500 style benchmark driver.
+ *
+ * Generates a Kronecker (R-MAT) graph with 2^scale vertices and
+ * edge_factor * 2^scale edges, builds it with the library, then runs
+ * BFS (and SSSP when -w is given) from random roots, validates every
+ * resulting tree and reports TEPS (traversed edges per second).
+ *
+ * Usage: graph500 [-s scale] [-e edge_factor] [-r roots] [-w] [-seed n]
+ *                 [-o rcm|degree|hub|gorder]
+ *
+ * -o reorders the nodes after construction, see GraphBase::reorder.
+ */
+#include "../graph/graph.hpp"
+#include<string.h>
+#include<math.h>
+#include<sys/resource.h>
+#include<chrono>
+#include<fstream>
+#include<numeric>
+
+typedef Graph<int> BenchGraph;
+typedef BenchGraph::Workspace Workspace;
+
+struct KroneckerEdge {
+    int src;
+    int dst;
+    float weight;
+};
+
+static double seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Resident and peak memory in kB as reported by kernel.
+static void readMemory(long& rss, long& peak) {
+    rss = peak = -1;
+    ifstream status("/proc/self/status");
+    string key;
+    while (status >> key) {
+        if (key == "VmRSS:")
+            status >> rss;
+        else if (key == "VmHWM:")
+            status >> peak;
+    }
+    if (peak < 0) {
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        peak = usage.ru_maxrss;
+    }
+}
+
+// R-MAT recursive quadrant selection with the Graph500 initiator
+// A = 0.57, B = 0.19, C = 0.19, followed by a random relabelling
+// of vertices so that high degree vertices are not clustered at 0.
+static void generateKronecker(int scale, int edge_factor, bool weighted, vector<KroneckerEdge>& edges) {
+    const double A = 0.57, B = 0.19, C = 0.19;
+    int nVertices = 1 << scale;
+    long nEdges = (long)edge_factor * nVertices;
+
+    vector<int> perm(nVertices);
+    for (int i = 0; i < nVertices; i++)
+        perm[i] = i;
+    for (int i = nVertices - 1; i > 0; i--)
+        swap(perm[i], perm[rand() % (i + 1)]);
+
+    edges.clear();
+    edges.reserve(nEdges);
+    for (long i = 0; i < nEdges; i++) {
+        int src = 0, dst = 0;
+        for (int bit = 0; bit < scale; bit++) {
+            double r = (double)rand() / RAND_MAX;
+            if (r < A) {
+            } else if (r < A + B) {
+                dst |= 1 << bit;
+            } else if (r < A + B + C) {
+                src |= 1 << bit;
+            } else {
+                src |= 1 << bit;
+                dst |= 1 << bit;
+            }
+        }
+        // Self loops do not contribute to traversal.
+        if (src == dst)
+            continue;
+        KroneckerEdge edge;
+        edge.src = perm[src];
+        edge.dst = perm[dst];
+        edge.weight = weighted ? (float)rand() / RAND_MAX : Edge::DEFAULT_WEIGHT;
+        edges.push_back(edge);
+    }
+}
+
+static long long edgeKey(int u, int v) {
+    if (u > v)
+        swap(u, v);
+    return ((long long)u << 32) | (unsigned)v;
+}
+
+// Graph500 validation: root has no parent and level 0, every tree edge
+// is a graph edge spanning exactly one level and every graph edge has
+// both or neither end point in tree spanning at most one level.
+static bool validateBFS(BenchGraph& g, const Workspace& ws, int root, const map<long long, float>& edge_set,
+                        const vector<KroneckerEdge>& edges, const vector<int>& id2idx) {
+    BenchGraph::iterator base = g.begin();
+    if (ws.getDist2Source(root) != 0 || ws.getParent(root) != -1)
+        return false;
+
+    for (int i = 0; i < g.getNodeCount(); i++) {
+        if (i == root || ws.getDist2Source(i) < 0)
+            continue;
+        int parent = ws.getParent(i);
+        if (parent < 0 || ws.getDist2Source(parent) != ws.getDist2Source(i) - 1)
+            return false;
+        if (edge_set.find(edgeKey(base[parent].getId(), base[i].getId())) == edge_set.end())
+            return false;
+    }
+
+    for (size_t i = 0; i < edges.size(); i++) {
+        int lu = ws.getDist2Source(id2idx[edges[i].src]);
+        int lv = ws.getDist2Source(id2idx[edges[i].dst]);
+        if ((lu < 0) != (lv < 0))
+            return false;
+        if (lu >= 0 && abs(lu - lv) > 1)
+            return false;
+    }
+    return true;
+}
+
+// Every edge must be relaxed and every tree edge tight.
+static bool validateSSSP(BenchGraph& g, int root, const vector<float>& dist, const vector<int>& parent,
+                         const map<long long, float>& edge_set, const vector<KroneckerEdge>& edges,
+                         const vector<int>& id2idx) {
+    const float eps = 1e-4f;
+    if (dist[root] != 0 || parent[root] != -1)
+        return false;
+
+    BenchGraph::iterator base = g.begin();
+    for (int i = 0; i < g.getNodeCount(); i++) {
+        if (i == root || dist[i] < 0)
+            continue;
+        int p = parent[i];
+        if (p < 0 || dist[p] < 0)
+            return false;
+        map<long long, float>::const_iterator it = edge_set.find(edgeKey(base[p].getId(), base[i].getId()));
+        if (it == edge_set.end() || dist[p] + it->second > dist[i] + eps)
+            return false;
+    }
+
+    for (size_t i = 0; i < edges.size(); i++) {
+        float du = dist[id2idx[edges[i].src]];
+        float dv = dist[id2idx[edges[i].dst]];
+        if ((du < 0) != (dv < 0))
+            return false;
+        if (du >= 0 && (du + edges[i].weight < dv - eps || dv + edges[i].weight < du - eps))
+            return false;
+    }
+    return true;
+}
+
+struct Summary {
+    double min, q1, median, q3, max, hmean;
+};
+
+static Summary summarize(vector<double> values) {
+    Summary s;
+    sort(values.begin(), values.end());
+    size_t n = values.size();
+    s.min = values[0];
+    s.q1 = values[n / 4];
+    s.median = values[n / 2];
+    s.q3 = values[(3 * n) / 4];
+    s.max = values[n - 1];
+    double inv = 0;
+    for (size_t i = 0; i < n; i++)
+        inv += 1.0 / values[i];
+    s.hmean = n / inv;
+    return s;
+}
+
+static void printSummary(const char* name, const Summary& s) {
+    cout << name << "_min_TEPS: " << s.min << endl;
+    cout << name << "_firstquartile_TEPS: " << s.q1 << endl;
+    cout << name << "_median_TEPS: " << s.median << endl;
+    cout << name << "_thirdquartile_TEPS: " << s.q3 << endl;
+    cout << name << "_max_TEPS: " << s.max << endl;
+    cout << name << "_harmonic_mean_TEPS: " << s.hmean << endl;
+}
+
+int main(int argc, char* argv[]) {
+    int scale = 14;
+    int edge_factor = 16;
+    int nRoots = 64;
+    bool weighted = false;
+    unsigned seed = 1;
+    const char* order = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+            scale = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc)
+            edge_factor = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+            nRoots = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-w") == 0)
+            weighted = true;
+        else if (strcmp(argv[i], "-seed") == 0 && i + 1 < argc)
+            seed = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+            order = argv[++i];
+        else {
+            cerr << "Usage: " << argv[0] << " [-s scale] [-e edge_factor] [-r roots] [-w] [-seed n] [-o rcm|degree|hub|gorder]" << endl;
+            return -1;
+        }
+    }
+    srand(seed);
+
+    cout << "SCALE: " << scale << endl;
+    cout << "edgefactor: " << edge_factor << endl;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    vector<KroneckerEdge> edges;
+    generateKronecker(scale, edge_factor, weighted, edges);
+    cout << "generation_time: " << seconds(start) << endl;
+
+    int nVertices = 1 << scale;
+    vector<int> values(nVertices);
+    BenchGraph g;
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < nVertices; i++) {
+        values[i] = i;
+        Node<int> node(values[i]);
+        g.insertNode(node);
+    }
+
+    // Node ids are global, so map them back to iteration order.
+    int max_id = 0;
+    for (BenchGraph::iterator it = g.begin(); it != g.end(); it++)
+        max_id = max(max_id, it->getId());
+    vector<int> id2idx(max_id + 1, -1);
+    for (int i = 0; i < nVertices; i++)
+        id2idx[g.begin()[i].getId()] = i;
+
+    // Kronecker end points index into iteration order, translate to ids.
+    for (size_t i = 0; i < edges.size(); i++) {
+        edges[i].src = g.begin()[edges[i].src].getId();
+        edges[i].dst = g.begin()[edges[i].dst].getId();
+        g.createEdge(g.begin()[id2idx[edges[i].src]], g.begin()[id2idx[edges[i].dst]], edges[i].weight);
+    }
+    double construction_time = seconds(start);
+    cout << "construction_time: " << construction_time << endl;
+
+    if (order != NULL) {
+        BenchGraph::ORDER strategy;
+        if (strcmp(order, "rcm") == 0)
+            strategy = BenchGraph::RCM;
+        else if (strcmp(order, "degree") == 0)
+            strategy = BenchGraph::DEGREE;
+        else if (strcmp(order, "hub") == 0)
+            strategy = BenchGraph::HUB;
+        else if (strcmp(order, "gorder") == 0)
+            strategy = BenchGraph::GORDER;
+        else {
+            cerr << "Unknown order " << order << endl;
+            return -1;
+        }
+        start = std::chrono::steady_clock::now();
+        g.reorder(strategy);
+        cout << "reorder: " << order << endl;
+        cout << "reorder_time: " << seconds(start) << endl;
+        for (int i = 0; i < nVertices; i++)
+            id2idx[g.begin()[i].getId()] = i;
+    }
+    cout << "nvertices: " << g.getNodeCount() << endl;
+    cout << "nedges: " << g.getEdgeCount() << endl;
+
+    map<long long, float> edge_set;
+    for (size_t i = 0; i < edges.size(); i++) {
+        long long key = edgeKey(edges[i].src, edges[i].dst);
+        map<long long, float>::iterator it = edge_set.find(key);
+        if (it == edge_set.end() || edges[i].weight < it->second)
+            edge_set[key] = edges[i].weight;
+    }
+
+    // Roots are sampled among vertices that have at least one edge.
+    vector<int> candidates;
+    for (int i = 0; i < nVertices; i++)
+        if (g.getOutDegreeForNode(g.begin()[i]) > 0)
+            candidates.push_back(i);
+    if (candidates.empty()) {
+        cerr << "Generated graph has no edges" << endl;
+        return -1;
+    }
+    nRoots = min(nRoots, (int)candidates.size());
+    for (int i = 0; i < nRoots; i++)
+        swap(candidates[i], candidates[i + rand() % (candidates.size() - i)]);
+
+    // One workspace for all roots, only the first run allocates.
+    Workspace ws;
+    vector<double> bfs_teps, sssp_teps, bfs_times, sssp_times;
+    for (int r = 0; r < nRoots; r++) {
+        int root = candidates[r];
+
+        start = std::chrono::steady_clock::now();
+        g.breadthFirstSearch(ws, g.begin()[root]);
+        double t = seconds(start);
+
+        if (!validateBFS(g, ws, root, edge_set, edges, id2idx)) {
+            cerr << "BFS validation failed for root " << g.begin()[root].getId() << endl;
+            return 1;
+        }
+
+        // Traversed edges are the input edges inside the root's component.
+        long traversed = 0;
+        for (size_t i = 0; i < edges.size(); i++)
+            if (ws.getDist2Source(id2idx[edges[i].src]) >= 0)
+                traversed++;
+        bfs_times.push_back(t);
+        bfs_teps.push_back(traversed / t);
+
+        if (weighted) {
+            vector<float> dist;
+            vector<int> parent;
+            start = std::chrono::steady_clock::now();
+            g.shortestPaths(g.begin()[root], dist, parent);
+            t = seconds(start);
+
+            if (!validateSSSP(g, root, dist, parent, edge_set, edges, id2idx)) {
+                cerr << "SSSP validation failed for root " << g.begin()[root].getId() << endl;
+                return 1;
+            }
+            sssp_times.push_back(t);
+            sssp_teps.push_back(traversed / t);
+        }
+    }
+
+    long rss, peak;
+    readMemory(rss, peak);
+    cout << "NBFS: " << nRoots << endl;
+    cout << "bfs_mean_time: " << accumulate(bfs_times.begin(), bfs_times.end(), 0.0) / nRoots << endl;
+    printSummary("bfs", summarize(bfs_teps));
+    if (weighted) {
+        cout << "sssp_mean_time: " << accumulate(sssp_times.begin(), sssp_times.end(), 0.0) / nRoots << endl;
+        printSummary("sssp", summarize(sssp_teps));
+    }
+    cout << "memory_rss_kB: " << rss << endl;
+    cout << "memory_peak_kB: " << peak << endl;
+    return 0;
+}
@@ -0,0 +1,590 @@
+/*
+ * Micro benchmarks for GraphBase operations.
+ *
+ * Every case is run over each (size, density) pair on a random graph
+ * built with createRandomGraph. For each case we report nanoseconds per
+ * operation, bytes allocated per operation and edges processed per
+ * second. Output is CSV by default or JSON with -json.
+ *
+ * Usage: microbench [-json] [-quick] [-filter name] [-o file]
+ */
+#include "../graph/graph.hpp"
+#include "../graph/analytics.hpp"
+#include "../graph/condensation.hpp"
+#include "../graph/partitioner.hpp"
+#include "../graph/compressed_graph.hpp"
+#include "../graph/max_flow.hpp"
+#include "../graph/bipartite_matching.hpp"
+#include "../graph/biconnected.hpp"
+#include<string.h>
+#include<new>
+#include<chrono>
+#include<fstream>
+#include<sstream>
+#include<atomic>
+
+// Allocation accounting, every heap allocation in the process
+// goes through these. Counters are atomic as the threaded cases
+// allocate from their workers.
+static std::atomic<long long> alloc_bytes(0);
+static std::atomic<long long> alloc_count(0);
+
+// Kept out of line so the compiler does not pair malloc and free
+// with the new and delete expressions they serve.
+__attribute__((noinline)) static void* countedAlloc(size_t size) {
+    alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+    alloc_count.fetch_add(1, std::memory_order_relaxed);
+    return malloc(size == 0 ? 1 : size);
+}
+
+__attribute__((noinline)) static void countedFree(void* ptr) {
+    free(ptr);
+}
+
+void* operator new(size_t size) {
+    void* ptr = countedAlloc(size);
+    if (ptr == NULL)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+    countedFree(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    countedFree(ptr);
+}
+
+typedef Graph<int> BGraph;
+
+struct Params {
+    int nVertices;
+    float density;
+    bool directed;
+};
+
+struct Result {
+    string name;
+    Params params;
+    long long ops;
+    long long edges;
+    double seconds;
+    long long bytes;
+    long long allocs;
+};
+
+// Measures one timed region: wall time and heap traffic.
+class Probe {
+    private:
+        std::chrono::steady_clock::time_point start;
+        long long bytes;
+        long long allocs;
+    public:
+        Probe() :
+            start(std::chrono::steady_clock::now()),
+            bytes(alloc_bytes.load()),
+            allocs(alloc_count.load()) {}
+
+        void stop(Result& r) {
+            r.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            r.bytes += alloc_bytes.load() - bytes;
+            r.allocs += alloc_count.load() - allocs;
+        }
+};
+
+// Owns node values so that Node references stay valid for the graph's lifetime.
+class Fixture {
+    public:
+        vector<int> values;
+        vector< Node<int>* > nodes;
+        BGraph graph;
+
+        Fixture(const Params& p, bool populate) : values(p.nVertices), graph(p.directed) {
+            for (int i = 0; i < p.nVertices; i++) {
+                values[i] = i;
+                nodes.push_back(new Node<int>(values[i]));
+            }
+            if (populate)
+                graph.createRandomGraph(p.nVertices, &nodes[0], p.density);
+        }
+
+        ~Fixture() {
+            for (size_t i = 0; i < nodes.size(); i++)
+                delete nodes[i];
+        }
+};
+
+typedef void (*BenchCase)(const Params& p, Result& r);
+
+static void benchInsertNode(const Params& p, Result& r) {
+    Fixture f(p, false);
+    Probe probe;
+    for (int i = 0; i < p.nVertices; i++)
+        f.graph.insertNode(*f.nodes[i]);
+    probe.stop(r);
+    r.ops = p.nVertices;
+}
+
+static void benchCreateEdge(const Params& p, Result& r) {
+    Fixture f(p, false);
+    for (int i = 0; i < p.nVertices; i++)
+        f.graph.insertNode(*f.nodes[i]);
+
+    long long nEdges = max(1LL, (long long)(p.density * p.nVertices * p.nVertices));
+    vector< pair<int, int> > ends;
+    for (long long i = 0; i < nEdges; i++) {
+        int idx1 = rand() % p.nVertices;
+        int idx2 = rand() % p.nVertices;
+        if (idx1 != idx2)
+            ends.push_back(make_pair(idx1, idx2));
+    }
+
+    Probe probe;
+    for (size_t i = 0; i < ends.size(); i++)
+        f.graph.createEdge(*f.nodes[ends[i].first], *f.nodes[ends[i].second]);
+    probe.stop(r);
+    r.ops = ends.size();
+    r.edges = ends.size();
+}
+
+static void benchGetNodeById(const Params& p, Result& r) {
+    Fixture f(p, true);
+    long long sum = 0;
+    Probe probe;
+    for (int i = 0; i < p.nVertices; i++)
+        sum += f.graph.getNodeById(f.nodes[rand() % p.nVertices]->getId()).getId();
+    probe.stop(r);
+    r.ops = p.nVertices;
+    if (sum == -1)
+        cerr << sum;
+}
+
+static void benchGetNodeByLabel(const Params& p, Result& r) {
+    Fixture f(p, true);
+    long long sum = 0;
+    Probe probe;
+    for (int i = 0; i < p.nVertices; i++)
+        sum += f.graph.indexOfLabel(f.nodes[rand() % p.nVertices]->getLabel());
+    probe.stop(r);
+    r.ops = p.nVertices;
+    if (sum == -1)
+        cerr << sum;
+}
+
+static void benchGetOutEdgesForNode(const Params& p, Result& r) {
+    Fixture f(p, true);
+    Probe probe;
+    for (int i = 0; i < p.nVertices; i++) {
+        vector<Edge> edges = f.graph.getOutEdgesForNode(*f.nodes[i]);
+        r.edges += edges.size();
+    }
+    probe.stop(r);
+    r.ops = p.nVertices;
+}
+
+static void benchNeighbors(const Params& p, Result& r) {
+    Fixture f(p, true);
+    long long weight = 0;
+    Probe probe;
+    for (int i = 0; i < p.nVertices; i++) {
+        for (const Edge& edge : f.graph.neighbors(*f.nodes[i])) {
+            weight += edge.getWeight();
+            r.edges++;
+        }
+    }
+    probe.stop(r);
+    r.ops = p.nVertices;
+    if (weight == -1)
+        cerr << weight;
+}
+
+static void benchBreadthFirstSearch(const Params& p, Result& r) {
+    Fixture f(p, true);
+    Probe probe;
+    f.graph.breadthFirstSearch(*f.nodes[0]);
+    probe.stop(r);
+    r.ops = 1;
+    r.edges = f.graph.getEdgeCount();
+}
+
+// One op is one source, compare ns/op with breadthFirstSearch.
+static void benchMultiSourceBFS(const Params& p, Result& r) {
+    Fixture f(p, true);
+    vector<int> sources;
+    for (int i = 0; i < DefaultSourceMask::BITS && i < p.nVertices; i++)
+        sources.push_back(f.nodes[i]->getId());
+    vector<int> dist;
+    Probe probe;
+    f.graph.multiSourceBFS(sources, dist);
+    probe.stop(r);
+    r.ops = sources.size();
+    r.edges = sources.size() * f.graph.getEdgeCount();
+}
+
+// Fixed 20 iterations, tolerance 0.
+static void benchPageRank(const Params& p, Result& r) {
+    Fixture f(p, true);
+    vector<double> rank;
+    Probe probe;
+    Analytics::pageRank(f.graph, rank, 0.85, 0, 20);
+    probe.stop(r);
+    r.ops = 1;
+    r.edges = 20LL * f.graph.getEdgeCount();
+}
+
+static void benchCountTriangles(const Params& p, Result& r) {
+    Fixture f(p, true);
+    Probe probe;
+    long long triangles = Analytics::countTriangles(f.graph);
+    probe.stop(r);
+    r.ops = 1;
+    r.edges = f.graph.getEdgeCount();
+    if (triangles == -1)
+        cerr << triangles;
+}
+
+static void benchClusteringCoefficient(const Params& p, Result& r) {
+    Fixture f(p, true);
+    vector<double> coefficient;
+    Probe probe;
+    Analytics::localClusteringCoefficient(f.graph, coefficient);
+    probe.stop(r);
+    r.ops = 1;
+    r.edges = f.graph.getEdgeCount();
+}
+
+static void benchCoreNumbers(const Params& p, Result& r) {
+    Fixture f(p, true);
+    vector<int> core;
+    Probe probe;
+    Analytics::coreNumbers(f.graph, core);
+    probe.stop(r);
+    r.ops = 1;
+    r.edges = f.graph.getEdgeCount();
+}
+
+// 32 sampled sources, one op per source.
+static void benchBetweenness(const Params& p, Result& r) {
+    Fixture f(p, true);
+    vector<double> centrality;
+    Probe probe;
+    Analytics::betweennessCentrality(f.graph, centrality, false, 32);
+    probe.stop(r);
+    r.ops = min(32, p.nVertices);
+    r.edges = r.ops * f.graph.getEdgeCount();
+}
+
+static void benchDepthFirstSearch(const Params& p, Result& r) {
+    Fixture f(p, true);
+    Probe probe;
+    f.graph.depthFirstSearch();
+    probe.stop(r);
+    r.ops = 1;
+    r.edges = f.graph.getEdgeCount();
+}
+
+static void benchTopsort(const Params& p, Result& r) {
+    Fixture f(p, true);
+    Probe probe;
+    f.graph.topsort();
+    probe.stop(r);
+    r.ops = 1;
+    r.edges = f.graph.getEdgeCount();
+}
+
+static void benchTranspose(const Params& p, Result& r) {
+    Fixture f(p, true);
+    Probe probe;
+    f.graph.transpose();
+    probe.stop(r);
+    r.ops = 1;
+    r.edges = f.graph.getEdgeCount();
+}
+
+static void benchStronglyConnectedComponents(const Params& p, Result& r) {
+    Fixture f(p, true);
+    Probe probe;
+    f.graph.stronglyConnectedComponents();
+    probe.stop(r);
+    r.ops = 1;
+    r.edges = f.graph.getEdgeCount();
+}
+
+static void benchCondensation(const Params& p, Result& r) {
+    Fixture f(p, true);
+    Probe probe;
+    Condensation cond(f.graph);
+    probe.stop(r);
+    r.ops = 1;
+    r.edges = f.graph.getEdgeCount();
+}
+
+static void benchPartition(const Params& p, Result& r, Partitioner::METHOD method) {
+    Fixture f(p, true);
+    Partitioner partitioner(8, 0.03);
+    vector<int> parts;
+    Probe probe;
+    partitioner.partition(f.graph, parts, method);
+    probe.stop(r);
+    r.ops = 1;
+    r.edges = f.graph.getEdgeCount();
+}
+
+static void benchPartitionMultilevel(const Params& p, Result& r) { benchPartition(p, r, Partitioner::MULTILEVEL);}
+static void benchPartitionLabelPropagation(const Params& p, Result& r) { benchPartition(p, r, Partitioner::LABEL_PROPAGATION);}
+
+static void benchReorder(const Params& p, Result& r, BGraph::ORDER strategy) {
+    Fixture f(p, true);
+    Probe probe;
+    f.graph.reorder(strategy);
+    probe.stop(r);
+    r.ops = 1;
+    r.edges = f.graph.getEdgeCount();
+}
+
+static void benchReorderRCM(const Params& p, Result& r) { benchReorder(p, r, BGraph::RCM);}
+static void benchReorderDegree(const Params& p, Result& r) { benchReorder(p, r, BGraph::DEGREE);}
+static void benchReorderHub(const Params& p, Result& r) { benchReorder(p, r, BGraph::HUB);}
+static void benchReorderGorder(const Params& p, Result& r) { benchReorder(p, r, BGraph::GORDER);}
+
+static void benchCompressedGraph(const Params& p, Result& r) {
+    Fixture f(p, true);
+    Probe probe;
+    CompressedGraph compressed(f.graph);
+    probe.stop(r);
+    r.ops = 1;
+    r.edges = f.graph.getEdgeCount();
+}
+
+// Compare with breadthFirstSearch, construction is not timed.
+static void benchCompressedBFS(const Params& p, Result& r) {
+    Fixture f(p, true);
+    CompressedGraph compressed(f.graph);
+    vector<int> dist;
+    Probe probe;
+    compressed.breadthFirstSearch(0, dist);
+    probe.stop(r);
+    r.ops = 1;
+    r.edges = f.graph.getEdgeCount();
+}
+
+// Weighted random graph, first node to last, arrays built untimed.
+static void benchMaxFlow(const Params& p, Result& r, MaxFlow::METHOD method) {
+    Fixture f(p, false);
+    f.graph.createRandomGraph(p.nVertices, &f.nodes[0], p.density, true);
+    MaxFlow flow(f.graph);
+    Probe probe;
+    flow.solve(0, f.graph.getNodeCount() - 1, method);
+    probe.stop(r);
+    r.ops = 1;
+    r.edges = f.graph.getEdgeCount();
+}
+
+static void benchMaxFlowFIFO(const Params& p, Result& r) { benchMaxFlow(p, r, MaxFlow::FIFO);}
+static void benchMaxFlowHighestLabel(const Params& p, Result& r) { benchMaxFlow(p, r, MaxFlow::HIGHEST_LABEL);}
+
+// Copy and DFS together, as run after every change.
+static void benchBiconnected(const Params& p, Result& r) {
+    Fixture f(p, true);
+    Probe probe;
+    Biconnected bc(f.graph);
+    probe.stop(r);
+    r.ops = 1;
+    r.edges = f.graph.getEdgeCount();
+}
+
+// Even values on the left, edges inside a side are dropped.
+struct EvenLeft {
+    bool operator()(const Node<int>& node) const { return node.getValue() % 2 == 0;}
+};
+
+static void benchBipartiteMatching(const Params& p, Result& r) {
+    Fixture f(p, true);
+    EvenLeft side;
+    BipartiteMatching matching(f.graph, side);
+    Probe probe;
+    matching.solve();
+    probe.stop(r);
+    r.ops = 1;
+    r.edges = f.graph.getEdgeCount();
+}
+
+static void benchCopyConstructor(const Params& p, Result& r) {
+    Fixture f(p, true);
+    Probe probe;
+    BGraph copy(f.graph);
+    probe.stop(r);
+    r.ops = 1;
+    r.edges = copy.getEdgeCount();
+}
+
+// Worst case for operator==, equal graphs pass the fingerprint check
+// and go through the full comparison.
+static void benchEquals(const Params& p, Result& r) {
+    Fixture f(p, true);
+    BGraph copy(f.graph);
+    Probe probe;
+    bool equal = copy == f.graph;
+    probe.stop(r);
+    assert(equal);
+    r.ops = 1;
+    r.edges = copy.getEdgeCount();
+}
+
+struct NamedCase {
+    const char* name;
+    BenchCase run;
+    bool undirected_only;
+};
+
+static const NamedCase cases[] = {
+    {"insertNode", benchInsertNode, false},
+    {"createEdge", benchCreateEdge, false},
+    {"getNodeById", benchGetNodeById, false},
+    {"getNodeByLabel", benchGetNodeByLabel, false},
+    {"getOutEdgesForNode", benchGetOutEdgesForNode, false},
+    {"neighbors", benchNeighbors, false},
+    {"breadthFirstSearch", benchBreadthFirstSearch, false},
+    {"multiSourceBFS", benchMultiSourceBFS, false},
+    {"pageRank", benchPageRank, false},
+    {"countTriangles", benchCountTriangles, false},
+    {"localClusteringCoefficient", benchClusteringCoefficient, false},
+    {"coreNumbers", benchCoreNumbers, false},
+    {"betweennessCentrality", benchBetweenness, false},
+    {"depthFirstSearch", benchDepthFirstSearch, false},
+    {"topsort", benchTopsort, false},
+    {"transpose", benchTranspose, false},
+    {"stronglyConnectedComponents", benchStronglyConnectedComponents, false},
+    {"condensation", benchCondensation, false},
+    {"partition_MULTILEVEL", benchPartitionMultilevel, false},
+    {"partition_LABEL_PROPAGATION", benchPartitionLabelPropagation, false},
+    {"reorder_RCM", benchReorderRCM, false},
+    {"reorder_DEGREE", benchReorderDegree, false},
+    {"reorder_HUB", benchReorderHub, false},
+    {"reorder_GORDER", benchReorderGorder, false},
+    {"compressedGraph", benchCompressedGraph, false},
+    {"compressedBFS", benchCompressedBFS, false},
+    {"maxFlow_FIFO", benchMaxFlowFIFO, false},
+    {"maxFlow_HIGHEST_LABEL", benchMaxFlowHighestLabel, false},
+    {"bipartiteMatching", benchBipartiteMatching, false},
+    {"biconnected", benchBiconnected, false},
+    {"copyConstructor", benchCopyConstructor, false},
+    {"equals", benchEquals, false},
+};
+
+// Repeats a case until it has run for at least min_seconds. Setup is
+// not timed, so cheap operations are capped at max_runs repetitions.
+static Result measure(const NamedCase& c, const Params& p, double min_seconds) {
+    const int max_runs = 1000;
+    Result total;
+    total.name = c.name;
+    total.params = p;
+    total.ops = total.edges = total.bytes = total.allocs = 0;
+    total.seconds = 0;
+    int runs = 0;
+    do {
+        Result r = total;
+        r.ops = r.edges = r.bytes = r.allocs = 0;
+        r.seconds = 0;
+        c.run(p, r);
+        total.ops += r.ops;
+        total.edges += r.edges;
+        total.seconds += r.seconds;
+        total.bytes += r.bytes;
+        total.allocs += r.allocs;
+    } while (total.seconds < min_seconds && ++runs < max_runs);
+    return total;
+}
+
+static void writeCSV(ostream& os, const vector<Result>& results) {
+    os << "case,vertices,density,directed,ops,ns_per_op,bytes_per_op,allocs_per_op,edges_per_sec" << endl;
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        os << r.name << ","
+           << r.params.nVertices << ","
+           << r.params.density << ","
+           << r.params.directed << ","
+           << r.ops << ","
+           << r.seconds * 1e9 / r.ops << ","
+           << (double)r.bytes / r.ops << ","
+           << (double)r.allocs / r.ops << ","
+           << (r.edges > 0 ? r.edges / r.seconds : 0) << endl;
+    }
+}
+
+static void writeJSON(ostream& os, const vector<Result>& results) {
+    os << "[" << endl;
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        os << "  {\"case\": \"" << r.name << "\""
+           << ", \"vertices\": " << r.params.nVertices
+           << ", \"density\": " << r.params.density
+           << ", \"directed\": " << (r.params.directed ? "true" : "false")
+           << ", \"ops\": " << r.ops
+           << ", \"ns_per_op\": " << r.seconds * 1e9 / r.ops
+           << ", \"bytes_per_op\": " << (double)r.bytes / r.ops
+           << ", \"allocs_per_op\": " << (double)r.allocs / r.ops
+           << ", \"edges_per_sec\": " << (r.edges > 0 ? r.edges / r.seconds : 0)
+           << "}" << (i + 1 < results.size() ? "," : "") << endl;
+    }
+    os << "]" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    bool json = false;
+    bool quick = false;
+    const char* filter = NULL;
+    const char* output = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-json") == 0)
+            json = true;
+        else if (strcmp(argv[i], "-quick") == 0)
+            quick = true;
+        else if (strcmp(argv[i], "-filter") == 0 && i + 1 < argc)
+            filter = argv[++i];
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+            output = argv[++i];
+        else {
+            cerr << "Usage: " << argv[0] << " [-json] [-quick] [-filter name] [-o file]" << endl;
+            return -1;
+        }
+    }
+
+    int sizes[] = {256, 1024, 4096};
+    float densities[] = {0.001f, 0.01f, 0.05f};
+    int nSizes = quick ? 2 : 3;
+    int nDensities = quick ? 2 : 3;
+    double min_seconds = quick ? 0.01 : 0.2;
+
+    vector<Result> results;
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        if (filter != NULL && strstr(cases[c].name, filter) == NULL)
+            continue;
+        for (int d = 0; d < 2; d++) {
+            bool directed = (d == 1);
+            if (directed && cases[c].undirected_only)
+                continue;
+            for (int s = 0; s < nSizes; s++) {
+                for (int k = 0; k < nDensities; k++) {
+                    Params p;
+                    p.nVertices = sizes[s];
+                    p.density = densities[k];
+                    p.directed = directed;
+                    results.push_back(measure(cases[c], p, min_seconds));
+                }
+            }
+        }
+    }
+
+    ofstream file;
+    if (output != NULL)
+        file.open(output);
+    ostream& os = output != NULL ? file : cout;
+    if (json)
+        writeJSON(os, results);
+    else
+        writeCSV(os, results);
+    return 0;
+}
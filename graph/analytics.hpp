@@ -0,0 +1,629 @@
+#include<vector>
+#include<queue>
+#include<algorithm>
+#include<functional>
+#include<math.h>
+#include<thread>
+#include<atomic>
+#include<mutex>
+#include<condition_variable>
+#include<random>
+#include "graph.hpp"
+#include "set_intersection.hpp"
+#ifndef __ANALYTICS__
+#define __ANALYTICS__
+using namespace std;
+
+/*
+ * Whole graph analytics run in parallel on a const graph.
+ *
+ * Graphs are read by iteration index only, getNodeCount, isDirected,
+ * getOutDegreeAt and neighborsAt, so G is a GraphBase or a
+ * CompressedGraph.
+ *
+ * Each call splits the work over std::threads. Results are indexed in
+ * node iteration order.
+ *
+ * nThreads 0 uses one thread per core. Small graphs are not worth the
+ * threads: at most one thread per 1024 nodes is started, whatever
+ * nThreads asks for.
+ */
+class Analytics {
+    public:
+        // PageRank by pulling over in edges, rank summing to 1. Rank of
+        // nodes without out edges is spread over all nodes. Stops once the
+        // L1 change of an iteration is below tolerance or after max_iters,
+        // returns the iterations run. Runs on threadCount(nThreads, V)
+        // threads.
+        template<class G>
+        static int pageRank(const G& graph, vector<double>& rank, double damping = 0.85,
+                            double tolerance = 1e-6, int max_iters = 100, int nThreads = 0);
+
+        // Triangles in the graph with directions, parallel edges and self
+        // loops ignored. Runs on threadCount(nThreads, V) threads.
+        template<class G>
+        static long long countTriangles(const G& graph, int nThreads = 0);
+        // Fraction of pairs of neighbours of each node that are joined,
+        // 0 below two neighbours. Same simple undirected view and
+        // threads as countTriangles.
+        template<class G>
+        static void localClusteringCoefficient(const G& graph, vector<double>& coefficient, int nThreads = 0);
+
+        // Core number of every node, the largest k such that it is in a
+        // subgraph where all nodes have degree k or more. Same simple
+        // undirected view as countTriangles.
+        template<class G>
+        static void coreNumbers(const G& graph, vector<int>& core, int nThreads = 0);
+
+        // Brandes betweenness: for every node the number of shortest paths
+        // between other nodes through it, as a fraction of all shortest
+        // paths between each pair, summed over pairs. Unordered pairs on
+        // undirected graphs. Hops if not weighted, else edge weights,
+        // which must be positive. With samples > 0 only that many random
+        // sources are run and the sum is scaled up to estimate the exact
+        // value.
+        template<class G>
+        static void betweennessCentrality(const G& graph, vector<double>& centrality, bool weighted = false,
+                                          int samples = 0, int nThreads = 0, unsigned seed = 1);
+
+        // Threads used for n nodes when nThreads are asked for: one per
+        // core if nThreads is 0, and never more than n / 1024 + 1, so an
+        // explicit nThreads is lowered on small graphs.
+        static int threadCount(int nThreads, int n);
+
+    private:
+        class Barrier;
+        struct PageRankArrays;
+        static void pageRankRange(PageRankArrays* arrays, int begin, int end, double* residual, double* dangling);
+        static void pageRankWorker(PageRankArrays* arrays, int t);
+
+        // Sorted neighbour lists of the simple undirected graph underneath.
+        template<class G>
+        static void undirectedAdjacency(const G& graph, vector<int>& offsets, vector<int>& targets);
+        static void countTrianglesRange(const vector<int>* offsets, const vector<int>* targets, atomic<int>* next, long long* count);
+        static void clusteringRange(const vector<int>* offsets, const vector<int>* targets, atomic<int>* next, vector<double>* coefficient);
+        static void peelRange(const vector<int>* offsets, const vector<int>* targets, atomic<int>* degree,
+                              const int* frontier, int count, int k, int* core, vector<int>* touched);
+        struct BetweennessArrays;
+        static void betweennessRange(const BetweennessArrays* arrays, atomic<int>* next, vector<double>* centrality);
+};
+
+// All of count threads wait until the last one arrives.
+class Analytics::Barrier {
+    public:
+        explicit Barrier(int count) : count(count), waiting(0), generation(0) {}
+        void wait() {
+            unique_lock<mutex> guard(lock);
+            unsigned long arrived = generation;
+            if (++waiting == count) {
+                waiting = 0;
+                generation++;
+                released.notify_all();
+                return;
+            }
+            while (arrived == generation)
+                released.wait(guard);
+        }
+
+    private:
+        mutex lock;
+        condition_variable released;
+        int count;
+        int waiting;
+        unsigned long generation;
+};
+
+// Flat copies of what an iteration reads, so the gather loops touch
+// nothing but contiguous arrays. contribution[u] is rank[u] / out degree,
+// 0 for dangling nodes, whose rank goes into base instead. Workers meet
+// at the barrier before and after each iteration, done tells them to
+// leave.
+struct Analytics::PageRankArrays {
+    vector<int> in_offsets;
+    vector<int> sources;
+    vector<double> inverse_degree;
+    vector<double> contribution;
+    vector<double> next_contribution;
+    vector<double> rank;
+    vector<double> next_rank;
+    double damping;
+    double base;
+    vector<int> bounds;
+    vector<double> residuals;
+    vector<double> danglings;
+    Barrier* barrier;
+    bool done;
+};
+
+// One thread's share of an iteration: new rank, and from it the
+// contribution for the next iteration, of nodes begin .. end - 1.
+inline void Analytics::pageRankRange(PageRankArrays* arrays, int begin, int end, double* residual, double* dangling) {
+    const int* in_offsets = arrays->in_offsets.data();
+    const int* sources = arrays->sources.data();
+    const double* contribution = arrays->contribution.data();
+    const double* inverse_degree = arrays->inverse_degree.data();
+    const double* rank = arrays->rank.data();
+    double* next_rank = arrays->next_rank.data();
+    double* next_contribution = arrays->next_contribution.data();
+
+    for (int v = begin; v < end; v++) {
+        double sum = 0;
+        for (int pos = in_offsets[v]; pos < in_offsets[v + 1]; pos++)
+            sum += contribution[sources[pos]];
+        next_rank[v] = arrays->base + arrays->damping * sum;
+    }
+    // Separate loops without gathers, these vectorize.
+    double change = 0, lost = 0;
+    for (int v = begin; v < end; v++) {
+        change += fabs(next_rank[v] - rank[v]);
+        next_contribution[v] = next_rank[v] * inverse_degree[v];
+        lost += inverse_degree[v] == 0 ? next_rank[v] : 0;
+    }
+    *residual = change;
+    *dangling = lost;
+}
+
+inline void Analytics::pageRankWorker(PageRankArrays* arrays, int t) {
+    while (true) {
+        arrays->barrier->wait();
+        if (arrays->done)
+            return;
+        pageRankRange(arrays, arrays->bounds[t], arrays->bounds[t + 1], &arrays->residuals[t], &arrays->danglings[t]);
+        arrays->barrier->wait();
+    }
+}
+
+template<class G>
+int Analytics::pageRank(const G& graph, vector<double>& rank, double damping, double tolerance,
+                        int max_iters, int nThreads) {
+    const int n = graph.getNodeCount();
+    rank.assign(n, n > 0 ? 1.0 / n : 0.0);
+    if (n == 0)
+        return 0;
+
+    PageRankArrays arrays;
+    arrays.in_offsets.assign(n + 1, 0);
+    for (int u = 0; u < n; u++) {
+        typename G::NeighborRange range = graph.neighborsAt(u);
+        for (typename G::NeighborRange::iterator it = range.begin(); it != range.end(); ++it)
+            arrays.in_offsets[it.otherIndex() + 1]++;
+    }
+    for (int v = 0; v < n; v++)
+        arrays.in_offsets[v + 1] += arrays.in_offsets[v];
+    arrays.sources.resize(arrays.in_offsets[n]);
+    vector<int> cursor(arrays.in_offsets.begin(), arrays.in_offsets.end() - 1);
+    arrays.inverse_degree.resize(n);
+    double dangling = 0;
+    for (int u = 0; u < n; u++) {
+        typename G::NeighborRange range = graph.neighborsAt(u);
+        for (typename G::NeighborRange::iterator it = range.begin(); it != range.end(); ++it)
+            arrays.sources[cursor[it.otherIndex()]++] = u;
+        int degree = graph.getOutDegreeAt(u);
+        arrays.inverse_degree[u] = degree > 0 ? 1.0 / degree : 0.0;
+        if (degree == 0)
+            dangling += rank[u];
+    }
+    arrays.contribution.resize(n);
+    for (int u = 0; u < n; u++)
+        arrays.contribution[u] = rank[u] * arrays.inverse_degree[u];
+    arrays.next_contribution.resize(n);
+    arrays.rank.swap(rank);
+    arrays.next_rank.resize(n);
+    arrays.damping = damping;
+
+    // Ranges of about equal nodes plus in edges. Workers are started
+    // once and run every iteration between two barrier waits, the
+    // calling thread takes the first range and sums up in between.
+    nThreads = threadCount(nThreads, n);
+    arrays.bounds.assign(nThreads + 1, n);
+    arrays.bounds[0] = 0;
+    long long work = (long long)n + arrays.in_offsets[n];
+    for (int t = 1, v = 0; t < nThreads; t++) {
+        while (v < n && (long long)v + arrays.in_offsets[v] < work * t / nThreads)
+            v++;
+        arrays.bounds[t] = v;
+    }
+    arrays.residuals.assign(nThreads, 0);
+    arrays.danglings.assign(nThreads, 0);
+    Barrier barrier(nThreads);
+    arrays.barrier = &barrier;
+    arrays.done = false;
+    vector<thread> workers;
+    for (int t = 1; t < nThreads; t++)
+        workers.push_back(thread(pageRankWorker, &arrays, t));
+
+    int iter = 0;
+    while (iter < max_iters) {
+        arrays.base = (1 - damping + damping * dangling) / n;
+        barrier.wait();
+        pageRankRange(&arrays, arrays.bounds[0], arrays.bounds[1], &arrays.residuals[0], &arrays.danglings[0]);
+        barrier.wait();
+
+        double residual = 0;
+        dangling = 0;
+        for (int t = 0; t < nThreads; t++) {
+            residual += arrays.residuals[t];
+            dangling += arrays.danglings[t];
+        }
+        arrays.rank.swap(arrays.next_rank);
+        arrays.contribution.swap(arrays.next_contribution);
+        iter++;
+        if (residual < tolerance)
+            break;
+    }
+    arrays.done = true;
+    barrier.wait();
+    for (size_t t = 0; t < workers.size(); t++)
+        workers[t].join();
+    rank.swap(arrays.rank);
+    return iter;
+}
+
+// One thread per core when nThreads is 0, at most one per 1024 nodes.
+inline int Analytics::threadCount(int nThreads, int n) {
+    if (nThreads <= 0)
+        nThreads = thread::hardware_concurrency();
+    return max(1, min(nThreads, n / 1024 + 1));
+}
+
+template<class G>
+void Analytics::undirectedAdjacency(const G& graph, vector<int>& offsets, vector<int>& targets) {
+    const int n = graph.getNodeCount();
+    vector<int> degree(n, 0);
+    for (int u = 0; u < n; u++) {
+        typename G::NeighborRange range = graph.neighborsAt(u);
+        for (typename G::NeighborRange::iterator it = range.begin(); it != range.end(); ++it) {
+            degree[u]++;
+            if (graph.isDirected())
+                degree[it.otherIndex()]++;
+        }
+    }
+    offsets.assign(n + 1, 0);
+    for (int u = 0; u < n; u++)
+        offsets[u + 1] = offsets[u] + degree[u];
+    targets.resize(offsets[n]);
+    vector<int> cursor(offsets.begin(), offsets.end() - 1);
+    for (int u = 0; u < n; u++) {
+        typename G::NeighborRange range = graph.neighborsAt(u);
+        for (typename G::NeighborRange::iterator it = range.begin(); it != range.end(); ++it) {
+            int v = it.otherIndex();
+            targets[cursor[u]++] = v;
+            if (graph.isDirected())
+                targets[cursor[v]++] = u;
+        }
+    }
+    // Sort, drop repeats and self loops, compact in place.
+    int out = 0;
+    for (int u = 0; u < n; u++) {
+        int begin = offsets[u], end = offsets[u + 1];
+        sort(targets.begin() + begin, targets.begin() + end);
+        offsets[u] = out;
+        for (int pos = begin; pos < end; pos++)
+            if (targets[pos] != u && (pos == begin || targets[pos] != targets[pos - 1]))
+                targets[out++] = targets[pos];
+    }
+    offsets[n] = out;
+    targets.resize(out);
+}
+
+// Nodes are handed out in blocks from a shared counter, so threads that
+// get hubs do not hold up the rest.
+inline void Analytics::countTrianglesRange(const vector<int>* offsets, const vector<int>* targets, atomic<int>* next, long long* count) {
+    const int n = offsets->size() - 1;
+    const int* off = offsets->data();
+    const int* adj = targets->data();
+    long long found = 0;
+    for (int begin = next->fetch_add(256); begin < n; begin = next->fetch_add(256))
+        for (int u = begin; u < min(n, begin + 256); u++)
+            for (int pos = off[u]; pos < off[u + 1]; pos++)
+                found += intersectionSize(adj + off[u], off[u + 1] - off[u], adj + off[adj[pos]], off[adj[pos] + 1] - off[adj[pos]]);
+    *count = found;
+}
+
+// Every edge is kept at its end of lower (degree, index) only, each
+// triangle is then found once, from its lowest node, and lists of hubs
+// stay short.
+template<class G>
+long long Analytics::countTriangles(const G& graph, int nThreads) {
+    const int n = graph.getNodeCount();
+    vector<int> offsets, targets;
+    undirectedAdjacency(graph, offsets, targets);
+
+    vector<int> oriented_offsets(n + 1, 0), oriented;
+    oriented.reserve(targets.size() / 2);
+    for (int u = 0; u < n; u++) {
+        int du = offsets[u + 1] - offsets[u];
+        for (int pos = offsets[u]; pos < offsets[u + 1]; pos++) {
+            int v = targets[pos], dv = offsets[v + 1] - offsets[v];
+            if (du < dv || (du == dv && u < v))
+                oriented.push_back(v);
+        }
+        oriented_offsets[u + 1] = oriented.size();
+    }
+
+    nThreads = threadCount(nThreads, n);
+    atomic<int> next(0);
+    vector<long long> counts(nThreads, 0);
+    vector<thread> workers;
+    for (int t = 1; t < nThreads; t++)
+        workers.push_back(thread(countTrianglesRange, &oriented_offsets, &oriented, &next, &counts[t]));
+    countTrianglesRange(&oriented_offsets, &oriented, &next, &counts[0]);
+    for (size_t t = 0; t < workers.size(); t++)
+        workers[t].join();
+    long long total = 0;
+    for (int t = 0; t < nThreads; t++)
+        total += counts[t];
+    return total;
+}
+
+// Triangles at u are half the common neighbours summed over its
+// neighbours. Full lists, each node writes only its own coefficient.
+inline void Analytics::clusteringRange(const vector<int>* offsets, const vector<int>* targets, atomic<int>* next, vector<double>* coefficient) {
+    const int n = offsets->size() - 1;
+    const int* off = offsets->data();
+    const int* adj = targets->data();
+    for (int begin = next->fetch_add(256); begin < n; begin = next->fetch_add(256)) {
+        for (int u = begin; u < min(n, begin + 256); u++) {
+            long long degree = off[u + 1] - off[u];
+            if (degree < 2) {
+                (*coefficient)[u] = 0;
+                continue;
+            }
+            long long common = 0;
+            for (int pos = off[u]; pos < off[u + 1]; pos++)
+                common += intersectionSize(adj + off[u], degree, adj + off[adj[pos]], off[adj[pos] + 1] - off[adj[pos]]);
+            (*coefficient)[u] = (double)common / (degree * (degree - 1));
+        }
+    }
+}
+
+template<class G>
+void Analytics::localClusteringCoefficient(const G& graph, vector<double>& coefficient, int nThreads) {
+    const int n = graph.getNodeCount();
+    vector<int> offsets, targets;
+    undirectedAdjacency(graph, offsets, targets);
+    coefficient.assign(n, 0);
+
+    nThreads = threadCount(nThreads, n);
+    atomic<int> next(0);
+    vector<thread> workers;
+    for (int t = 1; t < nThreads; t++)
+        workers.push_back(thread(clusteringRange, &offsets, &targets, &next, &coefficient));
+    clusteringRange(&offsets, &targets, &next, &coefficient);
+    for (size_t t = 0; t < workers.size(); t++)
+        workers[t].join();
+}
+
+// Peels the given nodes of degree k. A neighbour still above k loses
+// one, the thread that brings it down to k peels it next from its own
+// queue, so a node is peeled once and threads only meet on the counters.
+// Decrements that would go below k are undone, a node at k is already
+// being peeled. Neighbours left above k are added to touched.
+inline void Analytics::peelRange(const vector<int>* offsets, const vector<int>* targets, atomic<int>* degree,
+                                 const int* frontier, int count, int k, int* core, vector<int>* touched) {
+    const int* off = offsets->data();
+    const int* adj = targets->data();
+    vector<int> queue(frontier, frontier + count);
+    while (!queue.empty()) {
+        int v = queue.back();
+        queue.pop_back();
+        core[v] = k;
+        for (int pos = off[v]; pos < off[v + 1]; pos++) {
+            int u = adj[pos];
+            if (degree[u].load(memory_order_relaxed) <= k)
+                continue;
+            int before = degree[u].fetch_sub(1, memory_order_relaxed);
+            if (before == k + 1)
+                queue.push_back(u);
+            else if (before <= k)
+                degree[u].fetch_add(1, memory_order_relaxed);
+            else
+                touched->push_back(u);
+        }
+    }
+}
+
+// Level by level peeling from degree buckets, each level one fork and
+// join. buckets[d] holds nodes as last seen at degree d: all nodes at
+// the start, then after each level the nodes whose degree dropped, at
+// their new degree. Entries whose degree moved on or that were peeled
+// are skipped. Every node left after level k has degree above k, so k
+// only goes up and each bucket is read once: O(V + E + max degree) on
+// top of the peeling itself.
+template<class G>
+void Analytics::coreNumbers(const G& graph, vector<int>& core, int nThreads) {
+    const int n = graph.getNodeCount();
+    vector<int> offsets, targets;
+    undirectedAdjacency(graph, offsets, targets);
+    core.assign(n, -1);
+
+    vector< atomic<int> > degree(n);
+    int max_degree = 0;
+    for (int v = 0; v < n; v++) {
+        degree[v].store(offsets[v + 1] - offsets[v]);
+        max_degree = max(max_degree, offsets[v + 1] - offsets[v]);
+    }
+    vector< vector<int> > buckets(max_degree + 1);
+    for (int v = 0; v < n; v++)
+        buckets[offsets[v + 1] - offsets[v]].push_back(v);
+
+    nThreads = threadCount(nThreads, n);
+    vector< vector<int> > touched(nThreads);
+    // Level a node last went into the frontier at, as a bucket can hold
+    // the same node more than once.
+    vector<int> queued(n, -1);
+    vector<int> frontier;
+    vector<thread> workers;
+    for (int k = 0; k <= max_degree; k++) {
+        frontier.clear();
+        for (size_t i = 0; i < buckets[k].size(); i++) {
+            int v = buckets[k][i];
+            if (core[v] == -1 && queued[v] != k && degree[v].load() == k) {
+                queued[v] = k;
+                frontier.push_back(v);
+            }
+        }
+        vector<int>().swap(buckets[k]);
+        if (frontier.empty())
+            continue;
+
+        int count = frontier.size();
+        int share = (count + nThreads - 1) / nThreads;
+        workers.clear();
+        for (int t = 1; t < nThreads && t * share < count; t++)
+            workers.push_back(thread(peelRange, &offsets, &targets, degree.data(),
+                                     frontier.data() + t * share, min(share, count - t * share), k, core.data(), &touched[t]));
+        peelRange(&offsets, &targets, degree.data(), frontier.data(), min(share, count), k, core.data(), &touched[0]);
+        for (size_t t = 0; t < workers.size(); t++)
+            workers[t].join();
+
+        for (int t = 0; t < nThreads; t++) {
+            for (size_t i = 0; i < touched[t].size(); i++) {
+                int u = touched[t][i];
+                if (core[u] == -1)
+                    buckets[degree[u].load()].push_back(u);
+            }
+            touched[t].clear();
+        }
+    }
+}
+
+struct Analytics::BetweennessArrays {
+    vector<int> offsets;
+    vector<int> targets;
+    vector<double> weights;
+    vector<int> sources;
+    bool weighted;
+};
+
+// One thread runs sources from the shared list with its own dist, path
+// counts and dependencies, reset after each source only where touched.
+// Shortest path successors are found again from dist while accumulating,
+// so no predecessor lists are kept.
+inline void Analytics::betweennessRange(const BetweennessArrays* arrays, atomic<int>* next, vector<double>* centrality) {
+    const int n = arrays->offsets.size() - 1;
+    const int* off = arrays->offsets.data();
+    const int* adj = arrays->targets.data();
+    const double* weight = arrays->weights.data();
+    vector<double> dist(n, -1), sigma(n, 0), delta(n, 0);
+    vector<int> order;
+    order.reserve(n);
+    typedef pair<double, int> dist_idx;
+    priority_queue<dist_idx, vector<dist_idx>, greater<dist_idx> > pq;
+
+    for (int i = next->fetch_add(1); i < (int)arrays->sources.size(); i = next->fetch_add(1)) {
+        int source = arrays->sources[i];
+        dist[source] = 0;
+        sigma[source] = 1;
+        order.push_back(source);
+        if (!arrays->weighted) {
+            for (size_t head = 0; head < order.size(); head++) {
+                int v = order[head];
+                for (int pos = off[v]; pos < off[v + 1]; pos++) {
+                    int w = adj[pos];
+                    if (dist[w] < 0) {
+                        dist[w] = dist[v] + 1;
+                        order.push_back(w);
+                    }
+                    if (dist[w] == dist[v] + 1)
+                        sigma[w] += sigma[v];
+                }
+            }
+        } else {
+            // order gets nodes as they settle, sigma of a node is final
+            // by then as weights are positive.
+            order.clear();
+            pq.push(dist_idx(0, source));
+            while (!pq.empty()) {
+                double d = pq.top().first;
+                int v = pq.top().second;
+                pq.pop();
+                if (d > dist[v])
+                    continue;
+                order.push_back(v);
+                for (int pos = off[v]; pos < off[v + 1]; pos++) {
+                    int w = adj[pos];
+                    double through = dist[v] + weight[pos];
+                    if (dist[w] < 0 || through < dist[w]) {
+                        dist[w] = through;
+                        sigma[w] = sigma[v];
+                        pq.push(dist_idx(through, w));
+                    } else if (through == dist[w]) {
+                        sigma[w] += sigma[v];
+                    }
+                }
+            }
+        }
+
+        for (size_t k = order.size(); k-- > 0; ) {
+            int v = order[k];
+            for (int pos = off[v]; pos < off[v + 1]; pos++) {
+                int w = adj[pos];
+                double step = arrays->weighted ? weight[pos] : 1;
+                if (dist[w] == dist[v] + step)
+                    delta[v] += sigma[v] / sigma[w] * (1 + delta[w]);
+            }
+            if (v != source)
+                (*centrality)[v] += delta[v];
+        }
+        for (size_t k = 0; k < order.size(); k++) {
+            dist[order[k]] = -1;
+            sigma[order[k]] = 0;
+            delta[order[k]] = 0;
+        }
+        order.clear();
+    }
+}
+
+template<class G>
+void Analytics::betweennessCentrality(const G& graph, vector<double>& centrality, bool weighted,
+                                      int samples, int nThreads, unsigned seed) {
+    const int n = graph.getNodeCount();
+    centrality.assign(n, 0);
+    if (n == 0)
+        return;
+
+    BetweennessArrays arrays;
+    arrays.weighted = weighted;
+    arrays.offsets.assign(n + 1, 0);
+    for (int v = 0; v < n; v++)
+        arrays.offsets[v + 1] = arrays.offsets[v] + graph.getOutDegreeAt(v);
+    arrays.targets.resize(arrays.offsets[n]);
+    arrays.weights.resize(weighted ? arrays.offsets[n] : 0);
+    for (int v = 0; v < n; v++) {
+        int pos = arrays.offsets[v];
+        typename G::NeighborRange range = graph.neighborsAt(v);
+        for (typename G::NeighborRange::iterator it = range.begin(); it != range.end(); ++it, pos++) {
+            arrays.targets[pos] = it.otherIndex();
+            if (weighted)
+                arrays.weights[pos] = it.getWeight();
+        }
+    }
+    arrays.sources.resize(n);
+    for (int v = 0; v < n; v++)
+        arrays.sources[v] = v;
+    double scale = graph.isDirected() ? 1 : 0.5;
+    if (samples > 0 && samples < n) {
+        mt19937 rng(seed);
+        for (int i = 0; i < samples; i++)
+            swap(arrays.sources[i], arrays.sources[i + rng() % (n - i)]);
+        arrays.sources.resize(samples);
+        scale *= (double)n / samples;
+    }
+
+    nThreads = max(1, min(threadCount(nThreads, n), (int)arrays.sources.size()));
+    atomic<int> next(0);
+    vector< vector<double> > partial(nThreads - 1, vector<double>(n, 0));
+    vector<thread> workers;
+    for (int t = 1; t < nThreads; t++)
+        workers.push_back(thread(betweennessRange, &arrays, &next, &partial[t - 1]));
+    betweennessRange(&arrays, &next, &centrality);
+    for (size_t t = 0; t < workers.size(); t++) {
+        workers[t].join();
+        for (int v = 0; v < n; v++)
+            centrality[v] += partial[t][v];
+    }
+    for (int v = 0; v < n; v++)
+        centrality[v] *= scale;
+}
+#endif
@@ -0,0 +1,191 @@
+#include<vector>
+#include<utility>
+#include<algorithm>
+#include "graph.hpp"
+#ifndef __BICONNECTED__
+#define __BICONNECTED__
+using namespace std;
+
+/*
+ * Bridges, articulation points and biconnected components of a graph,
+ * directions ignored.
+ *
+ * Biconnected components partition the edges: two edges are in the same
+ * one if some simple cycle goes through both. A bridge is an edge alone
+ * in its component, an articulation point a node in two or more. Self
+ * loops belong to no component (-1). Parallel edges are told apart by
+ * edge id, so a doubled edge is a cycle and not a bridge.
+ *
+ * One iterative DFS computes low links in O(V + E).
+ */
+class Biconnected {
+    public:
+        Biconnected() : component_offsets(1, 0) {}
+        template<class V, class E>
+        explicit Biconnected(const GraphBase<V,E>& graph);
+
+        int getNodeCount() const { return articulation.size();}
+        bool isArticulationPoint(int idx) const { return articulation[idx];}
+        // Iteration indices of the articulation points, increasing.
+        void getArticulationPoints(vector<int>& points) const;
+
+        // Bridges as edge ids, in the order the DFS closed them.
+        int getBridgeCount() const { return bridges.size();}
+        int getBridge(int i) const { return bridges[i];}
+        bool isBridge(int edge_id) const;
+
+        int getComponentCount() const { return component_offsets.size() - 1;}
+        // Component of edge edge_id, -1 for self loops and unknown ids.
+        int getEdgeComponent(int edge_id) const;
+        // Edge ids of component c.
+        int getComponentSize(int c) const { return component_offsets[c + 1] - component_offsets[c];}
+        const int* edgesBegin(int c) const { return component_edges.data() + component_offsets[c];}
+        const int* edgesEnd(int c) const { return component_edges.data() + component_offsets[c + 1];}
+
+    private:
+        vector<char> articulation;
+        vector<int> bridges;
+        vector<int> component_offsets;
+        vector<int> component_edges;
+        // (edge id, component) sorted by id.
+        vector< pair<int, int> > edge_components;
+
+        void build(int n, const vector<int>& offsets, const vector<int>& targets, const vector<int>& ids);
+};
+
+// Undirected view: halves of undirected edges are already in both lists,
+// directed edges are added again from the other end. Both halves carry
+// the edge id.
+template<class V, class E>
+Biconnected::Biconnected(const GraphBase<V,E>& graph) :
+    component_offsets(1, 0) {
+    int n = graph.getNodeCount();
+    vector<int> offsets(n + 1, 0);
+    for (int i = 0; i < n; i++) {
+        EdgeRange<const E> range = graph.neighborsAt(i);
+        for (typename EdgeRange<const E>::iterator it = range.begin(); it != range.end(); ++it) {
+            offsets[i + 1]++;
+            if (graph.isDirected())
+                offsets[it.otherIndex() + 1]++;
+        }
+    }
+    for (int i = 0; i < n; i++)
+        offsets[i + 1] += offsets[i];
+    vector<int> targets(offsets[n]), ids(offsets[n]);
+    vector<int> cursor(offsets.begin(), offsets.end() - 1);
+    for (int i = 0; i < n; i++) {
+        EdgeRange<const E> range = graph.neighborsAt(i);
+        for (typename EdgeRange<const E>::iterator it = range.begin(); it != range.end(); ++it) {
+            int other = it.otherIndex();
+            int pos = cursor[i]++;
+            targets[pos] = other;
+            ids[pos] = it->getId();
+            if (graph.isDirected()) {
+                pos = cursor[other]++;
+                targets[pos] = i;
+                ids[pos] = it->getId();
+            }
+        }
+    }
+    build(n, offsets, targets, ids);
+}
+
+// Hopcroft-Tarjan with explicit stacks. A frame is a node, its next arc
+// and the id of the edge it was entered by, which is the only arc back
+// to the parent that is skipped. Tree and back edges go on an edge stack
+// once, from the deeper end; when a child w of v finishes with
+// low[w] >= entry[v] the edges above the tree edge v - w form a
+// component.
+inline void Biconnected::build(int n, const vector<int>& offsets, const vector<int>& targets, const vector<int>& ids) {
+    articulation.assign(n, 0);
+    bridges.clear();
+    component_offsets.assign(1, 0);
+    component_edges.clear();
+    edge_components.clear();
+
+    vector<int> entry(n, -1), low(n, 0);
+    struct Frame {
+        int idx;
+        int pos;
+        int parent_edge;
+    };
+    vector<Frame> stack;
+    vector<int> edge_stack;
+    int clock = 0;
+    for (int root = 0; root < n; root++) {
+        if (entry[root] != -1)
+            continue;
+        entry[root] = low[root] = clock++;
+        Frame frame = {root, offsets[root], -1};
+        stack.push_back(frame);
+        int root_children = 0;
+        while (!stack.empty()) {
+            Frame& top = stack.back();
+            int v = top.idx;
+            if (top.pos < offsets[v + 1]) {
+                int pos = top.pos++;
+                int w = targets[pos];
+                if (w == v || ids[pos] == top.parent_edge)
+                    continue;
+                if (entry[w] == -1) {
+                    edge_stack.push_back(ids[pos]);
+                    entry[w] = low[w] = clock++;
+                    Frame child = {w, offsets[w], ids[pos]};
+                    stack.push_back(child);
+                    if (v == root)
+                        root_children++;
+                } else if (entry[w] < entry[v]) {
+                    edge_stack.push_back(ids[pos]);
+                    low[v] = min(low[v], entry[w]);
+                }
+                continue;
+            }
+
+            int w = v, tree_edge = top.parent_edge;
+            stack.pop_back();
+            if (stack.empty())
+                break;
+            v = stack.back().idx;
+            low[v] = min(low[v], low[w]);
+            if (low[w] < entry[v])
+                continue;
+            if (low[w] > entry[v])
+                bridges.push_back(tree_edge);
+            if (v != root)
+                articulation[v] = 1;
+            int c = getComponentCount();
+            int e;
+            do {
+                e = edge_stack.back();
+                edge_stack.pop_back();
+                component_edges.push_back(e);
+                edge_components.push_back(pair<int, int>(e, c));
+            } while (e != tree_edge);
+            component_offsets.push_back(component_edges.size());
+        }
+        if (root_children > 1)
+            articulation[root] = 1;
+    }
+    sort(edge_components.begin(), edge_components.end());
+}
+
+inline void Biconnected::getArticulationPoints(vector<int>& points) const {
+    points.clear();
+    for (int i = 0; i < getNodeCount(); i++)
+        if (articulation[i])
+            points.push_back(i);
+}
+
+inline int Biconnected::getEdgeComponent(int edge_id) const {
+    vector< pair<int, int> >::const_iterator it =
+        lower_bound(edge_components.begin(), edge_components.end(), pair<int, int>(edge_id, -1));
+    if (it == edge_components.end() || it->first != edge_id)
+        return -1;
+    return it->second;
+}
+
+inline bool Biconnected::isBridge(int edge_id) const {
+    int c = getEdgeComponent(edge_id);
+    return c != -1 && getComponentSize(c) == 1;
+}
+#endif
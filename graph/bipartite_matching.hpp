@@ -0,0 +1,367 @@
+#include<vector>
+#include<algorithm>
+#include<math.h>
+#include "graph.hpp"
+#ifndef __BIPARTITE_MATCHING__
+#define __BIPARTITE_MATCHING__
+using namespace std;
+
+/*
+ * Matchings of a bipartite graph, directions ignored.
+ *
+ * Sides come from a callback, isLeft(node) true for the left side, or
+ * from a 2-colouring of the graph, which leaves isBipartite() false and
+ * the matching empty if there is an odd cycle. Edges inside one side are
+ * ignored. A matching can be solved again without the graph.
+ *
+ * solve is Hopcroft-Karp: a BFS layers the left side by distance from the
+ * free left nodes, then iterative DFS along the layers augments a maximal
+ * set of shortest disjoint paths, O(E sqrt(V)). solveWeighted is the
+ * Hungarian algorithm over the dense left x right cost matrix with the
+ * smaller side as rows, O(S^2 B) time and O(S B) memory for sides of S
+ * and B nodes, S <= B. Few tasks among many workers stay cheap.
+ */
+class BipartiteMatching {
+    public:
+        template<class V, class E>
+        explicit BipartiteMatching(const GraphBase<V,E>& graph);
+        template<class V, class E, class Side>
+        BipartiteMatching(const GraphBase<V,E>& graph, Side& isLeft);
+
+        bool isBipartite() const { return bipartite;}
+        int getNodeCount() const { return left.size();}
+        bool isLeft(int idx) const { return left[idx];}
+
+        // Maximum cardinality matching, returns its size.
+        int solve();
+        // Among the matchings of maximum cardinality the one of least total
+        // edge weight, or greatest if maximize. Returns the total weight.
+        double solveWeighted(bool maximize = false);
+
+        int getSize() const { return size;}
+        // Node matched to idx, -1 if unmatched.
+        int getMate(int idx) const { return mates[idx];}
+
+    private:
+        bool bipartite;
+        int size;
+        vector<char> left;
+        vector<int> mates;
+        // Left nodes and their right neighbours, with the edge weights.
+        vector<int> left_nodes;
+        // Position in left_nodes of each node, -1 on the right.
+        vector<int> left_position;
+        vector<int> offsets;
+        vector<int> targets;
+        vector<double> weights;
+
+        template<class V, class E>
+        void build(const GraphBase<V,E>& graph);
+        bool layer(vector<int>& dist) const;
+        bool augment(int root, vector<int>& dist, vector<int>& next, vector<int>& stack);
+};
+
+template<class V, class E>
+BipartiteMatching::BipartiteMatching(const GraphBase<V,E>& graph) :
+    bipartite(true),
+    size(0),
+    left(graph.getNodeCount(), 0),
+    mates(graph.getNodeCount(), -1) {
+    // 2-colouring by BFS, every edge seen from both ends so that
+    // directed graphs colour like undirected ones.
+    int n = graph.getNodeCount();
+    vector< vector<int> > undirected;
+    if (graph.isDirected()) {
+        undirected.resize(n);
+        for (int u = 0; u < n; u++) {
+            EdgeRange<const E> range = graph.neighborsAt(u);
+            for (typename EdgeRange<const E>::iterator it = range.begin(); it != range.end(); ++it)
+                undirected[it.otherIndex()].push_back(u);
+        }
+    }
+    vector<int> colour(n, -1), bfs;
+    for (int root = 0; root < n && bipartite; root++) {
+        if (colour[root] != -1)
+            continue;
+        colour[root] = 1;
+        bfs.assign(1, root);
+        for (size_t head = 0; head < bfs.size() && bipartite; head++) {
+            int u = bfs[head];
+            EdgeRange<const E> range = graph.neighborsAt(u);
+            vector<int> others;
+            for (typename EdgeRange<const E>::iterator it = range.begin(); it != range.end(); ++it)
+                others.push_back(it.otherIndex());
+            if (graph.isDirected())
+                others.insert(others.end(), undirected[u].begin(), undirected[u].end());
+            for (size_t i = 0; i < others.size(); i++) {
+                int v = others[i];
+                if (colour[v] == -1) {
+                    colour[v] = 1 - colour[u];
+                    bfs.push_back(v);
+                } else if (colour[v] == colour[u]) {
+                    bipartite = false;
+                    break;
+                }
+            }
+        }
+    }
+    if (!bipartite) {
+        offsets.assign(1, 0);
+        return;
+    }
+    for (int u = 0; u < n; u++)
+        left[u] = colour[u] == 1;
+    build(graph);
+}
+
+template<class V, class E, class Side>
+BipartiteMatching::BipartiteMatching(const GraphBase<V,E>& graph, Side& isLeft) :
+    bipartite(true),
+    size(0),
+    left(graph.getNodeCount(), 0),
+    mates(graph.getNodeCount(), -1) {
+    typename GraphBase<V,E>::const_iterator node = graph.cbegin();
+    for (int u = 0; u < graph.getNodeCount(); u++, node++)
+        left[u] = isLeft(*node);
+    build(graph);
+}
+
+// Edges are taken from whichever end is on the left, the other end must
+// be on the right.
+template<class V, class E>
+void BipartiteMatching::build(const GraphBase<V,E>& graph) {
+    int n = graph.getNodeCount();
+    vector<int>& position = left_position;
+    position.assign(n, -1);
+    for (int u = 0; u < n; u++) {
+        if (left[u]) {
+            position[u] = left_nodes.size();
+            left_nodes.push_back(u);
+        }
+    }
+    int count = left_nodes.size();
+    offsets.assign(count + 1, 0);
+    for (int u = 0; u < n; u++) {
+        EdgeRange<const E> range = graph.neighborsAt(u);
+        for (typename EdgeRange<const E>::iterator it = range.begin(); it != range.end(); ++it) {
+            int v = it.otherIndex();
+            if (left[u] && !left[v])
+                offsets[position[u] + 1]++;
+            else if (graph.isDirected() && !left[u] && left[v])
+                offsets[position[v] + 1]++;
+        }
+    }
+    for (int i = 0; i < count; i++)
+        offsets[i + 1] += offsets[i];
+    targets.resize(offsets[count]);
+    weights.resize(offsets[count]);
+    vector<int> cursor(offsets.begin(), offsets.end() - 1);
+    for (int u = 0; u < n; u++) {
+        EdgeRange<const E> range = graph.neighborsAt(u);
+        for (typename EdgeRange<const E>::iterator it = range.begin(); it != range.end(); ++it) {
+            int v = it.otherIndex();
+            int pos = -1;
+            if (left[u] && !left[v]) {
+                pos = cursor[position[u]]++;
+                targets[pos] = v;
+            } else if (graph.isDirected() && !left[u] && left[v]) {
+                pos = cursor[position[v]]++;
+                targets[pos] = u;
+            }
+            if (pos != -1)
+                weights[pos] = it->getWeight();
+        }
+    }
+}
+
+// dist of left node i is its layer, from the free left nodes at 0. True
+// if some free right node is reachable.
+inline bool BipartiteMatching::layer(vector<int>& dist) const {
+    int count = left_nodes.size();
+    vector<int> queue;
+    queue.reserve(count);
+    dist.assign(count, -1);
+    const vector<int>& position = left_position;
+    for (int i = 0; i < count; i++) {
+        if (mates[left_nodes[i]] == -1) {
+            dist[i] = 0;
+            queue.push_back(i);
+        }
+    }
+    bool found = false;
+    for (size_t head = 0; head < queue.size(); head++) {
+        int i = queue[head];
+        for (int pos = offsets[i]; pos < offsets[i + 1]; pos++) {
+            int mate = mates[targets[pos]];
+            if (mate == -1) {
+                found = true;
+            } else if (dist[position[mate]] == -1) {
+                dist[position[mate]] = dist[i] + 1;
+                queue.push_back(position[mate]);
+            }
+        }
+    }
+    return found;
+}
+
+// DFS along the layers from free left node root with an explicit stack.
+// next[i] is the next arc of left node i to try, so over one phase every
+// arc is looked at once. Dead ends leave the layering.
+inline bool BipartiteMatching::augment(int root, vector<int>& dist, vector<int>& next, vector<int>& stack) {
+    stack.assign(1, root);
+    while (!stack.empty()) {
+        int i = stack.back();
+        if (next[i] == offsets[i + 1]) {
+            dist[i] = -1;
+            stack.pop_back();
+            continue;
+        }
+        int v = targets[next[i]++];
+        int mate = mates[v];
+        if (mate == -1) {
+            // Flip the path: each left node on the stack takes the right
+            // node it went through.
+            for (size_t k = stack.size(); k-- > 0; ) {
+                int u = left_nodes[stack[k]];
+                int through = k + 1 == stack.size() ? v : targets[next[stack[k]] - 1];
+                mates[u] = through;
+                mates[through] = u;
+            }
+            return true;
+        }
+        int j = left_position[mate];
+        if (dist[j] == dist[i] + 1)
+            stack.push_back(j);
+    }
+    return false;
+}
+
+inline int BipartiteMatching::solve() {
+    mates.assign(mates.size(), -1);
+    size = 0;
+    if (!bipartite)
+        return 0;
+    int count = left_nodes.size();
+    // Greedy start, usually most of the matching.
+    for (int i = 0; i < count; i++) {
+        for (int pos = offsets[i]; pos < offsets[i + 1]; pos++) {
+            if (mates[targets[pos]] == -1) {
+                mates[targets[pos]] = left_nodes[i];
+                mates[left_nodes[i]] = targets[pos];
+                size++;
+                break;
+            }
+        }
+    }
+    vector<int> dist, next(count), stack;
+    while (layer(dist)) {
+        for (int i = 0; i < count; i++)
+            next[i] = offsets[i];
+        for (int i = 0; i < count; i++)
+            if (mates[left_nodes[i]] == -1 && augment(i, dist, next, stack))
+                size++;
+    }
+    return size;
+}
+
+// Rectangular matrix, rows the smaller side, missing edges at a cost
+// above any matching made of real edges, so the fewest missing edges are
+// used first. Potentials u, v and way as in the classic formulation,
+// which gives every row a column as long as there are at least as many
+// columns as rows.
+inline double BipartiteMatching::solveWeighted(bool maximize) {
+    mates.assign(mates.size(), -1);
+    size = 0;
+    if (!bipartite)
+        return 0;
+    int count = left_nodes.size();
+    vector<int> right_nodes, right_position(mates.size(), -1);
+    for (int u = 0; u < (int)mates.size(); u++) {
+        if (!left[u]) {
+            right_position[u] = right_nodes.size();
+            right_nodes.push_back(u);
+        }
+    }
+    // Left nodes are rows unless there are more of them.
+    bool transposed = count > (int)right_nodes.size();
+    const vector<int>& row_nodes = transposed ? right_nodes : left_nodes;
+    const vector<int>& col_nodes = transposed ? left_nodes : right_nodes;
+    int rows = row_nodes.size(), cols = col_nodes.size();
+    if (rows == 0)
+        return 0;
+    double missing = 1;
+    for (size_t pos = 0; pos < weights.size(); pos++)
+        missing += fabs(weights[pos]);
+    missing *= 2;
+    vector<double> cost((size_t)rows * cols, missing);
+    vector<char> real((size_t)rows * cols, 0);
+    for (int i = 0; i < count; i++) {
+        for (int pos = offsets[i]; pos < offsets[i + 1]; pos++) {
+            int j = right_position[targets[pos]];
+            size_t cell = transposed ? (size_t)j * cols + i : (size_t)i * cols + j;
+            double w = maximize ? -weights[pos] : weights[pos];
+            // Parallel edges: keep the best.
+            if (!real[cell] || w < cost[cell])
+                cost[cell] = w;
+            real[cell] = 1;
+        }
+    }
+
+    const double inf = 1e300;
+    vector<double> u(rows + 1, 0), v(cols + 1, 0), low(cols + 1);
+    vector<int> match(cols + 1, 0), way(cols + 1, 0);
+    vector<char> used(cols + 1);
+    for (int row = 1; row <= rows; row++) {
+        match[0] = row;
+        int col0 = 0;
+        low.assign(cols + 1, inf);
+        used.assign(cols + 1, 0);
+        do {
+            used[col0] = 1;
+            int row0 = match[col0], col1 = 0;
+            double delta = inf;
+            const double* line = &cost[(size_t)(row0 - 1) * cols];
+            for (int col = 1; col <= cols; col++) {
+                if (used[col])
+                    continue;
+                double reduced = line[col - 1] - u[row0] - v[col];
+                if (reduced < low[col]) {
+                    low[col] = reduced;
+                    way[col] = col0;
+                }
+                if (low[col] < delta) {
+                    delta = low[col];
+                    col1 = col;
+                }
+            }
+            for (int col = 0; col <= cols; col++) {
+                if (used[col]) {
+                    u[match[col]] += delta;
+                    v[col] -= delta;
+                } else {
+                    low[col] -= delta;
+                }
+            }
+            col0 = col1;
+        } while (match[col0] != 0);
+        do {
+            int col1 = way[col0];
+            match[col0] = match[col1];
+            col0 = col1;
+        } while (col0 != 0);
+    }
+
+    double total = 0;
+    for (int col = 1; col <= cols; col++) {
+        int row = match[col] - 1;
+        if (row < 0 || !real[(size_t)row * cols + col - 1])
+            continue;
+        int a = row_nodes[row], b = col_nodes[col - 1];
+        mates[a] = b;
+        mates[b] = a;
+        size++;
+        total += cost[(size_t)row * cols + col - 1];
+    }
+    return maximize ? -total : total;
+}
+#endif
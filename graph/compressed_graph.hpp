@@ -0,0 +1,339 @@
+#include<vector>
+#include<algorithm>
+#include<unordered_map>
+#include<stdint.h>
+#include<string.h>
+#include<utility>
+#include "graph.hpp"
+#ifndef __COMPRESSED_GRAPH__
+#define __COMPRESSED_GRAPH__
+using namespace std;
+
+/*
+ * Immutable compressed copy of the topology of a graph, for graphs too
+ * large to hold as Edge objects.
+ *
+ * Neighbours of every node are sorted and stored as gaps in variable
+ * length integers, 7 bits per byte with the high bit set on all but the
+ * last byte. A list starts with the degree, then the first neighbour as
+ * a zigzag encoded difference to the node itself, then the gaps to the
+ * previous neighbour. On graphs with good locality (see reorder) most
+ * gaps fit in one byte.
+ *
+ * Only iteration indices are kept, no weights and no edge ids. Node order
+ * is the iteration order of the graph it was built from, or the order
+ * given to a Builder, which encodes a sorted edge stream without any
+ * GraphBase.
+ *
+ * It has the index only surface of GraphBase, getNodeCount, isDirected,
+ * getOutDegreeAt and neighborsAt with iterators giving otherIndex, so
+ * IndexTraversal and Analytics run on it. Edges read as weight 1.
+ */
+class CompressedGraph {
+    public:
+        // Forward iterator decoding one neighbour at a time.
+        class iterator {
+            public:
+                iterator() : pos(NULL), left(0), value(0) {}
+                int operator*() const { return value;}
+                // Same as *it, named as on EdgeRange.
+                int otherIndex() const { return value;}
+                float getWeight() const { return 1;}
+                iterator& operator++() {
+                    if (--left > 0)
+                        value += (int)CompressedGraph::readVarint(pos);
+                    return *this;
+                }
+                bool operator==(const iterator& other) const { return left == other.left;}
+                bool operator!=(const iterator& other) const { return left != other.left;}
+
+            private:
+                friend class CompressedGraph;
+                const uint8_t* pos;
+                int left;
+                int value;
+        };
+
+        // begin()/end() over the neighbours of one node, for range for loops.
+        class Range {
+            public:
+                typedef CompressedGraph::iterator iterator;
+
+                iterator begin() const { return first;}
+                iterator end() const { return iterator();}
+
+            private:
+                friend class CompressedGraph;
+                iterator first;
+        };
+
+        class Builder;
+        typedef Range NeighborRange;
+
+        CompressedGraph() : directed(false), edge_count(0), offsets(1, 0) {}
+        template<class V, class E>
+        explicit CompressedGraph(const GraphBase<V,E>& graph);
+
+        bool isDirected() const { return directed;}
+        int getNodeCount() const { return ids.size();}
+        int64_t getEdgeCount() const { return directed ? edge_count : edge_count / 2;}
+
+        int getNodeId(int idx) const { return ids[idx];}
+        // Iteration index of node id, -1 if not present.
+        int indexOf(int id) const;
+
+        int getOutDegreeAt(int idx) const {
+            const uint8_t* pos = bytes.data() + offsets[idx];
+            return readVarint(pos);
+        }
+        // Neighbours of idx in increasing index order.
+        Range neighborsAt(int idx) const;
+        // Decodes all neighbours of idx into out, which must have room for
+        // getOutDegreeAt(idx) ints. Returns the count. Faster than iterating.
+        int decodeNeighbors(int idx, int* out) const;
+
+        // Size of the encoded adjacency lists, without ids and offsets.
+        size_t getEncodedSize() const { return bytes.size() - PADDING;}
+        // Everything held, ids, offsets and the id map included.
+        size_t getMemoryUsage() const;
+
+        // Hop count from source index in iteration order, -1 if not reached.
+        void breadthFirstSearch(int source, vector<int>& dist) const;
+
+    private:
+        // Zero bytes after the last list so decodeNeighbors can always
+        // load 8 bytes at once.
+        static const int PADDING = 8;
+
+        bool directed;
+        // Edge directions, a compressed graph can hold more than 2^31.
+        int64_t edge_count;
+        vector<int> ids;
+        unordered_map<int, int> id_idx_mp;
+        // Byte position of the list of each node, 64 bit as large graphs
+        // pass 2^31 bytes.
+        vector<uint64_t> offsets;
+        vector<uint8_t> bytes;
+
+        // Appends the sorted list of idx, after those of all nodes before.
+        void appendList(int idx, const int* list, int degree);
+        // Padding after the last list.
+        void finish();
+        void writeVarint(uint32_t value);
+        static uint32_t readVarint(const uint8_t*& pos) {
+            uint32_t value = *pos & 0x7f;
+            for (int shift = 7; *pos++ & 0x80; shift += 7)
+                value |= (uint32_t)(*pos & 0x7f) << shift;
+            return value;
+        }
+};
+
+/*
+ * Encodes edges given in order of source index, then target index, so
+ * only the list of the current source is held. Undirected graphs take
+ * both directions of every edge, each in its place in the order.
+ *
+ *      CompressedGraph::Builder builder(false, ids);
+ *      builder.addEdge(0, 1);
+ *      builder.addEdge(1, 0);
+ *      builder.build(compressed);
+ */
+class CompressedGraph::Builder {
+    public:
+        // nNodes nodes with ids 0 .. nNodes - 1.
+        Builder(bool directed, int nNodes);
+        // ids[i] is the id of the node at index i.
+        Builder(bool directed, const vector<int>& ids);
+
+        // Edge between iteration indices. False, and nothing added, if an
+        // index is out of range or the edge comes before the last one.
+        bool addEdge(int src_idx, int dst_idx);
+        // Moves the encoding into graph, the builder is left empty.
+        void build(CompressedGraph& graph);
+
+    private:
+        CompressedGraph graph;
+        int source;
+        vector<int> list;
+
+        void flush();
+};
+
+template<class V, class E>
+CompressedGraph::CompressedGraph(const GraphBase<V,E>& graph) :
+    directed(graph.isDirected()),
+    edge_count(0),
+    ids(graph.getNodeCount()),
+    offsets(graph.getNodeCount() + 1, 0) {
+    int n = graph.getNodeCount();
+    id_idx_mp.reserve(n);
+    vector<int> list;
+    typename GraphBase<V,E>::const_iterator node = graph.cbegin();
+    for (int i = 0; i < n; i++, node++) {
+        ids[i] = node->getId();
+        id_idx_mp[ids[i]] = i;
+
+        list.clear();
+        EdgeRange<const E> range = graph.neighborsAt(i);
+        for (typename EdgeRange<const E>::iterator it = range.begin(); it != range.end(); ++it)
+            list.push_back(it.otherIndex());
+        sort(list.begin(), list.end());
+        appendList(i, list.data(), list.size());
+    }
+    finish();
+}
+
+inline void CompressedGraph::appendList(int idx, const int* list, int degree) {
+    edge_count += degree;
+    offsets[idx] = bytes.size();
+    writeVarint(degree);
+    if (degree > 0) {
+        int first = list[0] - idx;
+        writeVarint(((uint32_t)first << 1) ^ (uint32_t)(first >> 31));
+    }
+    for (int k = 1; k < degree; k++)
+        writeVarint(list[k] - list[k - 1]);
+}
+
+inline void CompressedGraph::finish() {
+    offsets[getNodeCount()] = bytes.size();
+    bytes.resize(bytes.size() + PADDING, 0);
+    bytes.shrink_to_fit();
+}
+
+inline CompressedGraph::Builder::Builder(bool directed, int nNodes) : source(0) {
+    graph.directed = directed;
+    graph.ids.resize(nNodes);
+    graph.offsets.assign(nNodes + 1, 0);
+    graph.id_idx_mp.reserve(nNodes);
+    for (int i = 0; i < nNodes; i++) {
+        graph.ids[i] = i;
+        graph.id_idx_mp[i] = i;
+    }
+}
+
+inline CompressedGraph::Builder::Builder(bool directed, const vector<int>& ids) : source(0) {
+    graph.directed = directed;
+    graph.ids = ids;
+    graph.offsets.assign(ids.size() + 1, 0);
+    graph.id_idx_mp.reserve(ids.size());
+    for (size_t i = 0; i < ids.size(); i++)
+        graph.id_idx_mp[ids[i]] = i;
+}
+
+inline bool CompressedGraph::Builder::addEdge(int src_idx, int dst_idx) {
+    int n = graph.getNodeCount();
+    if (src_idx < source || src_idx >= n || dst_idx < 0 || dst_idx >= n)
+        return false;
+    if (src_idx == source && !list.empty() && dst_idx < list.back())
+        return false;
+    while (source < src_idx)
+        flush();
+    list.push_back(dst_idx);
+    return true;
+}
+
+inline void CompressedGraph::Builder::flush() {
+    graph.appendList(source++, list.data(), list.size());
+    list.clear();
+}
+
+// Nodes past the last source get empty lists.
+inline void CompressedGraph::Builder::build(CompressedGraph& out) {
+    while (source < graph.getNodeCount())
+        flush();
+    graph.finish();
+    out = move(graph);
+    graph = CompressedGraph();
+    source = 0;
+}
+
+inline void CompressedGraph::writeVarint(uint32_t value) {
+    while (value >= 0x80) {
+        bytes.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back((uint8_t)value);
+}
+
+inline int CompressedGraph::indexOf(int id) const {
+    unordered_map<int, int>::const_iterator it = id_idx_mp.find(id);
+    return it == id_idx_mp.end() ? -1 : it->second;
+}
+
+inline CompressedGraph::Range CompressedGraph::neighborsAt(int idx) const {
+    Range range;
+    const uint8_t* pos = bytes.data() + offsets[idx];
+    range.first.left = readVarint(pos);
+    if (range.first.left > 0) {
+        uint32_t zigzag = readVarint(pos);
+        range.first.value = idx + (int)((zigzag >> 1) ^ (0 - (zigzag & 1)));
+    }
+    range.first.pos = pos;
+    return range;
+}
+
+// Runs of one byte gaps, the common case after reordering, are taken 8
+// at a time: a word with no high bit set is 8 complete gaps.
+inline int CompressedGraph::decodeNeighbors(int idx, int* out) const {
+    const uint8_t* pos = bytes.data() + offsets[idx];
+    int degree = readVarint(pos);
+    if (degree == 0)
+        return 0;
+    uint32_t zigzag = readVarint(pos);
+    int value = idx + (int)((zigzag >> 1) ^ (0 - (zigzag & 1)));
+    out[0] = value;
+    int k = 1;
+    while (k < degree) {
+        if (degree - k >= 8) {
+            uint64_t word;
+            memcpy(&word, pos, 8);
+            if ((word & 0x8080808080808080ULL) == 0) {
+                for (int b = 0; b < 8; b++) {
+                    value += pos[b];
+                    out[k + b] = value;
+                }
+                pos += 8;
+                k += 8;
+                continue;
+            }
+        }
+        value += (int)readVarint(pos);
+        out[k++] = value;
+    }
+    return degree;
+}
+
+inline size_t CompressedGraph::getMemoryUsage() const {
+    return sizeof(*this) + bytes.capacity()
+        + offsets.capacity() * sizeof(uint64_t)
+        + ids.capacity() * sizeof(int)
+        + id_idx_mp.bucket_count() * sizeof(void*)
+        + id_idx_mp.size() * (sizeof(pair<int, int>) + sizeof(void*));
+}
+
+inline void CompressedGraph::breadthFirstSearch(int source, vector<int>& dist) const {
+    dist.assign(getNodeCount(), -1);
+    if (source < 0 || source >= getNodeCount())
+        return;
+
+    vector<int> q;
+    q.reserve(getNodeCount());
+    vector<int> buffer;
+    dist[source] = 0;
+    q.push_back(source);
+    for (size_t head = 0; head < q.size(); head++) {
+        int idx = q[head];
+        int degree = getOutDegreeAt(idx);
+        if ((int)buffer.size() < degree)
+            buffer.resize(degree);
+        decodeNeighbors(idx, buffer.data());
+        for (int k = 0; k < degree; k++) {
+            if (dist[buffer[k]] == -1) {
+                dist[buffer[k]] = dist[idx] + 1;
+                q.push_back(buffer[k]);
+            }
+        }
+    }
+}
+#endif
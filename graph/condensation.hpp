@@ -0,0 +1,231 @@
+#include<vector>
+#include<utility>
+#include "graph.hpp"
+#ifndef __CONDENSATION__
+#define __CONDENSATION__
+using namespace std;
+
+/*
+ * Condensation of a graph: its strongly connected components (connected
+ * components if undirected) and the DAG between them.
+ *
+ * Everything is stored in flat arrays indexed by iteration index of the
+ * node or by component id. Component ids are a topological order sorted
+ * by level: a DAG edge c -> d always has c < d and
+ * getLevel(c) < getLevel(d). Level 0 holds the components nothing points
+ * to, level l + 1 those whose longest incoming path has length l + 1, so
+ * every component of a level can be processed once all earlier levels
+ * are done.
+ *
+ * Parallel edges between two components are merged into one DAG edge
+ * that counts them.
+ */
+class Condensation {
+    public:
+        Condensation() : member_offsets(1, 0), dag_offsets(1, 0), level_offsets(1, 0) {}
+        template<class V, class E>
+        explicit Condensation(const GraphBase<V,E>& graph);
+
+        int getNodeCount() const { return component_of.size();}
+        int getComponentCount() const { return in_degrees.size();}
+        // Component of node at iteration index idx.
+        int getComponentId(int idx) const { return component_of[idx];}
+
+        // Iteration indices of the nodes in component c.
+        int getComponentSize(int c) const { return member_offsets[c + 1] - member_offsets[c];}
+        const int* membersBegin(int c) const { return members.data() + member_offsets[c];}
+        const int* membersEnd(int c) const { return members.data() + member_offsets[c + 1];}
+
+        // Distinct component pairs joined by at least one edge.
+        int getDagEdgeCount() const { return successors.size();}
+        int getOutDegree(int c) const { return dag_offsets[c + 1] - dag_offsets[c];}
+        int getInDegree(int c) const { return in_degrees[c];}
+        // Position of first DAG edge of c, for getMultiplicity.
+        int getEdgeOffset(int c) const { return dag_offsets[c];}
+        const int* successorsBegin(int c) const { return successors.data() + dag_offsets[c];}
+        const int* successorsEnd(int c) const { return successors.data() + dag_offsets[c + 1];}
+        // Number of graph edges merged into DAG edge at pos.
+        int getMultiplicity(int pos) const { return multiplicities[pos];}
+
+        int getLevel(int c) const { return levels[c];}
+        int getLevelCount() const { return level_offsets.size() - 1;}
+        // Components of level l are ids getLevelStart(l) .. getLevelEnd(l) - 1.
+        int getLevelStart(int level) const { return level_offsets[level];}
+        int getLevelEnd(int level) const { return level_offsets[level + 1];}
+
+    private:
+        vector<int> component_of;
+        vector<int> member_offsets;
+        vector<int> members;
+        vector<int> dag_offsets;
+        vector<int> successors;
+        vector<int> multiplicities;
+        vector<int> in_degrees;
+        vector<int> levels;
+        vector<int> level_offsets;
+
+        void build(int n, const vector<int>& offsets, const vector<int>& targets);
+};
+
+// Adjacency is copied to CSR first, everything after works on the arrays.
+template<class V, class E>
+Condensation::Condensation(const GraphBase<V,E>& graph) :
+    member_offsets(1, 0),
+    dag_offsets(1, 0),
+    level_offsets(1, 0) {
+    int n = graph.getNodeCount();
+    vector<int> offsets(n + 1, 0);
+    for (int i = 0; i < n; i++)
+        offsets[i + 1] = offsets[i] + graph.getOutDegreeAt(i);
+    vector<int> targets(offsets[n]);
+    for (int i = 0; i < n; i++) {
+        EdgeRange<const E> range = graph.neighborsAt(i);
+        int pos = offsets[i];
+        for (typename EdgeRange<const E>::iterator it = range.begin(); it != range.end(); ++it)
+            targets[pos++] = it.otherIndex();
+    }
+    build(n, offsets, targets);
+}
+
+// Kosaraju with explicit stacks: post order of a forward search, then
+// searches on the reversed edges in reverse post order. Components come
+// out in topological order of the DAG, which makes levels a single pass.
+inline void Condensation::build(int n, const vector<int>& offsets, const vector<int>& targets) {
+    vector<int> rev_offsets(n + 1, 0);
+    for (size_t pos = 0; pos < targets.size(); pos++)
+        rev_offsets[targets[pos] + 1]++;
+    for (int i = 0; i < n; i++)
+        rev_offsets[i + 1] += rev_offsets[i];
+    vector<int> sources(targets.size());
+    vector<int> cursor(rev_offsets.begin(), rev_offsets.end() - 1);
+    for (int i = 0; i < n; i++)
+        for (int pos = offsets[i]; pos < offsets[i + 1]; pos++)
+            sources[cursor[targets[pos]]++] = i;
+
+    vector<int> order;
+    order.reserve(n);
+    vector<char> seen(n, 0);
+    vector< pair<int, int> > stack;
+    for (int root = 0; root < n; root++) {
+        if (seen[root])
+            continue;
+        seen[root] = 1;
+        stack.push_back(pair<int, int>(root, offsets[root]));
+        while (!stack.empty()) {
+            int idx = stack.back().first;
+            int& pos = stack.back().second;
+            if (pos == offsets[idx + 1]) {
+                order.push_back(idx);
+                stack.pop_back();
+                continue;
+            }
+            int other = targets[pos++];
+            if (!seen[other]) {
+                seen[other] = 1;
+                stack.push_back(pair<int, int>(other, offsets[other]));
+            }
+        }
+    }
+
+    vector<int> raw(n, -1);
+    vector<int> dfs;
+    int count = 0;
+    for (int i = n - 1; i >= 0; i--) {
+        if (raw[order[i]] != -1)
+            continue;
+        raw[order[i]] = count;
+        dfs.push_back(order[i]);
+        while (!dfs.empty()) {
+            int idx = dfs.back();
+            dfs.pop_back();
+            for (int pos = rev_offsets[idx]; pos < rev_offsets[idx + 1]; pos++) {
+                if (raw[sources[pos]] == -1) {
+                    raw[sources[pos]] = count;
+                    dfs.push_back(sources[pos]);
+                }
+            }
+        }
+        count++;
+    }
+
+    // Longest path levels. Every edge goes from a lower to a higher raw id.
+    vector<int> raw_level(count, 0);
+    vector<int> raw_members(n);
+    vector<int> raw_offsets(count + 1, 0);
+    for (int i = 0; i < n; i++)
+        raw_offsets[raw[i] + 1]++;
+    for (int c = 0; c < count; c++)
+        raw_offsets[c + 1] += raw_offsets[c];
+    cursor.assign(raw_offsets.begin(), raw_offsets.end() - 1);
+    for (int i = 0; i < n; i++)
+        raw_members[cursor[raw[i]]++] = i;
+    int level_count = count > 0 ? 1 : 0;
+    for (int c = 0; c < count; c++) {
+        for (int m = raw_offsets[c]; m < raw_offsets[c + 1]; m++) {
+            int idx = raw_members[m];
+            for (int pos = offsets[idx]; pos < offsets[idx + 1]; pos++) {
+                int d = raw[targets[pos]];
+                if (d != c && raw_level[d] <= raw_level[c]) {
+                    raw_level[d] = raw_level[c] + 1;
+                    level_count = max(level_count, raw_level[d] + 1);
+                }
+            }
+        }
+    }
+
+    // Renumber by level, stable so ids stay topological within a level.
+    level_offsets.assign(level_count + 1, 0);
+    for (int c = 0; c < count; c++)
+        level_offsets[raw_level[c] + 1]++;
+    for (int l = 0; l < level_count; l++)
+        level_offsets[l + 1] += level_offsets[l];
+    vector<int> renumber(count);
+    levels.resize(count);
+    cursor.assign(level_offsets.begin(), level_offsets.end() - 1);
+    for (int c = 0; c < count; c++) {
+        renumber[c] = cursor[raw_level[c]]++;
+        levels[renumber[c]] = raw_level[c];
+    }
+
+    component_of.resize(n);
+    for (int i = 0; i < n; i++)
+        component_of[i] = renumber[raw[i]];
+    member_offsets.assign(count + 1, 0);
+    for (int i = 0; i < n; i++)
+        member_offsets[component_of[i] + 1]++;
+    for (int c = 0; c < count; c++)
+        member_offsets[c + 1] += member_offsets[c];
+    members.resize(n);
+    cursor.assign(member_offsets.begin(), member_offsets.end() - 1);
+    for (int i = 0; i < n; i++)
+        members[cursor[component_of[i]]++] = i;
+
+    // last[d] is the component whose edges last reached d, slot[d] the
+    // position of that DAG edge, so repeats are merged in O(1).
+    vector<int> last(count, -1);
+    vector<int> slot(count, 0);
+    in_degrees.assign(count, 0);
+    dag_offsets.assign(count + 1, 0);
+    successors.clear();
+    multiplicities.clear();
+    for (int c = 0; c < count; c++) {
+        for (int m = member_offsets[c]; m < member_offsets[c + 1]; m++) {
+            int idx = members[m];
+            for (int pos = offsets[idx]; pos < offsets[idx + 1]; pos++) {
+                int d = component_of[targets[pos]];
+                if (d == c)
+                    continue;
+                if (last[d] != c) {
+                    last[d] = c;
+                    slot[d] = successors.size();
+                    successors.push_back(d);
+                    multiplicities.push_back(0);
+                    in_degrees[d]++;
+                }
+                multiplicities[slot[d]]++;
+            }
+        }
+        dag_offsets[c + 1] = successors.size();
+    }
+}
+#endif
@@ -0,0 +1,109 @@
+#include<vector>
+#include<unordered_map>
+#include "graph.hpp"
+#ifndef __CSR_GRAPH__
+#define __CSR_GRAPH__
+using namespace std;
+
+/*
+ * Immutable compressed sparse row copy of a graph.
+ *
+ * Out edges of node i are targets[offsets[i]] .. targets[offsets[i + 1] - 1],
+ * stored as iteration indices, with weights and edge ids alongside. Node
+ * order is the iteration order of the graph it was built from. Nothing
+ * changes after construction, so any number of threads can read one
+ * CSRGraph without synchronisation.
+ *
+ * The algorithm headers (Condensation, Partitioner, MaxFlow, Analytics,
+ * BipartiteMatching, Biconnected) copy what they read into flat arrays
+ * the same way. They take a const graph, change neither it nor its
+ * traversal state, do not see later changes to it, and what they build
+ * can be read from any number of threads.
+ */
+class CSRGraph {
+    public:
+        CSRGraph() : directed(false), offsets(1, 0) {}
+        template<class V, class E>
+        explicit CSRGraph(const GraphBase<V,E>& graph);
+
+        bool isDirected() const { return directed;}
+        int getNodeCount() const { return ids.size();}
+        int getEdgeCount() const { return directed ? targets.size() : targets.size() / 2;}
+
+        int getNodeId(int idx) const { return ids[idx];}
+        // Iteration index of node id, -1 if not present.
+        int indexOf(int id) const;
+
+        int getOutDegree(int idx) const { return offsets[idx + 1] - offsets[idx];}
+        // Position of first out edge of idx in the edge arrays.
+        int getEdgeOffset(int idx) const { return offsets[idx];}
+        const int* neighborsBegin(int idx) const { return targets.data() + offsets[idx];}
+        const int* neighborsEnd(int idx) const { return targets.data() + offsets[idx + 1];}
+        float getWeight(int pos) const { return weights[pos];}
+        int getEdgeId(int pos) const { return edge_ids[pos];}
+
+        // Hop count from source index in iteration order, -1 if not reached.
+        void breadthFirstSearch(int source, vector<int>& dist) const;
+
+    private:
+        bool directed;
+        vector<int> ids;
+        unordered_map<int, int> id_idx_mp;
+        vector<int> offsets;
+        vector<int> targets;
+        vector<float> weights;
+        vector<int> edge_ids;
+};
+
+template<class V, class E>
+CSRGraph::CSRGraph(const GraphBase<V,E>& graph) :
+    directed(graph.isDirected()),
+    ids(graph.getNodeCount()),
+    offsets(graph.getNodeCount() + 1, 0) {
+    int n = graph.getNodeCount();
+    for (int i = 0; i < n; i++)
+        offsets[i + 1] = offsets[i] + graph.getOutDegreeAt(i);
+
+    targets.resize(offsets[n]);
+    weights.resize(offsets[n]);
+    edge_ids.resize(offsets[n]);
+    id_idx_mp.reserve(n);
+    typename GraphBase<V,E>::const_iterator node = graph.cbegin();
+    for (int i = 0; i < n; i++, node++) {
+        ids[i] = node->getId();
+        id_idx_mp[ids[i]] = i;
+        EdgeRange<const E> range = graph.neighborsAt(i);
+        int pos = offsets[i];
+        for (typename EdgeRange<const E>::iterator it = range.begin(); it != range.end(); ++it, pos++) {
+            targets[pos] = it.otherIndex();
+            weights[pos] = it->getWeight();
+            edge_ids[pos] = it->getId();
+        }
+    }
+}
+
+inline int CSRGraph::indexOf(int id) const {
+    unordered_map<int, int>::const_iterator it = id_idx_mp.find(id);
+    return it == id_idx_mp.end() ? -1 : it->second;
+}
+
+inline void CSRGraph::breadthFirstSearch(int source, vector<int>& dist) const {
+    dist.assign(getNodeCount(), -1);
+    if (source < 0 || source >= getNodeCount())
+        return;
+
+    vector<int> q;
+    q.reserve(getNodeCount());
+    dist[source] = 0;
+    q.push_back(source);
+    for (size_t head = 0; head < q.size(); head++) {
+        int idx = q[head];
+        for (const int* it = neighborsBegin(idx); it != neighborsEnd(idx); it++) {
+            if (dist[*it] == -1) {
+                dist[*it] = dist[idx] + 1;
+                q.push_back(*it);
+            }
+        }
+    }
+}
+#endif
@@ -1,10 +1,12 @@
 #include<iostream>
+#include<algorithm>
 using namespace std;
 // forward declaration to resolve circular dependency.
 #ifndef __EDGE__
 #define __EDGE__
 
 template<class V, class E> class GraphBase;
+template<class E> class EdgeRange;
 
 /*
  * User cannot create an edge. At most it can do is get an edge
@@ -42,6 +44,19 @@ class Edge {
         static int count;
         EDGE_TYPE type;
         int id;
+
+        // Adjacency index of other node in owning graph,
+        // saves an id lookup per edge in traversals.
+        int other_idx;
+
+        // Links for constant time removal. prev is the previous edge in
+        // owner's list. Undirected edges are stored as two halves, twin
+        // is the other half. Directed edges are also in a list of edges
+        // into the other node, linked by in_next/in_prev.
+        Edge* prev;
+        Edge* twin;
+        Edge* in_next;
+        Edge* in_prev;
     protected:
 
         // As with the node, user has no business of constructing an edge
@@ -58,15 +73,36 @@ class Edge {
 
         void setNext(Edge* next) { this->next = next; }
         Edge* getNext() const {return next;}
+        void setPrev(Edge* prev) { this->prev = prev; }
+        Edge* getPrev() const {return prev;}
+        void setTwin(Edge* twin) { this->twin = twin; }
+        Edge* getTwin() const {return twin;}
+        void setInNext(Edge* in_next) { this->in_next = in_next; }
+        Edge* getInNext() const {return in_next;}
+        void setInPrev(Edge* in_prev) { this->in_prev = in_prev; }
+        Edge* getInPrev() const {return in_prev;}
 
         EDGE_TYPE getType() const { return type;}
         void setType(EDGE_TYPE edge_type) { this->type = edge_type;}
 
+        int getOtherAdjecencyIndex() const { return other_idx;}
+        void setOtherAdjecencyIndex(int index) { other_idx = index;}
+
+        // Turns a directed edge around in place, out and in links swap
+        // roles. owner_idx is the index of the node it was leaving.
+        void reverse(int owner_idx) {
+            swap(node1_id, node2_id);
+            swap(next, in_next);
+            swap(prev, in_prev);
+            other_idx = owner_idx;
+        }
+
         // Edge can be reset only by graph.
         // User have no business of reseting an edge
         virtual void reset();
 
         template<class V, class E> friend class GraphBase;
+        template<class E> friend class EdgeRange;
         friend class TestEdge;
 };
 
@@ -83,7 +119,12 @@ Edge::Edge(int n1_id, int n2_id, bool is_directed, float weight) :
     weight(weight),
     next(NULL),
     id(-1),
-    type(NA) {}
+    type(NA),
+    other_idx(-1),
+    prev(NULL),
+    twin(NULL),
+    in_next(NULL),
+    in_prev(NULL) {}
 
 Edge::Edge(int n1_id, int n2_id) :
     node1_id(n1_id),
@@ -92,7 +133,12 @@ Edge::Edge(int n1_id, int n2_id) :
     weight(DEFAULT_WEIGHT),
     next(NULL),
     id(-1),
-    type(NA) {}
+    type(NA),
+    other_idx(-1),
+    prev(NULL),
+    twin(NULL),
+    in_next(NULL),
+    in_prev(NULL) {}
 
 Edge::Edge(int n1_id, int n2_id, bool is_directed) :
     node1_id(n1_id),
@@ -101,7 +147,12 @@ Edge::Edge(int n1_id, int n2_id, bool is_directed) :
     weight(DEFAULT_WEIGHT),
     next(NULL),
     id(-1),
-    type(NA) {}
+    type(NA),
+    other_idx(-1),
+    prev(NULL),
+    twin(NULL),
+    in_next(NULL),
+    in_prev(NULL) {}
 
 Edge::Edge(int n1_id, int n2_id, float weight) :
     node1_id(n1_id),
@@ -110,7 +161,12 @@ Edge::Edge(int n1_id, int n2_id, float weight) :
     weight(weight),
     next(NULL),
     id(-1),
-    type(NA) {}
+    type(NA),
+    other_idx(-1),
+    prev(NULL),
+    twin(NULL),
+    in_next(NULL),
+    in_prev(NULL) {}
 
 
 Edge::Edge(const Edge& edge2) :
@@ -120,7 +176,12 @@ Edge::Edge(const Edge& edge2) :
     weight(edge2.getWeight()),
     id(-1),
     next(NULL),
-    type(NA) {}
+    type(NA),
+    other_idx(-1),
+    prev(NULL),
+    twin(NULL),
+    in_next(NULL),
+    in_prev(NULL) {}
 
 bool Edge::operator ==(const Edge& edge2) {
     return ( // return true if id is same or
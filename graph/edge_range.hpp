@@ -0,0 +1,58 @@
+#include<iterator>
+#include<stddef.h>
+#ifndef __EDGE_RANGE__
+#define __EDGE_RANGE__
+using namespace std;
+
+/*
+ * View over the out edges of one node, walks the node's edge list in
+ * place. Nothing is copied or allocated, so it is cheap enough to ask
+ * for per node in tight loops and can be used in range for loops.
+ *
+ * E is const qualified for ranges handed out by a const graph.
+ * A range is invalidated by any change to the edges of its node.
+ */
+template<class E>
+class EdgeRange {
+    public:
+        class iterator {
+            public:
+                typedef forward_iterator_tag iterator_category;
+                typedef E value_type;
+                typedef ptrdiff_t difference_type;
+                typedef E* pointer;
+                typedef E& reference;
+
+                iterator() : edge(NULL) {}
+                explicit iterator(E* edge) : edge(edge) {}
+
+                E& operator *() const { return *edge;}
+                E* operator ->() const { return edge;}
+                iterator& operator ++() { edge = static_cast<E*>(edge->getNext()); return *this;}
+                iterator operator ++(int) { iterator it(*this); ++*this; return it;}
+                bool operator ==(const iterator& it) const { return edge == it.edge;}
+                bool operator !=(const iterator& it) const { return edge != it.edge;}
+
+                // Iteration index of the node at the other end,
+                // same as graph.indexOf((*it).getOtherNodeId()).
+                int otherIndex() const { return edge->getOtherAdjecencyIndex();}
+                // Same as (*it).getWeight().
+                float getWeight() const { return edge->getWeight();}
+
+            private:
+                E* edge;
+        };
+
+        EdgeRange() : head(NULL), degree(0) {}
+        EdgeRange(E* head, int degree) : head(head), degree(degree) {}
+
+        iterator begin() const { return iterator(head);}
+        iterator end() const { return iterator();}
+        bool empty() const { return head == NULL;}
+        int size() const { return degree;}
+
+    private:
+        E* head;
+        int degree;
+};
+#endif
@@ -4,14 +4,25 @@
 #include<time.h>
 #include<assert.h>
 #include<queue>
+#include<deque>
 #include<map>
 #include<set>
 #include<vector>
 #include<list>
 #include<algorithm>
+#include<functional>
+#include<unordered_map>
+#include<stdint.h>
+#include<string.h>
 
 #include "edge.hpp"
 #include "node.hpp"
+#include "traversal_stats.hpp"
+#include "visitor.hpp"
+#include "workspace.hpp"
+#include "source_mask.hpp"
+#include "edge_range.hpp"
+#include "node_order.hpp"
 using namespace std;
 #ifndef __GRAPH__
 #define __GRAPH__
@@ -19,14 +30,37 @@ using namespace std;
 template<class V, class E=Edge>
 class GraphBase {
     public:
+        // Copies are structural: nodes, indices and edge lists are cloned
+        // in one pass without lookups, edges keep their ids.
         GraphBase(const GraphBase& graph);
+        // Moves take over the other graph's storage, leaving it empty.
+        GraphBase(GraphBase&& graph);
         ~GraphBase();
         class ComponentGraph;
+        typedef TraversalWorkspace<E> Workspace;
         enum RESET {HARD_RESET, SOFT_RESET};
+        // Node orderings for reorder, see node_order.hpp.
+        enum ORDER {RCM, DEGREE, HUB, GORDER};
         void insertNode(V& val);
         bool createEdge(V& V1, V& V2);
         bool createEdge(V& V1, V& V2, float weight);
 
+        // Removal. Edges and nodes go away at once and degrees are
+        // updated, iterators and ranges over touched lists are invalidated.
+        // Edge from neighbors() of this graph, O(out degree of its node).
+        // Removes both halves of an undirected edge. False for edges not
+        // linked into this graph, such as copies from getOutEdgesForNode
+        // or edges of a copy of the graph.
+        bool removeEdge(const E& edge);
+        // First edge from V1 to V2, O(out degree of V1).
+        bool removeEdge(V& V1, V& V2);
+        // Edges between (source id, target id) pairs, every touched
+        // list is walked once. Returns number of edges removed.
+        int removeEdges(const vector< pair<int, int> >& ends);
+        // Node and all its edges, O(degree). Last node in iteration
+        // order takes its place and traversal state is cleared.
+        bool removeNode(const V& node);
+
         inline bool isDirected() const {return directed;}
 
         virtual void printGraph() const;
@@ -40,12 +74,26 @@ class GraphBase {
         int getNodeCount() const {return nodes.size();}
         int getEdgeCount() const {return (isDirected() ? nEdges : nEdges/2);}
 
+        // Order independent hash of node ids and edges (ends and weight),
+        // kept up to date by every insert and removal so reading it is
+        // O(1). Equal graphs have equal fingerprints. Weights changed
+        // through Edge::setWeight are not tracked.
+        uint64_t getFingerprint() const { return fingerprint;}
+        // Same hash recomputed from scratch in O(V + E).
+        uint64_t computeFingerprint() const;
+
         void reset();
         void reset(RESET reset);
 
         bool isCyclic();
         void topsort();
+        template<class Stats> void topsort(Stats& stats);
         void transpose();
+        // Renumbers iteration indices so that nodes used together sit
+        // together, then copies the edges in the new order. Ids, labels
+        // and edge ids stay; iterators, ranges and indices held outside
+        // are invalidated. Edge direction is ignored for ordering.
+        void reorder(ORDER strategy);
 
         typedef typename vector<V>::iterator iterator;
         typedef typename vector<V>::const_iterator const_iterator;
@@ -55,46 +103,169 @@ class GraphBase {
         iterator begin() { return nodes.begin();}
         iterator end() { return nodes.end();}
 
-        bool containsNode(const V& node) { return id_idx_mp.find(node.getId()) != id_idx_mp.end();}
-        vector<E>& getOutEdgesForNode(const V& node) const;
+        bool containsNode(const V& node) const { return id_idx_mp.find(node.getId()) != id_idx_mp.end();}
+        // Iteration index of node id, -1 if not present.
+        // Workspaces and other per node results are indexed by it.
+        int indexOf(int id) const;
+        // Copies the out edges, prefer neighbors() below.
+        vector<E> getOutEdgesForNode(const V& node) const;
         int getInDegreeForNode(const V& node) const;
         int getOutDegreeForNode(const V& node) const;
 
+        // Out edges of node in place, no copy or allocation.
+        // Empty range if node is not in graph.
+        EdgeRange<E> neighbors(const V& node);
+        EdgeRange<const E> neighbors(const V& node) const;
+        // Same by iteration index, no id lookup.
+        typedef EdgeRange<const E> NeighborRange;
+        EdgeRange<E> neighborsAt(int idx) { return EdgeRange<E>(nodes[idx].getEdgeList(), nodes[idx].getOutDegree());}
+        EdgeRange<const E> neighborsAt(int idx) const { return EdgeRange<const E>(nodes[idx].getEdgeList(), nodes[idx].getOutDegree());}
+        int getInDegreeAt(int idx) const { return nodes[idx].getInDegree();}
+        int getOutDegreeAt(int idx) const { return nodes[idx].getOutDegree();}
+
         // Traversal Specific functions
+        // Overloads taking a stats policy (see traversal_stats.hpp)
+        // report counters for the run into it.
+        // The Search functions call the virtual process* hooks below.
         void breadthFirstSearch(V& source);
+        template<class Stats> void breadthFirstSearch(V& source, Stats& stats);
         void depthFirstSearch();
-
-        bool operator ==(const GraphBase& graph);
+        template<class Stats> void depthFirstSearch(Stats& stats);
+
+        // Same traversals with the hooks taken from a visitor type
+        // (see visitor.hpp), resolved at compile time.
+        template<class Visitor> void breadthFirstVisit(V& source, Visitor& visitor);
+        template<class Visitor, class Stats> void breadthFirstVisit(V& source, Visitor& visitor, Stats& stats);
+        template<class Visitor> void depthFirstVisit(Visitor& visitor);
+        template<class Visitor, class Stats> void depthFirstVisit(Visitor& visitor, Stats& stats);
+
+        // Read only traversals recording their state in a caller owned
+        // workspace (see workspace.hpp) instead of the graph. Any number
+        // of these can run concurrently on one graph as long as nothing
+        // modifies it. Results are indexed by node iteration order.
+        void breadthFirstSearch(Workspace& ws, const V& source) const;
+        template<class Visitor, class Stats>
+        void breadthFirstVisit(Workspace& ws, const V& source, Visitor& visitor, Stats& stats) const;
+        void depthFirstSearch(Workspace& ws) const;
+        // Keeps non const graphs from picking the Stats template above.
+        void depthFirstSearch(Workspace& ws) { static_cast<const GraphBase&>(*this).depthFirstSearch(ws);}
+        template<class Visitor, class Stats>
+        void depthFirstVisit(Workspace& ws, Visitor& visitor, Stats& stats) const;
+        // Workspace the traversals above without one record into,
+        // valid until the next traversal or reset.
+        const Workspace& getTraversalState() const { return state;}
+
+        // Single source shortest paths (Dijkstra) over edge weights.
+        // dist and parent are indexed in node iteration order,
+        // unreachable nodes get dist -1 and parent -1.
+        void shortestPaths(const V& source, vector<float>& dist, vector<int>& parent);
+        template<class Stats>
+        void shortestPaths(const V& source, vector<float>& dist, vector<int>& parent, Stats& stats);
+
+        // BFS from many sources at once. Sources are packed as bits per
+        // node, DefaultSourceMask::BITS (64, 256 with AVX2) of them share
+        // every adjacency list scan. dist gets one getNodeCount() wide row
+        // per source id: hops in node iteration order, -1 if not reached.
+        void multiSourceBFS(const vector<int>& source_ids, vector<int>& dist) const;
+
+        // Same node ids and same edges. Fingerprints are compared first,
+        // matching graphs are confirmed by sorting and comparing each
+        // node's edges, O(E log d) overall.
+        bool operator ==(const GraphBase& graph) const;
         GraphBase& operator =(const GraphBase& graph);
+        GraphBase& operator =(GraphBase&& graph);
 
-        ComponentGraph& stronglyConnectedComponents();
+        // Reorders nodes, see Condensation for a const alternative
+        // that copies nothing.
+        ComponentGraph stronglyConnectedComponents();
+        template<class Stats> ComponentGraph stronglyConnectedComponents(Stats& stats);
         V& getNodeById(int id);
+        // O(1) lookup by label, without locking the label pool. The
+        // default (empty) label is not indexed, and when labels repeat the first node inserted
+        // with the label is returned.
+        V& getNodeByLabel(const string& label);
+        // Iteration index of node with label, -1 if not present.
+        int indexOfLabel(const string& label) const;
     private:
         int nEdges;
         bool directed;
+        uint64_t fingerprint;
 
         // Set would have been a better data structure as then the comparison would have been on
         // all fields not just id
         // But the problem is that set returns const reference while dereferencing iterator
         // So using map instead.
         map<int, int> id_idx_mp;
+        // Keys point to the interned text held by the indexed node.
+        typedef unordered_map<const string*, int, LabelPool::TextHash, LabelPool::TextEqual> LabelMap;
+        LabelMap label_idx_mp;
         vector<V> nodes;
 
         typedef typename map<const int, int>::iterator mp_iterator;
         typedef typename map<const int, int>::const_iterator const_mp_iterator;
 
+        class CycleDetector;
+
+        template<class Mask>
+        void multiSourceBatch(const int* sources, int count, int* dist) const;
+
+        static uint64_t mixHash(uint64_t key);
+        static uint64_t nodeHash(int id);
+        static uint64_t edgeHash(const E* edge);
+
     protected:
+        // State of the last run of the non const traversals.
+        Workspace state;
+
+        // Removes edge, both halves if undirected, and frees it.
         virtual void deleteEdge(E* edge);
+        void unlinkEdge(E* edge);
+        // Appends the index of the source of every edge into idx,
+        // directed graphs only.
+        void addSourcesAt(int idx, vector<int>& sources) const {
+            for (E* edge = nodes[idx].getInEdgeList(); edge != NULL; edge = static_cast<E*>(edge->getInNext()))
+                sources.push_back(indexOf(edge->getCurrentNodeId()));
+        }
         void depthFirstRoutine(V& node, int component_id);
+        template<class Visitor, class Stats>
+        void depthFirstRoutine(Workspace& ws, int idx, int component_id, Visitor& visitor, Stats& stats) const;
+        // Reorder nodes so that new index i holds old node order[i].
+        void permuteNodes(const vector<int>& order);
         void hardResetGraph();
+        void cloneFrom(const GraphBase& graph);
+        void takeFrom(GraphBase& graph);
         virtual void processEdge(E* edge);
         virtual void processOnBlack(V& node);
         virtual void processOnGrey(V& node);
-        static bool compareExitTimeInc(const V& node1, const V& node2) { return node1.getExitTime() < node2.getExitTime();}
+
+        // Visitor forwarding to the virtual hooks above,
+        // keeps subclasses overriding them working.
+        // Only used on the graph's own nodes and edges from non const
+        // members, so casting constness away is safe.
+        class VirtualHooks {
+            private:
+                GraphBase* graph;
+            public:
+                VirtualHooks(GraphBase* graph) : graph(graph) {}
+                void processOnGrey(const V& node) { graph->processOnGrey(const_cast<V&>(node));}
+                void processOnBlack(const V& node) { graph->processOnBlack(const_cast<V&>(node));}
+                void processEdge(const E* edge, typename E::EDGE_TYPE type) {
+                    E* e = const_cast<E*>(edge);
+                    e->setType(type);
+                    graph->processEdge(e);
+                }
+                bool finished() const { return false;}
+        };
         GraphBase();
         GraphBase(bool directed);
 };
 
+template<class V, class E>
+int GraphBase<V,E>::indexOf(int id) const {
+    const_mp_iterator it = id_idx_mp.find(id);
+    return it == id_idx_mp.end() ? -1 : it->second;
+}
+
 template<class V, class E>
 V& GraphBase<V,E>::getNodeById(int id) {
     mp_iterator it;
@@ -105,37 +276,52 @@ V& GraphBase<V,E>::getNodeById(int id) {
     }
     return nodes[it->second];
 }
+template<class V, class E>
+int GraphBase<V,E>::indexOfLabel(const string& label) const {
+    typename LabelMap::const_iterator it = label_idx_mp.find(&label);
+    return it == label_idx_mp.end() ? -1 : it->second;
+}
+
+template<class V, class E>
+V& GraphBase<V,E>::getNodeByLabel(const string& label) {
+    int idx = indexOfLabel(label);
+    if (idx == -1) {
+        cerr << "Node not found Label:" << label << endl;
+        exit(-1);
+    }
+    return nodes[idx];
+}
+
 template<class V, class E>
 class GraphBase<V,E>::ComponentGraph {
     private:
-        vector< GraphBase<V,E> >* graphs;
+        vector< GraphBase<V,E> > graphs;
         vector<E>cross_edges;
 
 
     public:
         void addEdge(const E edge);
         GraphBase& getGraphForComponentId(int i);
-        ComponentGraph(int component_count, bool is_directed) {
-            graphs = new vector< GraphBase<V,E> >(component_count, GraphBase<V,E>(is_directed));
-        }
+        ComponentGraph(int component_count, bool is_directed) :
+            graphs(component_count, GraphBase<V,E>(is_directed)) {}
         typedef typename vector<GraphBase>::iterator graph_iterator;
         typedef typename vector<E>::iterator edge_iterator;
 
-        int size() { return graphs->size();}
-        graph_iterator graph_begin() {return graphs->begin();}
-        graph_iterator graph_end() {return graphs->end();}
+        int size() { return graphs.size();}
+        graph_iterator graph_begin() {return graphs.begin();}
+        graph_iterator graph_end() {return graphs.end();}
         edge_iterator edge_begin() {return cross_edges.begin();}
         edge_iterator edge_end() {return cross_edges.end();}
 };
 
 template<class V, class E>
 GraphBase<V,E>& GraphBase<V,E>::ComponentGraph::getGraphForComponentId(int i) {
-    if (i >= graphs->size()) {
-        cerr << "Out of bound Size: " << graphs->size() << " Idx: " << i;
+    if (i >= graphs.size()) {
+        cerr << "Out of bound Size: " << graphs.size() << " Idx: " << i;
         exit(-1);
     }
 
-    return graphs->at(i);
+    return graphs.at(i);
 }
 
 template<class V, class E>
@@ -176,12 +362,14 @@ void GraphBase<V,E>::processOnGrey(V& node) {
 template<class V, class E>
 GraphBase<V,E>::GraphBase(bool dirctd) :
     nEdges(0),
-    directed(dirctd) {}
+    directed(dirctd),
+    fingerprint(0) {}
 
 template<class V, class E>
 GraphBase<V,E>::GraphBase() :
     nEdges(0),
-    directed(false) {}
+    directed(false),
+    fingerprint(0) {}
 
 
 template<class V, class E>
@@ -192,6 +380,9 @@ void GraphBase<V,E>::insertNode(V& node) {
         node1.setAdjecencyIndex(getNodeCount());
         nodes.push_back(node1);
         id_idx_mp.insert(std::pair<int, int>(node1.getId(), node1.getAdjecencyIndex()));
+        fingerprint += nodeHash(node1.getId());
+        if (node1.getLabelHandle() != LabelPool::DEFAULT)
+            label_idx_mp.insert(std::pair<const string*, int>(&node1.getLabel(), node1.getAdjecencyIndex()));
     }
 }
 
@@ -222,25 +413,31 @@ int GraphBase<V,E>::getOutDegreeForNode(const V& node) const {
 // Not using getNodeById because we dont want to exit.
 // Just returning empty vector.
 template<class V, class E>
-vector<E>& GraphBase<V,E>::getOutEdgesForNode(const V& node) const {
-    vector<E>* edges = new vector<E>();
-
-    const_mp_iterator it;
-    const V* internal_node;
-    if ((it = id_idx_mp.find(node.getId())) != id_idx_mp.end()) {
-        internal_node = &nodes[it->second];
-    }
-
-    if (internal_node == NULL) {
+vector<E> GraphBase<V,E>::getOutEdgesForNode(const V& node) const {
+    vector<E> edges;
+    int idx = indexOf(node.getId());
+    if (idx == -1) {
         cerr << "Node not found";
-    } else {
-        E* edge = internal_node->getEdgeList();
-        while(edge != NULL) {
-            edges->push_back(*edge);
-            edge = edge->getNext();
-        }
+        return edges;
     }
-    return *edges;
+
+    EdgeRange<const E> range = neighborsAt(idx);
+    edges.reserve(range.size());
+    for (typename EdgeRange<const E>::iterator it = range.begin(); it != range.end(); ++it)
+        edges.push_back(*it);
+    return edges;
+}
+
+template<class V, class E>
+EdgeRange<E> GraphBase<V,E>::neighbors(const V& node) {
+    int idx = indexOf(node.getId());
+    return idx == -1 ? EdgeRange<E>() : neighborsAt(idx);
+}
+
+template<class V, class E>
+EdgeRange<const E> GraphBase<V,E>::neighbors(const V& node) const {
+    int idx = indexOf(node.getId());
+    return idx == -1 ? EdgeRange<const E>() : neighborsAt(idx);
 }
 
 template<class V, class E>
@@ -255,6 +452,7 @@ bool GraphBase<V,E>::createEdge(V& V1, V& V2, float weight) {
 
     E* newEdge;
     E* temp;
+    E* halves[2] = {NULL, NULL};
     int i = 0, idx = 0;
 
     int id = E::getNewId();
@@ -266,6 +464,7 @@ bool GraphBase<V,E>::createEdge(V& V1, V& V2, float weight) {
                         isDirected(),
                         weight);
         newEdge->setId(id);
+        newEdge->setOtherAdjecencyIndex(othrNode->getAdjecencyIndex());
 
         // inserting edge to v2 in v1
         temp = currNode->getEdgeList();
@@ -283,13 +482,25 @@ bool GraphBase<V,E>::createEdge(V& V1, V& V2, float weight) {
             prevEdge->setNext(newEdge);
         else
             currNode->setEdgeList(newEdge);
+        newEdge->setPrev(prevEdge);
+        halves[i] = newEdge;
 
         currNode->incOutDegree();
-        if (isDirected())
+        if (isDirected()) {
             othrNode->incInDegree();
-        else
+            newEdge->setInNext(othrNode->getInEdgeList());
+            if (othrNode->getInEdgeList() != NULL)
+                othrNode->getInEdgeList()->setInPrev(newEdge);
+            othrNode->setInEdgeList(newEdge);
+        } else {
             currNode->incInDegree();
+        }
         nEdges++;
+        fingerprint += edgeHash(newEdge);
+    }
+    if (!isDirected()) {
+        halves[0]->setTwin(halves[1]);
+        halves[1]->setTwin(halves[0]);
     }
     return true;
 }
@@ -396,8 +607,7 @@ void GraphBase<V,E>::reset(RESET reset) {
     if( reset == HARD_RESET) {
        hardResetGraph();
     } else {
-        for (iterator it = begin(); it != end(); it++)
-            it->reset(V::SOFT_RESET);
+        state.clear();
     }
 }
 
@@ -419,388 +629,871 @@ void GraphBase<V,E>::hardResetGraph() {
         it->reset(V::HARD_RESET);
     }
     nEdges = 0;
+    fingerprint = 0;
     id_idx_mp.clear();
+    label_idx_mp.clear();
     nodes.clear();
+    state.clear();
 }
 
 template<class V, class E>
 void GraphBase<V,E>::breadthFirstSearch(V& source) {
+    NoTraversalStats stats;
+    breadthFirstSearch(source, stats);
+}
+
+template<class V, class E>
+template<class Stats>
+void GraphBase<V,E>::breadthFirstSearch(V& source, Stats& stats) {
+    VirtualHooks hooks(this);
+    breadthFirstVisit(source, hooks, stats);
+}
+
+template<class V, class E>
+template<class Visitor>
+void GraphBase<V,E>::breadthFirstVisit(V& source, Visitor& visitor) {
+    NoTraversalStats stats;
+    breadthFirstVisit(source, visitor, stats);
+}
+
+template<class V, class E>
+template<class Visitor, class Stats>
+void GraphBase<V,E>::breadthFirstVisit(V& source, Visitor& visitor, Stats& stats) {
+    breadthFirstVisit(state, source, visitor, stats);
+}
 
-    if (id_idx_mp.find(source.getId()) == id_idx_mp.end()) {
+template<class V, class E>
+void GraphBase<V,E>::breadthFirstSearch(Workspace& ws, const V& source) const {
+    GraphVisitor<V,E> visitor;
+    NoTraversalStats stats;
+    breadthFirstVisit(ws, source, visitor, stats);
+}
+
+template<class V, class E>
+template<class Visitor, class Stats>
+void GraphBase<V,E>::breadthFirstVisit(Workspace& ws, const V& source, Visitor& visitor, Stats& stats) const {
+    stats.idLookup();
+    int root = indexOf(source.getId());
+    if (root == -1) {
         cerr << "Node not present" << endl;
         return;
     }
 
-    // Get the internal corresponding node and run that.
-    source = getNodeById(source.getId());
-
-    queue<V*> q;
-    source.setColor(V::GRAY);
-    E* edge;
-    V* node;
-    V* other;
-
-    typename V::COLOR clr;
-    q.push(&source);
-
-    while(!q.empty()) {
-        node = q.front();
-        processOnGrey(*node);
-        assert(node != NULL);
-        edge = node->getEdgeList();
-        while(edge != NULL) {
-            assert(edge->getCurrentNodeId() == node->getId());
-            other = (V*)&(getNodeById(edge->getOtherNodeId()));
-            clr = other->getColor();
-            if (clr == V::WHITE) {
-                other->setDist2Source(other->getDist2Source() + 1);
-                other->setColor(V::GRAY);
-                other->setParent(*node);
-                q.push(other);
+    typename Stats::Phase phase(stats, "bfs");
+    ws.prepare(getNodeCount(), stats);
+
+    // Queue is reserved to node count, it never reallocates.
+    vector<int>& q = ws.queue;
+    q.clear();
+    ws.setColor(root, Workspace::GRAY);
+    ws.setDist2Source(root, 0);
+    q.push_back(root);
+    stats.push();
+    stats.reachedLevel(0);
+
+    for (size_t head = 0; head < q.size(); head++) {
+        int idx = q[head];
+        const V& node = nodes[idx];
+        visitor.processOnGrey(node);
+        if (visitor.finished())
+            break;
+        int dist = ws.getDist2Source(idx) + 1;
+
+        for (const E* edge = node.getEdgeList(); edge != NULL; edge = edge->getNext()) {
+            assert(edge->getCurrentNodeId() == node.getId());
+            stats.edgeScanned();
+            int other = edge->getOtherAdjecencyIndex();
+            if (ws.getColor(other) == Workspace::WHITE) {
+                ws.setColor(other, Workspace::GRAY);
+                ws.setDist2Source(other, dist);
+                ws.setParent(other, idx, edge->getId());
+                q.push_back(other);
+                stats.push();
+                stats.reachedLevel(dist);
             }
-            edge = edge->getNext();
         }
-        q.pop();
-        node->setColor(V::BLACK);
-        processOnBlack(*node);
+        stats.pop();
+        ws.setColor(idx, Workspace::BLACK);
+        visitor.processOnBlack(node);
     }
 }
 
 template<class V, class E>
-void GraphBase<V,E>::depthFirstRoutine(V& node, int component_id) {
-    static int count = 0;
-    E* edge = node.getEdgeList();
-    V* other;
-    static map<int, E*> edge_mp;
-    node.setEntryTime(count++);
-    node.setColor(V::GRAY);
-    node.setComponentId(component_id);
-    processOnGrey(node);
-    while(edge != NULL) {
-        int edge_id = edge->getId();
-        typename map<int, E*>::iterator it = edge_mp.find(edge_id);
-
-        other = (V*)(&getNodeById(edge->getOtherNodeId()));
-        typename V::COLOR clr = other->getColor();
-
-        if (it == edge_mp.end()) {
-            edge_mp[edge_id] = edge;
-
-            if (clr == V::WHITE)
-                edge->setType(E::TREE_EDGE);
-            else if (clr == V::GRAY)
-                edge->setType(E::BACK_EDGE);
-            else {
-                int node_entry_tm = node.getEntryTime();
-                int other_entry_tm = other->getEntryTime();
-
-                if (node_entry_tm < other_entry_tm)
-                    edge->setType(E::FORWARD_EDGE);
-                else
-                    edge->setType(E::CROSS_EDGE);
-            }
-        } else {
-            // This means graph is undirected.
-            assert (!isDirected());
-            E* tmp = it->second;
-            assert(tmp != NULL);
+void GraphBase<V,E>::shortestPaths(const V& source, vector<float>& dist, vector<int>& parent) {
+    NoTraversalStats stats;
+    shortestPaths(source, dist, parent, stats);
+}
 
-            edge->setType(tmp->getType());
+template<class V, class E>
+template<class Stats>
+void GraphBase<V,E>::shortestPaths(const V& source, vector<float>& dist, vector<int>& parent, Stats& stats) {
+    typename Stats::Phase phase(stats, "sssp");
+    dist.assign(getNodeCount(), -1);
+    parent.assign(getNodeCount(), -1);
+
+    const_mp_iterator it = id_idx_mp.find(source.getId());
+    if (it == id_idx_mp.end()) {
+        cerr << "Node not present" << endl;
+        return;
+    }
+
+    // Lazy deletion instead of decrease key,
+    // stale entries are skipped when popped.
+    typedef pair<float, int> dist_idx;
+    typedef vector<dist_idx, typename Stats::template Allocator<dist_idx>::type> pq_vector;
+    priority_queue<dist_idx, pq_vector, greater<dist_idx> > pq(greater<dist_idx>(),
+                                                             pq_vector(stats.template allocator<dist_idx>()));
+    vector<bool> settled(getNodeCount(), false);
+
+    dist[it->second] = 0;
+    pq.push(dist_idx(0, it->second));
+    stats.push();
+    while (!pq.empty()) {
+        int idx = pq.top().second;
+        pq.pop();
+        stats.pop();
+        if (settled[idx])
+            continue;
+        settled[idx] = true;
+
+        E* edge = nodes[idx].getEdgeList();
+        while (edge != NULL) {
+            stats.edgeScanned();
+            int other = edge->getOtherAdjecencyIndex();
+            float d = dist[idx] + edge->getWeight();
+            if (!settled[other] && (dist[other] < 0 || d < dist[other])) {
+                dist[other] = d;
+                parent[other] = idx;
+                pq.push(dist_idx(d, other));
+                stats.push();
+            }
+            edge = edge->getNext();
         }
+    }
+}
 
-        processEdge(edge);
+template<class V, class E>
+void GraphBase<V,E>::multiSourceBFS(const vector<int>& source_ids, vector<int>& dist) const {
+    const int n = getNodeCount();
+    dist.assign((size_t)source_ids.size() * n, -1);
+
+    vector<int> sources(source_ids.size());
+    for (size_t i = 0; i < source_ids.size(); i++)
+        sources[i] = indexOf(source_ids[i]);
+
+    for (size_t first = 0; first < sources.size(); first += DefaultSourceMask::BITS) {
+        int count = min((size_t)DefaultSourceMask::BITS, sources.size() - first);
+        multiSourceBatch<DefaultSourceMask>(&sources[first], count, &dist[first * n]);
+    }
+}
 
-        if (clr == V::WHITE) {
-            other->setParent(node);
-            depthFirstRoutine(*other, component_id);
+// seen holds searches that reached a node, visit those that reached it
+// on the last level. Each level ORs visit of every node into its
+// neighbours and keeps the bits not seen before.
+template<class V, class E>
+template<class Mask>
+void GraphBase<V,E>::multiSourceBatch(const int* sources, int count, int* dist) const {
+    const int n = getNodeCount();
+    vector<Mask> seen(n), visit(n), next(n);
+    for (int v = 0; v < n; v++) {
+        seen[v].clear();
+        visit[v].clear();
+        next[v].clear();
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (sources[i] == -1)
+            continue;
+        seen[sources[i]].set(i);
+        visit[sources[i]].set(i);
+        dist[(size_t)i * n + sources[i]] = 0;
+    }
+
+    struct Record {
+        int* dist;
+        int n, node, level;
+        void operator ()(int bit) { dist[(size_t)bit * n + node] = level;}
+    } record = {dist, n, 0, 0};
+
+    for (int level = 1; ; level++) {
+        for (int v = 0; v < n; v++) {
+            if (visit[v].empty())
+                continue;
+            for (const E* edge = nodes[v].getEdgeList(); edge != NULL; edge = edge->getNext())
+                next[edge->getOtherAdjecencyIndex()] |= visit[v];
+        }
+
+        bool changed = false;
+        record.level = level;
+        for (int v = 0; v < n; v++) {
+            next[v].remove(seen[v]);
+            visit[v] = next[v];
+            next[v].clear();
+            if (visit[v].empty())
+                continue;
+            changed = true;
+            seen[v] |= visit[v];
+            record.node = v;
+            visit[v].forEach(record);
         }
-        edge = edge->getNext();
+        if (!changed)
+            break;
     }
+}
 
-    node.setExitTime(count++);
-    node.setColor(V::BLACK);
-    processOnBlack(node);
+template<class V, class E>
+void GraphBase<V,E>::depthFirstRoutine(V& node, int component_id) {
+    NoTraversalStats stats;
+    VirtualHooks hooks(this);
+    // Subclasses call this after reset(), which does not size state, and
+    // may have inserted nodes since the last traversal.
+    state.grow(getNodeCount());
+    depthFirstRoutine(state, node.getAdjecencyIndex(), component_id, hooks, stats);
+}
+
+// Iterative, every frame on the stack is a grey node together with
+// the next of its edges to be examined.
+template<class V, class E>
+template<class Visitor, class Stats>
+void GraphBase<V,E>::depthFirstRoutine(Workspace& ws, int idx, int component_id, Visitor& visitor, Stats& stats) const {
+    vector< pair<int, const E*> >& stack = ws.stack;
+    stack.clear();
+
+    ws.setEntryTime(idx, ws.clock++);
+    ws.setColor(idx, Workspace::GRAY);
+    ws.setComponentId(idx, component_id);
+    visitor.processOnGrey(nodes[idx]);
+    stack.push_back(pair<int, const E*>(idx, nodes[idx].getEdgeList()));
+    stats.push();
+
+    while (!stack.empty()) {
+        int node = stack.back().first;
+        const E* edge = stack.back().second;
+
+        if (edge == NULL) {
+            stack.pop_back();
+            stats.pop();
+            ws.setExitTime(node, ws.clock++);
+            ws.setColor(node, Workspace::BLACK);
+            visitor.processOnBlack(nodes[node]);
+            continue;
+        }
+        stack.back().second = edge->getNext();
+
+        stats.edgeScanned();
+        int other = edge->getOtherAdjecencyIndex();
+        typename Workspace::COLOR clr = ws.getColor(other);
+
+        typename E::EDGE_TYPE type;
+        if (clr == Workspace::WHITE)
+            type = E::TREE_EDGE;
+        else if (!isDirected())
+            // Other half of an undirected edge gets the type of the
+            // half seen first, the tree edge up to the parent or a
+            // back edge seen from the descendant.
+            type = (other == ws.getParent(node) && edge->getId() == ws.getParentEdge(node)) ?
+                    E::TREE_EDGE : E::BACK_EDGE;
+        else if (clr == Workspace::GRAY)
+            type = E::BACK_EDGE;
+        else if (ws.getEntryTime(node) < ws.getEntryTime(other))
+            type = E::FORWARD_EDGE;
+        else
+            type = E::CROSS_EDGE;
+
+        visitor.processEdge(edge, type);
+        if (visitor.finished())
+            return;
+
+        if (clr == Workspace::WHITE) {
+            ws.setParent(other, node, edge->getId());
+            ws.setEntryTime(other, ws.clock++);
+            ws.setColor(other, Workspace::GRAY);
+            ws.setComponentId(other, component_id);
+            visitor.processOnGrey(nodes[other]);
+            stack.push_back(pair<int, const E*>(other, nodes[other].getEdgeList()));
+            stats.push();
+        }
+    }
 }
 
 template<class V, class E>
 void GraphBase<V,E>::depthFirstSearch() {
+    NoTraversalStats stats;
+    depthFirstSearch(stats);
+}
+
+template<class V, class E>
+template<class Stats>
+void GraphBase<V,E>::depthFirstSearch(Stats& stats) {
+    VirtualHooks hooks(this);
+    depthFirstVisit(hooks, stats);
+}
+
+template<class V, class E>
+template<class Visitor>
+void GraphBase<V,E>::depthFirstVisit(Visitor& visitor) {
+    NoTraversalStats stats;
+    depthFirstVisit(visitor, stats);
+}
+
+template<class V, class E>
+template<class Visitor, class Stats>
+void GraphBase<V,E>::depthFirstVisit(Visitor& visitor, Stats& stats) {
+    depthFirstVisit(state, visitor, stats);
+}
+
+template<class V, class E>
+void GraphBase<V,E>::depthFirstSearch(Workspace& ws) const {
+    GraphVisitor<V,E> visitor;
+    NoTraversalStats stats;
+    depthFirstVisit(ws, visitor, stats);
+}
+
+template<class V, class E>
+template<class Visitor, class Stats>
+void GraphBase<V,E>::depthFirstVisit(Workspace& ws, Visitor& visitor, Stats& stats) const {
+    typename Stats::Phase phase(stats, "dfs");
+    ws.prepare(getNodeCount(), stats);
     int component_id = 0;
-    for (iterator it = begin(); it != end(); it++) {
-        if (it->getColor() == V::WHITE)
-            depthFirstRoutine(*it, component_id++);
+    for (int idx = 0; idx < getNodeCount() && !visitor.finished(); idx++) {
+        if (ws.getColor(idx) == Workspace::WHITE)
+            depthFirstRoutine(ws, idx, component_id++, visitor, stats);
     }
 }
 
 template<class V, class E>
-bool GraphBase<V,E>::isCyclic() {
-    depthFirstSearch();
-    for (iterator it = begin(); it != end(); it++) {
-
-        E* edge = it->getEdgeList();
-        while(edge != NULL) {
-            if (edge->getType() == E::BACK_EDGE)
-                return true;
-            edge = edge->getNext();
+class GraphBase<V,E>::CycleDetector : public GraphVisitor<V,E> {
+    public:
+        bool cyclic;
+        CycleDetector() : cyclic(false) {}
+        void processEdge(const E* edge, typename E::EDGE_TYPE type) {
+            if (type == E::BACK_EDGE)
+                cyclic = true;
         }
-        return false;
-    }
+        bool finished() const { return cyclic;}
+};
+
+template<class V, class E>
+bool GraphBase<V,E>::isCyclic() {
+    CycleDetector detector;
+    NoTraversalStats stats;
+    depthFirstVisit(detector, stats);
+    return detector.cyclic;
 }
 
 
 template<class V, class E>
 void GraphBase<V,E>::topsort() {
+    NoTraversalStats stats;
+    topsort(stats);
+}
+
+template<class V, class E>
+template<class Stats>
+void GraphBase<V,E>::topsort(Stats& stats) {
+    typename Stats::Phase phase(stats, "topsort");
 
     // Do depth first search to calculate exit Time.
-    depthFirstSearch();
+    depthFirstSearch(stats);
+
+    // Order of increasing exit time.
+    vector<int> order(getNodeCount());
+    {
+        typename Stats::Phase sort_phase(stats, "sort");
+        vector< pair<int, int> > exit_times(getNodeCount());
+        for (int i = 0; i < getNodeCount(); i++)
+            exit_times[i] = pair<int, int>(state.getExitTime(i), i);
+        sort(exit_times.begin(), exit_times.end());
+        for (int i = 0; i < getNodeCount(); i++)
+            order[i] = exit_times[i].second;
+    }
+
+    // Indexes have changed so reset edge map
+    // and reset adj values.
+    typename Stats::Phase reindex_phase(stats, "reindex");
+    permuteNodes(order);
 
 #ifdef DEBUG
-    for (iterator it = begin(); it != end(); it++) {
-        cout << it->getExitTime()<<" ";
+    for (int i = 0; i < getNodeCount(); i++) {
+        cout << state.getExitTime(i) << " ";
     }
     cout << endl;
 #endif
+}
 
-    sort(begin(), end(), compareExitTimeInc);
+template<class V, class E>
+void GraphBase<V,E>::permuteNodes(const vector<int>& order) {
+    vector<int> position(order.size());
+    vector<V> permuted;
+    permuted.reserve(order.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        position[order[i]] = i;
+        permuted.push_back(nodes[order[i]]);
+        permuted.back().setAdjecencyIndex(i);
+        id_idx_mp[permuted.back().getId()] = i;
+    }
+    nodes.swap(permuted);
+
+    for (typename LabelMap::iterator it = label_idx_mp.begin(); it != label_idx_mp.end(); it++)
+        it->second = position[it->second];
 
-    // Indexes have changed so reset edge map
-    // and reset adj values.
-    int i = 0;
     for (iterator it = begin(); it != end(); it++) {
-        it->setAdjecencyIndex(i++);
-        id_idx_mp[it->getId()] = it->getAdjecencyIndex();
+        for (E* edge = it->getEdgeList(); edge != NULL; edge = edge->getNext())
+            edge->setOtherAdjecencyIndex(position[edge->getOtherAdjecencyIndex()]);
     }
+    state.permute(order);
+}
 
-#ifdef DEBUG
+template<class V, class E>
+void GraphBase<V,E>::reorder(ORDER strategy) {
+    int n = getNodeCount();
+    vector<int> offsets(n + 1, 0);
+    for (int i = 0; i < n; i++) {
+        offsets[i + 1] += nodes[i].getOutDegree();
+        if (isDirected())
+            for (const E* edge = nodes[i].getEdgeList(); edge != NULL; edge = edge->getNext())
+                offsets[edge->getOtherAdjecencyIndex() + 1]++;
+    }
+    for (int i = 0; i < n; i++)
+        offsets[i + 1] += offsets[i];
+    vector<int> targets(offsets[n]);
+    vector<int> cursor(offsets.begin(), offsets.end() - 1);
+    for (int i = 0; i < n; i++) {
+        for (const E* edge = nodes[i].getEdgeList(); edge != NULL; edge = edge->getNext()) {
+            targets[cursor[i]++] = edge->getOtherAdjecencyIndex();
+            if (isDirected())
+                targets[cursor[edge->getOtherAdjecencyIndex()]++] = i;
+        }
+    }
 
-    for (iterator it = begin(); it != end(); it++) {
-        cout << it->getExitTime() << " ";
+    vector<int> order;
+    switch (strategy) {
+        case RCM: NodeOrder::reverseCuthillMcKee(offsets, targets, order); break;
+        case DEGREE: NodeOrder::degree(offsets, targets, order); break;
+        case HUB: NodeOrder::hubCluster(offsets, targets, order); break;
+        case GORDER: NodeOrder::gorder(offsets, targets, order); break;
     }
-    cout << endl;
-#endif
+    permuteNodes(order);
+
+    // Edges were allocated one at a time as they were created, a
+    // structural copy allocates them in node order.
+    Workspace kept;
+    swap(kept, state);
+    GraphBase compact(*this);
+    hardResetGraph();
+    takeFrom(compact);
+    swap(state, kept);
 }
 
+// splitmix64 finalizer. Node and edge hashes are summed, so the
+// fingerprint does not depend on insertion order and a removal is a
+// subtraction.
 template<class V, class E>
-bool GraphBase<V, E>::operator ==(const GraphBase<V,E>& graph) {
-    if (getNodeCount() != graph.getNodeCount()) {
-        return false;
+uint64_t GraphBase<V,E>::mixHash(uint64_t key) {
+    key += 0x9e3779b97f4a7c15ULL;
+    key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+    return key ^ (key >> 31);
+}
+
+template<class V, class E>
+uint64_t GraphBase<V,E>::nodeHash(int id) {
+    return mixHash((uint32_t)id);
+}
+
+// Undirected edges are hashed once per half, which keeps the sum the
+// same for either orientation.
+template<class V, class E>
+uint64_t GraphBase<V,E>::edgeHash(const E* edge) {
+    float weight = edge->getWeight();
+    uint32_t bits = 0;
+    if (weight != 0.0f)     // -0.0 == 0.0
+        memcpy(&bits, &weight, sizeof(bits));
+    uint64_t ends = ((uint64_t)(uint32_t)edge->getCurrentNodeId() << 32) | (uint32_t)edge->getOtherNodeId();
+    return mixHash(mixHash(ends) ^ bits);
+}
+
+template<class V, class E>
+uint64_t GraphBase<V,E>::computeFingerprint() const {
+    uint64_t hash = 0;
+    for (const_iterator it = cbegin(); it != cend(); it++) {
+        hash += nodeHash(it->getId());
+        for (const E* edge = it->getEdgeList(); edge != NULL; edge = edge->getNext())
+            hash += edgeHash(edge);
     }
+    return hash;
+}
 
-    if (getEdgeCount() != graph.getEdgeCount()) {
+template<class V, class E>
+bool GraphBase<V, E>::operator ==(const GraphBase<V,E>& graph) const {
+    if (getNodeCount() != graph.getNodeCount() ||
+        getEdgeCount() != graph.getEdgeCount() ||
+        fingerprint != graph.fingerprint) {
         return false;
     }
 
-    for(const_iterator it = graph.cbegin(); it != graph.cend(); it++) {
-
-        if (id_idx_mp.find(it->getId()) == id_idx_mp.end()) {
+    vector< pair<int, float> > mine, theirs;
+    for (const_iterator it = graph.cbegin(); it != graph.cend(); it++) {
+        int idx = indexOf(it->getId());
+        if (idx == -1 || nodes[idx].getOutDegree() != it->getOutDegree())
             return false;
-        }
 
-        V& node = getNodeById(it->getId());
+        mine.clear();
+        theirs.clear();
+        for (const E* edge = nodes[idx].getEdgeList(); edge != NULL; edge = edge->getNext())
+            mine.push_back(pair<int, float>(edge->getOtherNodeId(), edge->getWeight()));
+        for (const E* edge = it->getEdgeList(); edge != NULL; edge = edge->getNext())
+            theirs.push_back(pair<int, float>(edge->getOtherNodeId(), edge->getWeight()));
+        if (mine.size() != theirs.size())
+            return false;
+        sort(mine.begin(), mine.end());
+        sort(theirs.begin(), theirs.end());
+        if (mine != theirs)
+            return false;
+    }
+    return true;
+}
 
-        E* tmp1 = node.getEdgeList();
-        E* tmp2 = it->getEdgeList();
+template<class V, class E>
+GraphBase<V,E>::GraphBase(const GraphBase<V,E>& graph) :
+    nEdges(0),
+    directed(graph.isDirected()),
+    fingerprint(0) {
+    cloneFrom(graph);
+}
 
-        bool edge_found = false;
-        while(tmp2 != NULL) {
-            while(tmp1 != NULL) {
-                if (*tmp1 == *tmp2) {
-                    edge_found = true;
-                    break;
-                }
-                tmp1 = tmp1->getNext();
-            }
-            if (!edge_found) {
-                return false;
-            }
-            tmp2 = tmp2->getNext();
-        }
+template<class V, class E>
+GraphBase<V,E>& GraphBase<V,E>::operator =(const GraphBase<V,E>& graph) {
+    if (this != &graph) {
+        hardResetGraph();
+        cloneFrom(graph);
     }
-    return true;
+    return *this;
 }
 
 template<class V, class E>
-GraphBase<V,E>::GraphBase(const GraphBase<V,E>& graph) {
-    directed = graph.isDirected();
-    nEdges = 0;
-    for(const_iterator it = graph.cbegin(); it != graph.cend(); it++) {
-         V node(*it);
-         // Copy constructor copies everything
-         // All you need in new graph is user inputted data and id
-         // So do a hard reset to wipe other data.
-         //
-         // Another reason for doing so is that we want deep copy not shallow
-         // copy
-         // So for that we need to create similar but new edges.
-         node.reset(V::HARD_RESET);
-
-         insertNode(node);
-    }
-    assert(graph.getNodeCount() == getNodeCount());
-
-    // Copying edges
-    for(const_iterator it = graph.cbegin(); it != graph.cend(); it++) {
-        E* tmp = it->getEdgeList();
-        while(tmp != NULL) {
-            createEdge( getNodeById(tmp->getCurrentNodeId()),
-                        getNodeById(tmp->getOtherNodeId()),
-                        tmp->getWeight());
-            tmp = tmp->getNext();
-        }
+GraphBase<V,E>::GraphBase(GraphBase<V,E>&& graph) :
+    nEdges(0),
+    directed(graph.isDirected()),
+    fingerprint(0) {
+    takeFrom(graph);
+}
+
+template<class V, class E>
+GraphBase<V,E>& GraphBase<V,E>::operator =(GraphBase<V,E>&& graph) {
+    if (this != &graph) {
+        hardResetGraph();
+        takeFrom(graph);
     }
+    return *this;
 }
 
-// Totally same as above.
+// Nodes are copied in iteration order, so indices, the id and label
+// maps and cached edge indices carry over unchanged. Edges are copied
+// list by list; twins are paired up by their shared id and in lists are
+// rebuilt as edges arrive.
 template<class V, class E>
-GraphBase<V,E>& GraphBase<V,E>::operator =(const GraphBase<V,E>& graph) {
+void GraphBase<V,E>::cloneFrom(const GraphBase<V,E>& graph) {
     directed = graph.isDirected();
-    nEdges = 0;
-    for(const_iterator it = graph.cbegin(); it != graph.cend(); it++) {
-         V node(*it);
-         node.reset(V::HARD_RESET);
-         insertNode(node);
+    nEdges = graph.nEdges;
+    fingerprint = graph.fingerprint;
+    id_idx_mp = graph.id_idx_mp;
+    label_idx_mp = graph.label_idx_mp;
+    nodes = graph.nodes;
+    for (iterator it = begin(); it != end(); it++) {
+        it->setEdgeList(NULL);
+        it->setInEdgeList(NULL);
     }
-    assert(graph.getNodeCount() == getNodeCount());
 
-    for(iterator it = graph.begin(); it != graph.end(); it++) {
-        E* tmp = it->getEdgeList();
-        while(tmp != NULL) {
-            createEdge( getNodeById(tmp->getCurrentNodeId()),
-                        getNodeById(tmp->getOtherNodeId()),
-                        tmp->getWeight());
-            tmp = tmp->getNext();
+    unordered_map<int, E*> unpaired;
+    if (!isDirected())
+        unpaired.reserve(nEdges / 2);
+    for (int i = 0; i < getNodeCount(); i++) {
+        E* prevEdge = NULL;
+        for (const E* edge = graph.nodes[i].getEdgeList(); edge != NULL; edge = edge->getNext()) {
+            E* newEdge = new E(*edge);
+            newEdge->setId(edge->getId());
+            newEdge->setOtherAdjecencyIndex(edge->getOtherAdjecencyIndex());
+            newEdge->setPrev(prevEdge);
+            if (prevEdge != NULL)
+                prevEdge->setNext(newEdge);
+            else
+                nodes[i].setEdgeList(newEdge);
+            prevEdge = newEdge;
+
+            if (isDirected()) {
+                V& other = nodes[edge->getOtherAdjecencyIndex()];
+                newEdge->setInNext(other.getInEdgeList());
+                if (other.getInEdgeList() != NULL)
+                    other.getInEdgeList()->setInPrev(newEdge);
+                other.setInEdgeList(newEdge);
+            } else if (edge->getTwin() != NULL) {
+                typename unordered_map<int, E*>::iterator twin = unpaired.find(edge->getId());
+                if (twin == unpaired.end()) {
+                    unpaired[edge->getId()] = newEdge;
+                } else {
+                    newEdge->setTwin(twin->second);
+                    twin->second->setTwin(newEdge);
+                    unpaired.erase(twin);
+                }
+            }
         }
     }
-    return *this;
 }
 
 template<class V, class E>
-void GraphBase<V,E>::deleteEdge(E* edge) {
-    V& currNode = (V&)getNodeById(edge->getCurrentNodeId());
-    V& otherNode = (V&)getNodeById(edge->getOtherNodeId());
-    E* edge_list = currNode.getEdgeList();
+void GraphBase<V,E>::takeFrom(GraphBase<V,E>& graph) {
+    directed = graph.directed;
+    nEdges = graph.nEdges;
+    id_idx_mp.swap(graph.id_idx_mp);
+    label_idx_mp.swap(graph.label_idx_mp);
+    nodes.swap(graph.nodes);
+    swap(state, graph.state);
+    fingerprint = graph.fingerprint;
+    graph.nEdges = 0;
+    graph.fingerprint = 0;
+}
 
-    //assert(edge_list != NULL);
+// Unlinks edge from its node's list (and from the in list of the other
+// node for directed graphs) and frees it, no list walk.
+template<class V, class E>
+void GraphBase<V,E>::unlinkEdge(E* edge) {
+    V& currNode = nodes[indexOf(edge->getCurrentNodeId())];
+    V& otherNode = nodes[edge->getOtherAdjecencyIndex()];
 
-    if (edge == edge_list) {
+    if (edge->getPrev() != NULL)
+        edge->getPrev()->setNext(edge->getNext());
+    else
         currNode.setEdgeList(edge->getNext());
-    } else if (edge->getNext() != NULL) {
-        E* tmp = edge->getNext();
-        edge->setNext(tmp->getNext());
-        delete tmp;
-    } else {
-        E* tmp = edge_list;
-        while(tmp->getNext() != edge) {
-            tmp = tmp->getNext();
-        }
-        tmp->setNext(NULL);
-    }
+    if (edge->getNext() != NULL)
+        edge->getNext()->setPrev(edge->getPrev());
 
     currNode.decOutDegree();
-    if (isDirected())
+    if (isDirected()) {
+        if (edge->getInPrev() != NULL)
+            edge->getInPrev()->setInNext(edge->getInNext());
+        else
+            otherNode.setInEdgeList(edge->getInNext());
+        if (edge->getInNext() != NULL)
+            edge->getInNext()->setInPrev(edge->getInPrev());
         otherNode.decInDegree();
-    else
+    } else {
         currNode.decInDegree();
+    }
     nEdges--;
+    fingerprint -= edgeHash(edge);
+    delete edge;
 }
 
 template<class V, class E>
-void GraphBase<V,E>::transpose() {
-    if (isDirected()) {
-        int largest_edge_id = -1;
-        for (iterator it = begin(); it != end(); it++) {
-            E* tmp = it->getEdgeList();
+void GraphBase<V,E>::deleteEdge(E* edge) {
+    E* twin = static_cast<E*>(edge->getTwin());
+    unlinkEdge(edge);
+    if (twin != NULL)
+        unlinkEdge(twin);
+}
 
-            while(tmp != NULL) {
-                if (tmp->getId() > largest_edge_id) {
-                    largest_edge_id = tmp->getId();
-                }
-                tmp = tmp->getNext();
+// Only an edge found in the out list of its node here is deleted. Copies
+// are in no list, and edges of a clone, whose node ids are the same, are
+// in the lists of the clone. O(out degree).
+template<class V, class E>
+bool GraphBase<V,E>::removeEdge(const E& edge) {
+    int idx = indexOf(edge.getCurrentNodeId());
+    if (idx == -1)
+        return false;
+    for (E* it = nodes[idx].getEdgeList(); it != NULL; it = it->getNext()) {
+        if (it == &edge) {
+            deleteEdge(it);
+            return true;
+        }
+    }
+    return false;
+}
+
+template<class V, class E>
+bool GraphBase<V,E>::removeEdge(V& V1, V& V2) {
+    int idx1 = indexOf(V1.getId());
+    int idx2 = indexOf(V2.getId());
+    if (idx1 == -1 || idx2 == -1)
+        return false;
+
+    for (E* edge = nodes[idx1].getEdgeList(); edge != NULL; edge = edge->getNext()) {
+        if (edge->getOtherAdjecencyIndex() == idx2) {
+            deleteEdge(edge);
+            return true;
+        }
+    }
+    return false;
+}
+
+template<class V, class E>
+int GraphBase<V,E>::removeEdges(const vector< pair<int, int> >& ends) {
+    // Group by source so that each source list is walked once,
+    // targets of a group are sorted for binary search.
+    vector< pair<int, int> > batch;
+    batch.reserve(ends.size());
+    for (size_t i = 0; i < ends.size(); i++) {
+        int src = indexOf(ends[i].first);
+        int dst = indexOf(ends[i].second);
+        if (src != -1 && dst != -1)
+            batch.push_back(pair<int, int>(src, dst));
+    }
+    sort(batch.begin(), batch.end());
+    batch.erase(unique(batch.begin(), batch.end()), batch.end());
+
+    int removed = 0;
+    for (size_t first = 0; first < batch.size(); ) {
+        size_t last = first;
+        vector<int> targets;
+        while (last < batch.size() && batch[last].first == batch[first].first)
+            targets.push_back(batch[last++].second);
+
+        // For undirected graphs a twin removed from a list walked later
+        // is simply not found there any more.
+        E* edge = nodes[batch[first].first].getEdgeList();
+        while (edge != NULL) {
+            E* next = edge->getNext();
+            vector<int>::iterator target = lower_bound(targets.begin(), targets.end(), edge->getOtherAdjecencyIndex());
+            if (target != targets.end() && *target == edge->getOtherAdjecencyIndex()) {
+                deleteEdge(edge);
+                removed++;
+                // One edge per pair like removeEdge(V1, V2).
+                targets.erase(target);
             }
+            edge = next;
         }
-        for (iterator it = begin(); it != end(); it++) {
-            E* tmp = it->getEdgeList();
-
-            while(tmp != NULL) {
-                V& node1 = (V&)getNodeById(tmp->getCurrentNodeId());
-                V& node2 = (V&)getNodeById(tmp->getOtherNodeId());
-                float weight = tmp->getWeight();
-                if (tmp->getId() <= largest_edge_id) {
-                    E* tmp2 = tmp->getNext();
-                    deleteEdge(tmp);
-                    // Id is assigned in create edge
-                    // so copy constructor will not be
-                    // problem
-                    createEdge(node2, node1, weight);
-                    tmp = tmp2;
-                } else {
-                    tmp = tmp->getNext();
-                }
+        first = last;
+    }
+    return removed;
+}
+
+template<class V, class E>
+bool GraphBase<V,E>::removeNode(const V& node) {
+    int idx = indexOf(node.getId());
+    if (idx == -1)
+        return false;
+
+    while (nodes[idx].getEdgeList() != NULL)
+        deleteEdge(nodes[idx].getEdgeList());
+    while (nodes[idx].getInEdgeList() != NULL)
+        deleteEdge(nodes[idx].getInEdgeList());
+
+    id_idx_mp.erase(nodes[idx].getId());
+    fingerprint -= nodeHash(nodes[idx].getId());
+    typename LabelMap::iterator lbl = label_idx_mp.find(&nodes[idx].getLabel());
+    if (lbl != label_idx_mp.end() && lbl->second == idx)
+        label_idx_mp.erase(lbl);
+
+    int last = getNodeCount() - 1;
+    if (idx != last) {
+        // Node assignment writes through the value reference,
+        // so the last node is copy constructed into the slot.
+        nodes[idx].~V();
+        new (&nodes[idx]) V(nodes[last]);
+        nodes[idx].setAdjecencyIndex(idx);
+        id_idx_mp[nodes[idx].getId()] = idx;
+        lbl = label_idx_mp.find(&nodes[idx].getLabel());
+        if (lbl != label_idx_mp.end() && lbl->second == last)
+            lbl->second = idx;
+
+        // Edges into the moved node cache its old index.
+        if (isDirected()) {
+            for (E* edge = nodes[idx].getInEdgeList(); edge != NULL; edge = edge->getInNext())
+                edge->setOtherAdjecencyIndex(idx);
+        } else {
+            // Self loops may have no twin, their index is fixed below.
+            for (E* edge = nodes[idx].getEdgeList(); edge != NULL; edge = edge->getNext()) {
+                E* twin = static_cast<E*>(edge->getTwin());
+                if (twin != NULL)
+                    twin->setOtherAdjecencyIndex(idx);
+                if (edge->getOtherAdjecencyIndex() == last)
+                    edge->setOtherAdjecencyIndex(idx);
             }
         }
     }
+    nodes.pop_back();
+    state.clear();
+    return true;
 }
 
+// Every directed edge already sits on the in list of its target, so
+// reversing is relinking in place: no allocation and edge ids are kept.
 template<class V, class E>
-typename GraphBase<V,E>::ComponentGraph& GraphBase<V,E>::stronglyConnectedComponents() {
-    list<int> q;
-    // top sort to run depth first search
-    // and order entries according to exit time.
-    topsort();
-    // not calling reset because coz other field too might be populated
-    for (iterator it = begin(); it != end(); it++) {
+void GraphBase<V,E>::transpose() {
+    if (!isDirected())
+        return;
 
-        it->setColor(V::WHITE);
-        it->setComponentId(-1);
+    for (int i = 0; i < getNodeCount(); i++) {
+        E* edge = nodes[i].getEdgeList();
+        while (edge != NULL) {
+            E* next = edge->getNext();
+            edge->reverse(i);
+            edge = next;
+        }
     }
-    transpose();
-    typename vector<V>::reverse_iterator rit;
+    for (iterator it = begin(); it != end(); it++)
+        it->swapEdgeLists();
+    fingerprint = computeFingerprint();
+}
+
+template<class V, class E>
+typename GraphBase<V,E>::ComponentGraph GraphBase<V,E>::stronglyConnectedComponents() {
+    NoTraversalStats stats;
+    return stronglyConnectedComponents(stats);
+}
+
+template<class V, class E>
+template<class Stats>
+typename GraphBase<V,E>::ComponentGraph GraphBase<V,E>::stronglyConnectedComponents(Stats& stats) {
+    typename Stats::Phase phase(stats, "scc");
+    // top sort to run depth first search
+    // and order entries according to exit time.
+    topsort(stats);
+    // Fresh colors and component ids, exit times are not needed any more,
+    // they are in the order of nodes now.
+    state.prepare(getNodeCount(), stats);
     int components = 0;
-    for (rit = nodes.rbegin(); rit != nodes.rend(); rit++) {
-        if (rit->getColor() == V::WHITE) {
-            depthFirstRoutine(*rit, components++);
-            q.push_back(rit->getId());
+    {
+        typename Stats::Phase transpose_phase(stats, "transpose");
+        transpose();
+    }
+    {
+        typename Stats::Phase dfs_phase(stats, "transposed_dfs");
+        VirtualHooks hooks(this);
+        for (int idx = getNodeCount() - 1; idx >= 0; idx--) {
+            if (state.getColor(idx) == Workspace::WHITE)
+                depthFirstRoutine(state, idx, components++, hooks, stats);
         }
     }
-    ComponentGraph* comp_graph = new ComponentGraph(components, isDirected());
+    ComponentGraph comp_graph(components, isDirected());
 
     // To revert back to original configuration
-    transpose();
-
+    {
+        typename Stats::Phase transpose_phase(stats, "transpose");
+        transpose();
+    }
 
-    // not calling reset because coz other field too might be populated
+    typename Stats::Phase build_phase(stats, "build_components");
     for (iterator it = begin(); it != end(); it++) {
-        GraphBase& graph = comp_graph->getGraphForComponentId(it->getComponentId());
+        GraphBase& graph = comp_graph.getGraphForComponentId(state.getComponentId(it->getAdjecencyIndex()));
         graph.insertNode(*it);
-        it->setColor(V::WHITE);
     }
 
-
-    while (!q.empty()){
-        int node_id = q.front();
-        q.pop_front();
-        V& node1 = getNodeById(node_id);
-        int component_id = node1.getComponentId();
-        GraphBase<V,E>& graph = comp_graph->getGraphForComponentId(component_id);
-        node1.setColor(V::GRAY);
-
-        E* edge = node1.getEdgeList();
-        while(edge != NULL) {
-            assert(node_id == edge->getCurrentNodeId());
-
-            V& node2 = getNodeById(edge->getOtherNodeId());
-            if (node2.getColor() == V::WHITE) {
-                q.push_back(node2.getId());
-            }
-            if (component_id == node2.getComponentId()) {
-                graph.createEdge(node1, node2, edge->getWeight());
+    for (iterator it = begin(); it != end(); it++) {
+        int component_id = state.getComponentId(it->getAdjecencyIndex());
+        GraphBase<V,E>& graph = comp_graph.getGraphForComponentId(component_id);
+
+        for (E* edge = it->getEdgeList(); edge != NULL; edge = edge->getNext()) {
+            stats.edgeScanned();
+            V& other = nodes[edge->getOtherAdjecencyIndex()];
+            if (component_id == state.getComponentId(other.getAdjecencyIndex())) {
+                graph.createEdge(*it, other, edge->getWeight());
             } else {
-                comp_graph->addEdge(*edge);
+                comp_graph.addEdge(*edge);
             }
-            edge = edge->getNext();
         }
-        node1.setColor(V::BLACK);
     }
-    return *comp_graph;
+    return comp_graph;
 }
 
 template<typename T>
@@ -808,6 +1501,9 @@ class Graph :public GraphBase<Node<T>, Edge> {
     public:
         Graph(): GraphBase<Node<T>, Edge>(){} ;
         Graph(const Graph<T>& graph):GraphBase<Node<T>, Edge>(graph) {};
+        Graph(Graph<T>&& graph):GraphBase<Node<T>, Edge>(std::move(graph)) {};
+        Graph& operator =(const Graph<T>& graph) { GraphBase<Node<T>, Edge>::operator =(graph); return *this;}
+        Graph& operator =(Graph<T>&& graph) { GraphBase<Node<T>, Edge>::operator =(std::move(graph)); return *this;}
         Graph(bool directed):GraphBase<Node<T>, Edge>(directed){};
         friend class TestGraph;
 };
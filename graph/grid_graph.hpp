@@ -0,0 +1,470 @@
+#include<vector>
+#include<string>
+#include<fstream>
+#include<sstream>
+#include<cstdio>
+#include<unordered_map>
+#include<stdint.h>
+#include<string.h>
+#include "graph.hpp"
+#ifndef __GRID_GRAPH__
+#define __GRID_GRAPH__
+using namespace std;
+
+/*
+ * Graph kept on disk as a grid of edge blocks, for graphs whose edges do
+ * not fit in memory.
+ *
+ * Iteration indices are cut into P chunks of consecutive nodes. Block
+ * (i, j) holds every edge from a node of chunk i to a node of chunk j as
+ * a pair of ints, and blocks are stored row by row, so all out edges of a
+ * chunk are one sequential read. Undirected edges are stored in both
+ * directions.
+ *
+ * Algorithms keep one value per node in memory and stream the blocks
+ * through a single buffer of the size given to open, skipping the blocks
+ * that cannot change anything this pass. Only per node arrays and the
+ * buffer are ever in memory, never the edges.
+ *
+ * File layout, native byte order:
+ *      "GRID", directed, node count, P (int32), edge count (int64)
+ *      ids (int32 x n), out degrees (int32 x n)
+ *      start of every block in edges, row major (int64 x P * P + 1)
+ *      edges (int32 pairs source, target)
+ */
+class GridGraph {
+    public:
+        // Writes a grid file from edges added one at a time, in any order.
+        // Edges go to one temporary file per row first, then every row is
+        // sorted into its blocks, so memory holds one row at a time.
+        class Builder {
+            public:
+                // Node ids default to the iteration index.
+                Builder(const string& path, int n, bool directed, int partitions);
+                ~Builder();
+
+                // An index outside 0 .. n - 1 here or in addEdge is not
+                // added and makes finish fail.
+                void setNodeId(int idx, int id) {
+                    if (idx < 0 || idx >= (int)ids.size())
+                        failed = true;
+                    else
+                        ids[idx] = id;
+                }
+                // Adds src -> dst, and dst -> src if undirected.
+                void addEdge(int src, int dst) {
+                    addArc(src, dst);
+                    if (!directed)
+                        addArc(dst, src);
+                }
+                // Assembles the file and removes the temporary ones. False
+                // if a file could not be written or an index was invalid.
+                bool finish();
+
+            private:
+                friend class GridGraph;
+                string path;
+                bool directed;
+                int partitions;
+                int chunk_size;
+                bool failed;
+                vector<int> ids;
+                vector<int> degrees;
+                vector<fstream*> rows;
+
+                string rowPath(int row) const;
+                void addArc(int src, int dst);
+        };
+
+        GridGraph() : directed(false), partitions(1), chunk_size(1), edge_count(0), data_start(0), bytes_read(0) {}
+
+        // Writes graph as a grid of partitions x partitions blocks.
+        template<class V, class E>
+        static bool write(const GraphBase<V,E>& graph, const string& path, int partitions);
+
+        // Reads the node arrays of a grid file and keeps it open for
+        // streaming through a buffer of buffer_bytes. False if the file
+        // is missing or not a grid file.
+        bool open(const string& path, size_t buffer_bytes);
+
+        bool isDirected() const { return directed;}
+        int getNodeCount() const { return ids.size();}
+        long long getEdgeCount() const { return directed ? edge_count : edge_count / 2;}
+        int getPartitionCount() const { return partitions;}
+        int getNodeId(int idx) const { return ids[idx];}
+        // Iteration index of node id, -1 if not present.
+        int indexOf(int id) const;
+        int getOutDegree(int idx) const { return degrees[idx];}
+        // Chunk holding node idx.
+        int chunkOf(int idx) const { return idx / chunk_size;}
+
+        // Bytes of edge blocks read from disk since open.
+        long long getBytesRead() const { return bytes_read;}
+
+        // Reads block (i, j) when rows[i] or cols[j] is set and calls
+        // visitor.processEdge(src, dst) for every edge in it. Blocks come
+        // in file order, adjacent blocks in a single read. Stops and returns
+        // false on a short read or an edge with an end out of range, which
+        // only a truncated or damaged file has.
+        template<class Visitor>
+        bool streamBlocks(Visitor& visitor, const vector<char>& rows, const vector<char>& cols);
+
+        // Hop count from source index, -1 if not reached. One pass over
+        // the rows of the frontier per level. False if the file could not
+        // be read, dist is then partial.
+        bool breadthFirstSearch(int source, vector<int>& dist);
+        // Weakly connected components: component[idx] in 0 .. count - 1,
+        // numbered in order of their first node. Returns count, -1 if the
+        // file could not be read.
+        int connectedComponents(vector<int>& component);
+        // Rank of every node after iterations passes over all blocks.
+        // Rank of nodes without out edges is spread over all nodes. False
+        // if the file could not be read.
+        bool pageRank(vector<double>& rank, int iterations = 20, double damping = 0.85);
+
+    private:
+        bool directed;
+        int partitions;
+        int chunk_size;
+        long long edge_count;
+        vector<int> ids;
+        unordered_map<int, int> id_idx_mp;
+        vector<int> degrees;
+        vector<int64_t> block_offsets;
+        ifstream file;
+        streamoff data_start;
+        vector<int32_t> buffer;
+        long long bytes_read;
+
+        static int chunkSize(int n, int partitions) { return n == 0 ? 1 : (n + partitions - 1) / partitions;}
+
+        class BFSVisitor;
+        class ComponentVisitor;
+        class RankVisitor;
+};
+
+inline GridGraph::Builder::Builder(const string& path, int n, bool directed, int partitions) :
+    path(path),
+    directed(directed),
+    partitions(max(1, partitions)),
+    chunk_size(GridGraph::chunkSize(n, max(1, partitions))),
+    failed(false),
+    ids(n),
+    degrees(n, 0),
+    rows(max(1, partitions), (fstream*)NULL) {
+    for (int i = 0; i < n; i++)
+        ids[i] = i;
+}
+
+inline GridGraph::Builder::~Builder() {
+    for (size_t row = 0; row < rows.size(); row++) {
+        if (rows[row] != NULL) {
+            delete rows[row];
+            remove(rowPath(row).c_str());
+        }
+    }
+}
+
+inline string GridGraph::Builder::rowPath(int row) const {
+    stringstream ss;
+    ss << path << ".row" << row;
+    return ss.str();
+}
+
+// Row files are created on first use, rows without edges never are.
+inline void GridGraph::Builder::addArc(int src, int dst) {
+    int n = ids.size();
+    if (src < 0 || src >= n || dst < 0 || dst >= n) {
+        failed = true;
+        return;
+    }
+    int row = src / chunk_size;
+    if (rows[row] == NULL) {
+        rows[row] = new fstream(rowPath(row).c_str(), ios::in | ios::out | ios::binary | ios::trunc);
+        failed |= !*rows[row];
+    }
+    int32_t arc[2] = {src, dst};
+    rows[row]->write((const char*)arc, sizeof(arc));
+    degrees[src]++;
+}
+
+inline bool GridGraph::Builder::finish() {
+    int n = ids.size();
+    ofstream out(path.c_str(), ios::binary | ios::trunc);
+    if (!out || failed)
+        return false;
+
+    vector<int64_t> offsets(partitions * partitions + 1, 0);
+    vector<int64_t> row_sizes(partitions, 0);
+    for (int row = 0; row < partitions; row++) {
+        if (rows[row] != NULL) {
+            rows[row]->flush();
+            row_sizes[row] = rows[row]->tellp() / (2 * sizeof(int32_t));
+        }
+    }
+    int32_t header[3] = {directed, n, partitions};
+    int64_t total = 0;
+    for (int row = 0; row < partitions; row++)
+        total += row_sizes[row];
+    out.write("GRID", 4);
+    out.write((const char*)header, sizeof(header));
+    out.write((const char*)&total, sizeof(total));
+    out.write((const char*)ids.data(), n * sizeof(int32_t));
+    out.write((const char*)degrees.data(), n * sizeof(int32_t));
+    // Offsets are only known row by row, write room for them now.
+    streamoff offsets_at = out.tellp();
+    out.write((const char*)offsets.data(), offsets.size() * sizeof(int64_t));
+
+    vector<int32_t> arcs, sorted;
+    vector<int64_t> cursor(partitions);
+    int64_t written = 0;
+    for (int row = 0; row < partitions; row++) {
+        arcs.resize(2 * row_sizes[row]);
+        if (row_sizes[row] > 0) {
+            rows[row]->seekg(0);
+            rows[row]->read((char*)arcs.data(), arcs.size() * sizeof(int32_t));
+        }
+        // Counting sort by column.
+        vector<int64_t> counts(partitions + 1, 0);
+        for (int64_t a = 0; a < row_sizes[row]; a++)
+            counts[arcs[2 * a + 1] / chunk_size + 1]++;
+        for (int col = 0; col < partitions; col++) {
+            counts[col + 1] += counts[col];
+            offsets[row * partitions + col] = written + counts[col];
+            cursor[col] = counts[col];
+        }
+        sorted.resize(arcs.size());
+        for (int64_t a = 0; a < row_sizes[row]; a++) {
+            int64_t to = cursor[arcs[2 * a + 1] / chunk_size]++;
+            sorted[2 * to] = arcs[2 * a];
+            sorted[2 * to + 1] = arcs[2 * a + 1];
+        }
+        out.write((const char*)sorted.data(), sorted.size() * sizeof(int32_t));
+        written += row_sizes[row];
+    }
+    offsets[partitions * partitions] = written;
+    out.seekp(offsets_at);
+    out.write((const char*)offsets.data(), offsets.size() * sizeof(int64_t));
+    out.close();
+    return !out.fail();
+}
+
+template<class V, class E>
+bool GridGraph::write(const GraphBase<V,E>& graph, const string& path, int partitions) {
+    int n = graph.getNodeCount();
+    Builder builder(path, n, graph.isDirected(), partitions);
+    typename GraphBase<V,E>::const_iterator node = graph.cbegin();
+    for (int i = 0; i < n; i++, node++) {
+        builder.setNodeId(i, node->getId());
+        // Undirected edges show up at both ends already.
+        EdgeRange<const E> range = graph.neighborsAt(i);
+        for (typename EdgeRange<const E>::iterator it = range.begin(); it != range.end(); ++it)
+            builder.addArc(i, it.otherIndex());
+    }
+    return builder.finish();
+}
+
+inline bool GridGraph::open(const string& path, size_t buffer_bytes) {
+    if (file.is_open())
+        file.close();
+    file.clear();
+    file.open(path.c_str(), ios::binary);
+    char magic[4];
+    int32_t header[3];
+    int64_t total;
+    if (!file.read(magic, 4) || memcmp(magic, "GRID", 4) != 0)
+        return false;
+    if (!file.read((char*)header, sizeof(header)) || !file.read((char*)&total, sizeof(total)))
+        return false;
+    if (header[1] < 0 || header[2] < 1)
+        return false;
+
+    directed = header[0];
+    int n = header[1];
+    partitions = header[2];
+    chunk_size = chunkSize(n, partitions);
+    edge_count = total;
+    ids.resize(n);
+    degrees.resize(n);
+    block_offsets.resize(partitions * partitions + 1);
+    file.read((char*)ids.data(), n * sizeof(int32_t));
+    file.read((char*)degrees.data(), n * sizeof(int32_t));
+    file.read((char*)block_offsets.data(), block_offsets.size() * sizeof(int64_t));
+    if (!file)
+        return false;
+    data_start = file.tellg();
+
+    id_idx_mp.clear();
+    id_idx_mp.reserve(n);
+    for (int i = 0; i < n; i++)
+        id_idx_mp[ids[i]] = i;
+    buffer.resize(2 * max((size_t)1, buffer_bytes / (2 * sizeof(int32_t))));
+    bytes_read = 0;
+    return true;
+}
+
+inline int GridGraph::indexOf(int id) const {
+    unordered_map<int, int>::const_iterator it = id_idx_mp.find(id);
+    return it == id_idx_mp.end() ? -1 : it->second;
+}
+
+template<class Visitor>
+bool GridGraph::streamBlocks(Visitor& visitor, const vector<char>& rows, const vector<char>& cols) {
+    uint32_t n = getNodeCount();
+    int blocks = partitions * partitions;
+    int64_t capacity = buffer.size() / 2;
+    for (int b = 0; b < blocks; ) {
+        if (!rows[b / partitions] && !cols[b % partitions]) {
+            b++;
+            continue;
+        }
+        // Run of wanted blocks, read as one range.
+        int end = b + 1;
+        while (end < blocks && (rows[end / partitions] || cols[end % partitions]))
+            end++;
+        int64_t first = block_offsets[b], last = block_offsets[end];
+        file.clear();
+        file.seekg(data_start + (streamoff)(first * 2 * sizeof(int32_t)));
+        while (first < last) {
+            int64_t count = min(capacity, last - first);
+            file.read((char*)buffer.data(), count * 2 * sizeof(int32_t));
+            bytes_read += file.gcount();
+            if (file.gcount() != (streamsize)(count * 2 * sizeof(int32_t)))
+                return false;
+            for (int64_t a = 0; a < count; a++) {
+                // Negative ends wrap to large unsigned values.
+                if ((uint32_t)buffer[2 * a] >= n || (uint32_t)buffer[2 * a + 1] >= n)
+                    return false;
+                visitor.processEdge(buffer[2 * a], buffer[2 * a + 1]);
+            }
+            first += count;
+        }
+        b = end;
+    }
+    return true;
+}
+
+class GridGraph::BFSVisitor {
+    public:
+        BFSVisitor(const GridGraph& graph, vector<int>& dist, vector<char>& next) :
+            graph(graph), dist(dist), next(next), level(0), found(false) {}
+
+        void processEdge(int src, int dst) {
+            if (dist[src] == level && dist[dst] == -1) {
+                dist[dst] = level + 1;
+                next[graph.chunkOf(dst)] = 1;
+                found = true;
+            }
+        }
+
+        const GridGraph& graph;
+        vector<int>& dist;
+        vector<char>& next;
+        int level;
+        bool found;
+};
+
+inline bool GridGraph::breadthFirstSearch(int source, vector<int>& dist) {
+    dist.assign(getNodeCount(), -1);
+    if (source < 0 || source >= getNodeCount())
+        return true;
+
+    dist[source] = 0;
+    vector<char> frontier(partitions, 0), next(partitions, 0), none(partitions, 0);
+    frontier[chunkOf(source)] = 1;
+    BFSVisitor visitor(*this, dist, next);
+    do {
+        visitor.found = false;
+        if (!streamBlocks(visitor, frontier, none))
+            return false;
+        frontier.swap(next);
+        next.assign(partitions, 0);
+        visitor.level++;
+    } while (visitor.found);
+    return true;
+}
+
+// Min label propagation over both directions of every edge. A block is
+// read again only if a label at one of its ends changed in the last pass.
+class GridGraph::ComponentVisitor {
+    public:
+        ComponentVisitor(const GridGraph& graph, vector<int>& label, vector<char>& changed) :
+            graph(graph), label(label), changed(changed), any(false) {}
+
+        void processEdge(int src, int dst) {
+            if (label[src] < label[dst]) {
+                label[dst] = label[src];
+                changed[graph.chunkOf(dst)] = 1;
+                any = true;
+            } else if (label[dst] < label[src]) {
+                label[src] = label[dst];
+                changed[graph.chunkOf(src)] = 1;
+                any = true;
+            }
+        }
+
+        const GridGraph& graph;
+        vector<int>& label;
+        vector<char>& changed;
+        bool any;
+};
+
+inline int GridGraph::connectedComponents(vector<int>& component) {
+    int n = getNodeCount();
+    component.resize(n);
+    for (int i = 0; i < n; i++)
+        component[i] = i;
+    vector<char> active(partitions, 1), changed(partitions, 0);
+    ComponentVisitor visitor(*this, component, changed);
+    do {
+        visitor.any = false;
+        if (!streamBlocks(visitor, active, active))
+            return -1;
+        active.swap(changed);
+        changed.assign(partitions, 0);
+    } while (visitor.any);
+
+    // Labels are the smallest index of each component, make them dense.
+    int count = 0;
+    for (int i = 0; i < n; i++)
+        component[i] = component[i] == i ? count++ : component[component[i]];
+    return count;
+}
+
+class GridGraph::RankVisitor {
+    public:
+        RankVisitor(const vector<double>& contribution, vector<double>& sum) :
+            contribution(contribution), sum(sum) {}
+
+        void processEdge(int src, int dst) { sum[dst] += contribution[src];}
+
+        const vector<double>& contribution;
+        vector<double>& sum;
+};
+
+inline bool GridGraph::pageRank(vector<double>& rank, int iterations, double damping) {
+    int n = getNodeCount();
+    rank.assign(n, n > 0 ? 1.0 / n : 0.0);
+    vector<double> contribution(n), sum(n);
+    vector<char> all(partitions, 1), none(partitions, 0);
+    RankVisitor visitor(contribution, sum);
+    for (int iter = 0; iter < iterations; iter++) {
+        double dangling = 0;
+        for (int i = 0; i < n; i++) {
+            if (degrees[i] == 0) {
+                dangling += rank[i];
+                contribution[i] = 0;
+            } else {
+                contribution[i] = rank[i] / degrees[i];
+            }
+            sum[i] = 0;
+        }
+        if (!streamBlocks(visitor, all, none))
+            return false;
+        double base = (1 - damping + damping * dangling) / n;
+        for (int i = 0; i < n; i++)
+            rank[i] = base + damping * sum[i];
+    }
+    return true;
+}
+#endif
@@ -0,0 +1,95 @@
+#include<vector>
+#include<utility>
+#include "workspace.hpp"
+#ifndef __INDEX_TRAVERSAL__
+#define __INDEX_TRAVERSAL__
+using namespace std;
+
+/*
+ * Workspace BFS and DFS reading a graph by iteration index only.
+ *
+ * G needs getNodeCount(), isDirected() and neighborsAt(idx) returning a
+ * G::NeighborRange whose iterators give otherIndex(), which GraphBase and
+ * CompressedGraph both have. Results are recorded in a TraversalWorkspace
+ * as by the workspace traversals of GraphBase: colour, distance and
+ * parent for BFS, entry and exit times, parent and component for DFS.
+ * There are no edge ids, so parent edges stay -1, and no visitors.
+ */
+class IndexTraversal {
+    public:
+        // Nothing is recorded if source is not an index of graph.
+        template<class G, class E>
+        static void breadthFirstSearch(const G& graph, TraversalWorkspace<E>& ws, int source);
+        // Roots in index order, components numbered from 0.
+        template<class G, class E>
+        static void depthFirstSearch(const G& graph, TraversalWorkspace<E>& ws);
+};
+
+template<class G, class E>
+void IndexTraversal::breadthFirstSearch(const G& graph, TraversalWorkspace<E>& ws, int source) {
+    ws.prepare(graph.getNodeCount());
+    if (source < 0 || source >= graph.getNodeCount())
+        return;
+
+    vector<int>& q = ws.queue;
+    q.clear();
+    ws.setColor(source, TraversalWorkspace<E>::GRAY);
+    ws.setDist2Source(source, 0);
+    q.push_back(source);
+    for (size_t head = 0; head < q.size(); head++) {
+        int idx = q[head];
+        int dist = ws.getDist2Source(idx) + 1;
+        typename G::NeighborRange range = graph.neighborsAt(idx);
+        for (typename G::NeighborRange::iterator it = range.begin(); it != range.end(); ++it) {
+            int other = it.otherIndex();
+            if (ws.getColor(other) == TraversalWorkspace<E>::WHITE) {
+                ws.setColor(other, TraversalWorkspace<E>::GRAY);
+                ws.setDist2Source(other, dist);
+                ws.setParent(other, idx, -1);
+                q.push_back(other);
+            }
+        }
+        ws.setColor(idx, TraversalWorkspace<E>::BLACK);
+    }
+}
+
+// Iterative like GraphBase::depthFirstRoutine. The stack holds range
+// iterators, whose type depends on G, so it is not the workspace's.
+template<class G, class E>
+void IndexTraversal::depthFirstSearch(const G& graph, TraversalWorkspace<E>& ws) {
+    typedef typename G::NeighborRange::iterator iterator;
+    ws.prepare(graph.getNodeCount());
+    vector< pair<int, iterator> > stack;
+    stack.reserve(graph.getNodeCount());
+    int component_id = 0;
+    for (int root = 0; root < graph.getNodeCount(); root++) {
+        if (ws.getColor(root) != TraversalWorkspace<E>::WHITE)
+            continue;
+        ws.setEntryTime(root, ws.clock++);
+        ws.setColor(root, TraversalWorkspace<E>::GRAY);
+        ws.setComponentId(root, component_id);
+        stack.push_back(pair<int, iterator>(root, graph.neighborsAt(root).begin()));
+
+        while (!stack.empty()) {
+            int node = stack.back().first;
+            iterator& it = stack.back().second;
+            if (it == graph.neighborsAt(node).end()) {
+                stack.pop_back();
+                ws.setExitTime(node, ws.clock++);
+                ws.setColor(node, TraversalWorkspace<E>::BLACK);
+                continue;
+            }
+            int other = it.otherIndex();
+            ++it;
+            if (ws.getColor(other) == TraversalWorkspace<E>::WHITE) {
+                ws.setParent(other, node, -1);
+                ws.setEntryTime(other, ws.clock++);
+                ws.setColor(other, TraversalWorkspace<E>::GRAY);
+                ws.setComponentId(other, component_id);
+                stack.push_back(pair<int, iterator>(other, graph.neighborsAt(other).begin()));
+            }
+        }
+        component_id++;
+    }
+}
+#endif
@@ -0,0 +1,237 @@
+#include<iostream>
+#include<string>
+#include<vector>
+#include<mutex>
+#include<atomic>
+#include<functional>
+#include<stdint.h>
+#include<stdlib.h>
+#ifndef __LABEL_POOL__
+#define __LABEL_POOL__
+using namespace std;
+
+/*
+ * Interned, reference counted node labels.
+ *
+ * Every distinct label in use is stored once and nodes keep a 32 bit
+ * handle to it, so copying a node copies an int and two labels are equal
+ * exactly when their handles are. Handle 0 is the empty (default) label
+ * and is not counted. A label is freed with the last handle to it and
+ * its slot goes on a free list for the next new label.
+ *
+ * Nodes exist before and outside any graph, so the pool is shared by all
+ * of them. It is split into SHARDS by hash of the label, each with its
+ * own lock, slots and table, so interning from several graphs or threads
+ * rarely waits. Slots live in chunks that double in size and never move:
+ * reading the label of a handle and taking another reference to it lock
+ * nothing. Only interning a string and dropping the last reference lock
+ * the shard.
+ *
+ * On 64 bit a label costs about 64 bytes of pool (a 40 byte slot, chunk
+ * slack and table) plus the string's buffer past the small string size,
+ * and 4 bytes in every node holding it. A string member cost 32 bytes
+ * plus the buffer in every copy, so the pool pays off from the second
+ * copy of a node, and insertNode always makes one.
+ */
+class LabelPool {
+    public:
+        typedef uint32_t Handle;
+        static const Handle DEFAULT = 0;
+
+        // Never destroyed, so nodes in static storage can still release
+        // their labels at exit.
+        static LabelPool& shared() {
+            static LabelPool* pool = new LabelPool();
+            return *pool;
+        }
+
+        // Handle holding one reference to label, added if new.
+        Handle intern(const string& label);
+        // Another reference to a handle the caller holds.
+        Handle retain(Handle handle) {
+            if (handle != DEFAULT)
+                slot(handle).refs.fetch_add(1, memory_order_relaxed);
+            return handle;
+        }
+        // Drops one reference, the label is freed with the last one.
+        void release(Handle handle);
+        // Reference stays valid while the handle is held.
+        const string& get(Handle handle) const {
+            static const string empty;
+            return handle == DEFAULT ? empty : slot(handle).text;
+        }
+        // Labels in use.
+        size_t size() const;
+
+        // Hash and equality of label text through a pointer, for maps
+        // keyed by the string of a handle and looked up by any string.
+        struct TextHash {
+            size_t operator()(const string* text) const { return hash<string>()(*text);}
+        };
+        struct TextEqual {
+            bool operator()(const string* a, const string* b) const { return *a == *b;}
+        };
+
+    private:
+        static const int SHARD_BITS = 4;
+        static const int SHARDS = 1 << SHARD_BITS;
+        // Chunk c holds 2^(c + FIRST_CHUNK_BITS) slots.
+        static const int FIRST_CHUNK_BITS = 6;
+        static const int CHUNKS = 23;
+        static const uint32_t MAX_SLOTS = (1u << 28) - 1;
+
+        struct Slot {
+            Slot() : refs(0) {}
+            string text;
+            atomic<uint32_t> refs;
+        };
+
+        // Handles are 1 + (slot << SHARD_BITS | shard). The table is open
+        // addressing with linear probing over handles, 0 for empty cells.
+        struct Shard {
+            Shard() : used(0), count(0), table(16, 0) {
+                for (int c = 0; c < CHUNKS; c++)
+                    chunks[c].store(NULL, memory_order_relaxed);
+            }
+            mutable mutex lock;
+            atomic<Slot*> chunks[CHUNKS];
+            uint32_t used;
+            vector<uint32_t> free_slots;
+            size_t count;
+            vector<Handle> table;
+        };
+
+        Shard shards[SHARDS];
+
+        LabelPool() {}
+        LabelPool(const LabelPool& pool);
+
+        static int shardOf(Handle handle) { return (handle - 1) & (SHARDS - 1);}
+        static Handle handleOf(int shard, uint32_t index) { return ((index << SHARD_BITS) | shard) + 1;}
+        Slot& slot(Handle handle) const;
+        static size_t hashOf(const string& text) { return hash<string>()(text);}
+        // Cell of label in the table of shard, or of the empty cell ending
+        // its probe.
+        size_t findCell(const Shard& shard, const string& label, size_t hash) const;
+        Handle allocate(Shard& shard, int s, const string& label);
+        void grow(Shard& shard);
+        void erase(Shard& shard, Handle handle);
+};
+
+// Slot i is entry i + 64 - 2^c of chunk c, with c + 6 the highest bit of
+// i + 64.
+inline LabelPool::Slot& LabelPool::slot(Handle handle) const {
+    uint32_t index = ((handle - 1) >> SHARD_BITS) + (1u << FIRST_CHUNK_BITS);
+    int bit = 31 - __builtin_clz(index);
+    Slot* chunk = shards[shardOf(handle)].chunks[bit - FIRST_CHUNK_BITS].load(memory_order_acquire);
+    return chunk[index - (1u << bit)];
+}
+
+inline size_t LabelPool::findCell(const Shard& shard, const string& label, size_t hash) const {
+    size_t mask = shard.table.size() - 1;
+    size_t cell = hash & mask;
+    while (shard.table[cell] != DEFAULT && slot(shard.table[cell]).text != label)
+        cell = (cell + 1) & mask;
+    return cell;
+}
+
+// A count reaches zero only in release, under the lock, where the label
+// also leaves the table. So a handle found here is never being freed.
+inline LabelPool::Handle LabelPool::intern(const string& label) {
+    if (label.empty())
+        return DEFAULT;
+    size_t hash = hashOf(label);
+    int s = hash & (SHARDS - 1);
+    Shard& shard = shards[s];
+    lock_guard<mutex> guard(shard.lock);
+    size_t cell = findCell(shard, label, hash >> SHARD_BITS);
+    if (shard.table[cell] != DEFAULT) {
+        slot(shard.table[cell]).refs.fetch_add(1, memory_order_relaxed);
+        return shard.table[cell];
+    }
+    Handle handle = allocate(shard, s, label);
+    shard.table[cell] = handle;
+    if (++shard.count * 2 > shard.table.size())
+        grow(shard);
+    return handle;
+}
+
+inline LabelPool::Handle LabelPool::allocate(Shard& shard, int s, const string& label) {
+    uint32_t index;
+    if (!shard.free_slots.empty()) {
+        index = shard.free_slots.back();
+        shard.free_slots.pop_back();
+    } else {
+        if (shard.used == MAX_SLOTS) {
+            cerr << "LabelPool full" << endl;
+            exit(-1);
+        }
+        index = shard.used++;
+        uint32_t shifted = index + (1u << FIRST_CHUNK_BITS);
+        int bit = 31 - __builtin_clz(shifted);
+        // First slot of a chunk.
+        if (shifted == (1u << bit))
+            shard.chunks[bit - FIRST_CHUNK_BITS].store(new Slot[1u << bit], memory_order_release);
+    }
+    Handle handle = handleOf(s, index);
+    Slot& entry = slot(handle);
+    entry.text = label;
+    entry.refs.store(1, memory_order_relaxed);
+    return handle;
+}
+
+inline void LabelPool::grow(Shard& shard) {
+    vector<Handle> old(shard.table.size() * 2, Handle(DEFAULT));
+    old.swap(shard.table);
+    for (size_t i = 0; i < old.size(); i++) {
+        if (old[i] == DEFAULT)
+            continue;
+        const string& text = slot(old[i]).text;
+        shard.table[findCell(shard, text, hashOf(text) >> SHARD_BITS)] = old[i];
+    }
+}
+
+// Backward shift: later cells of the probe run move into the hole unless
+// their home cell lies cyclically after it.
+inline void LabelPool::erase(Shard& shard, Handle handle) {
+    size_t mask = shard.table.size() - 1;
+    const string& text = slot(handle).text;
+    size_t hole = findCell(shard, text, hashOf(text) >> SHARD_BITS);
+    for (size_t cell = (hole + 1) & mask; shard.table[cell] != DEFAULT; cell = (cell + 1) & mask) {
+        size_t home = (hashOf(slot(shard.table[cell]).text) >> SHARD_BITS) & mask;
+        if (((cell - home) & mask) >= ((cell - hole) & mask)) {
+            shard.table[hole] = shard.table[cell];
+            hole = cell;
+        }
+    }
+    shard.table[hole] = DEFAULT;
+    shard.count--;
+}
+
+// References other than the last are dropped without the lock.
+inline void LabelPool::release(Handle handle) {
+    if (handle == DEFAULT)
+        return;
+    Slot& entry = slot(handle);
+    uint32_t refs = entry.refs.load(memory_order_relaxed);
+    while (refs > 1)
+        if (entry.refs.compare_exchange_weak(refs, refs - 1, memory_order_acq_rel))
+            return;
+    Shard& shard = shards[shardOf(handle)];
+    lock_guard<mutex> guard(shard.lock);
+    if (entry.refs.fetch_sub(1, memory_order_acq_rel) == 1) {
+        erase(shard, handle);
+        string().swap(entry.text);
+        shard.free_slots.push_back((handle - 1) >> SHARD_BITS);
+    }
+}
+
+inline size_t LabelPool::size() const {
+    size_t total = 0;
+    for (int s = 0; s < SHARDS; s++) {
+        lock_guard<mutex> guard(shards[s].lock);
+        total += shards[s].count;
+    }
+    return total;
+}
+#endif
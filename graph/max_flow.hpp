@@ -0,0 +1,323 @@
+#include<vector>
+#include<algorithm>
+#include "graph.hpp"
+#ifndef __MAX_FLOW__
+#define __MAX_FLOW__
+using namespace std;
+
+/*
+ * Maximum flow and minimum cut by push-relabel, edge weights as
+ * capacities.
+ *
+ * Every edge u -> v becomes an arc of its capacity and a reverse arc
+ * v -> u of capacity 0, paired through getReverse. An undirected edge is
+ * both u -> v and v -> u and so gets two pairs. Arcs are stored by tail.
+ *
+ * solve runs in two phases. The first pushes as much as possible into
+ * the sink (preflow), with exact labels recomputed by a backwards BFS from
+ * the sink every n relabels and the gap heuristic: once no node has
+ * label l, every node above l is cut off from the sink. That gives the
+ * flow value and the min cut. The second returns the excess left on cut
+ * off nodes to the source, so getFlow is a valid flow afterwards.
+ */
+class MaxFlow {
+    public:
+        // Order in which active nodes are discharged.
+        enum METHOD {FIFO, HIGHEST_LABEL};
+
+        MaxFlow() : flow_value(0), offsets(1, 0), queue_head(0), highest(0), source(-1), sink(-1) {}
+        template<class V, class E>
+        explicit MaxFlow(const GraphBase<V,E>& graph);
+
+        // Max flow from source to sink, iteration indices. Capacities are
+        // reset first, so it can be called again for other terminals.
+        double solve(int source, int sink, METHOD method = HIGHEST_LABEL);
+        double getFlowValue() const { return flow_value;}
+
+        int getNodeCount() const { return offsets.size() - 1;}
+        int getArcCount() const { return heads.size();}
+        // Arcs with tail idx are getArcOffset(idx) .. getArcOffset(idx + 1) - 1.
+        int getArcOffset(int idx) const { return offsets[idx];}
+        int getArcHead(int pos) const { return heads[pos];}
+        int getReverse(int pos) const { return reverses[pos];}
+        double getCapacity(int pos) const { return capacities[pos];}
+        // Capacity left on arc pos after solve.
+        double getResidual(int pos) const { return residuals[pos];}
+        // Flow on arc pos, negative on reverse arcs carrying flow back.
+        double getFlow(int pos) const { return capacities[pos] - residuals[pos];}
+        // Id of the edge arc pos was made for, -1 on reverse arcs.
+        int getEdgeId(int pos) const { return edge_ids[pos];}
+
+        // Side of idx in the min cut found by the last solve: nodes that
+        // cannot reach the sink in the residual graph.
+        bool isSourceSide(int idx) const { return source_side[idx];}
+        // Arcs from source side to sink side, their capacities add up to
+        // the flow value.
+        void getCutArcs(vector<int>& arcs) const;
+
+    private:
+        double flow_value;
+        vector<int> offsets;
+        vector<int> heads;
+        vector<int> reverses;
+        vector<double> capacities;
+        vector<double> residuals;
+        vector<int> edge_ids;
+        vector<char> source_side;
+
+        // Per solve state.
+        vector<int> labels;
+        vector<double> excess;
+        vector<int> current;
+        vector<int> label_count;
+        vector< vector<int> > buckets;
+        vector<int> queue;
+        size_t queue_head;
+        int highest;
+        int source;
+        int sink;
+
+        void globalRelabel(int target, int base);
+        void setLabel(int idx, int label);
+        void resetActive();
+        void activate(int idx, METHOD method);
+        int nextActive(METHOD method, int limit);
+        void discharge(int idx, int limit, METHOD method, bool gaps, int& relabels);
+        void gap(int empty);
+};
+
+template<class V, class E>
+MaxFlow::MaxFlow(const GraphBase<V,E>& graph) :
+    flow_value(0),
+    queue_head(0),
+    highest(0),
+    source(-1),
+    sink(-1) {
+    int n = graph.getNodeCount();
+    offsets.assign(n + 1, 0);
+    for (int u = 0; u < n; u++) {
+        EdgeRange<const E> range = graph.neighborsAt(u);
+        for (typename EdgeRange<const E>::iterator it = range.begin(); it != range.end(); ++it) {
+            offsets[u + 1]++;
+            offsets[it.otherIndex() + 1]++;
+        }
+    }
+    for (int u = 0; u < n; u++)
+        offsets[u + 1] += offsets[u];
+    int m = offsets[n];
+    heads.resize(m);
+    reverses.resize(m);
+    capacities.resize(m);
+    edge_ids.resize(m);
+    vector<int> cursor(offsets.begin(), offsets.end() - 1);
+    for (int u = 0; u < n; u++) {
+        EdgeRange<const E> range = graph.neighborsAt(u);
+        for (typename EdgeRange<const E>::iterator it = range.begin(); it != range.end(); ++it) {
+            int v = it.otherIndex();
+            int forward = cursor[u]++, backward = cursor[v]++;
+            heads[forward] = v;
+            heads[backward] = u;
+            reverses[forward] = backward;
+            reverses[backward] = forward;
+            capacities[forward] = it->getWeight();
+            capacities[backward] = 0;
+            edge_ids[forward] = it->getId();
+            edge_ids[backward] = -1;
+        }
+    }
+    residuals = capacities;
+    source_side.assign(n, 0);
+}
+
+// Exact distance to target over arcs with residual capacity, plus base.
+// Nodes that cannot reach target get 2n, out of reach of both phases.
+inline void MaxFlow::globalRelabel(int target, int base) {
+    int n = getNodeCount();
+    labels.assign(n, 2 * n);
+    label_count.assign(2 * n + 1, 0);
+    labels[target] = base;
+    vector<int> bfs(1, target);
+    for (size_t head = 0; head < bfs.size(); head++) {
+        int w = bfs[head];
+        for (int pos = offsets[w]; pos < offsets[w + 1]; pos++) {
+            int v = heads[pos];
+            if (labels[v] == 2 * n && residuals[reverses[pos]] > 0) {
+                labels[v] = labels[w] + 1;
+                bfs.push_back(v);
+            }
+        }
+    }
+    for (int v = 0; v < n; v++) {
+        label_count[labels[v]]++;
+        current[v] = offsets[v];
+    }
+}
+
+inline void MaxFlow::setLabel(int idx, int label) {
+    label_count[labels[idx]]--;
+    labels[idx] = label;
+    label_count[label]++;
+}
+
+inline void MaxFlow::resetActive() {
+    buckets.clear();
+    queue.clear();
+    queue_head = 0;
+    highest = 0;
+}
+
+// Terminals are never active.
+inline void MaxFlow::activate(int idx, METHOD method) {
+    if (idx == source || idx == sink)
+        return;
+    if (method == FIFO) {
+        queue.push_back(idx);
+    } else {
+        if ((int)buckets.size() <= labels[idx])
+            buckets.resize(labels[idx] + 1);
+        buckets[labels[idx]].push_back(idx);
+        highest = max(highest, labels[idx]);
+    }
+}
+
+// Entries go stale when a node is relabelled or drained, they are
+// skipped here. -1 when nothing is left below limit.
+inline int MaxFlow::nextActive(METHOD method, int limit) {
+    if (method == FIFO) {
+        if (queue_head > 4096 && 2 * queue_head > queue.size()) {
+            queue.erase(queue.begin(), queue.begin() + queue_head);
+            queue_head = 0;
+        }
+        while (queue_head < queue.size()) {
+            int v = queue[queue_head++];
+            if (excess[v] > 0 && labels[v] < limit)
+                return v;
+        }
+        return -1;
+    }
+    for (; highest >= 0; highest--) {
+        while (highest < (int)buckets.size() && !buckets[highest].empty()) {
+            int v = buckets[highest].back();
+            buckets[highest].pop_back();
+            if (excess[v] > 0 && labels[v] == highest && labels[v] < limit)
+                return v;
+        }
+    }
+    highest = 0;
+    return -1;
+}
+
+// Every node with a label between empty and n has lost its way to the
+// sink, lift them to n at once.
+inline void MaxFlow::gap(int empty) {
+    int n = getNodeCount();
+    for (int v = 0; v < n; v++) {
+        if (labels[v] > empty && labels[v] < n) {
+            setLabel(v, n);
+            current[v] = offsets[v];
+        }
+    }
+}
+
+inline void MaxFlow::discharge(int v, int limit, METHOD method, bool gaps, int& relabels) {
+    while (excess[v] > 0) {
+        if (current[v] == offsets[v + 1]) {
+            int old = labels[v], lowest = 2 * getNodeCount() - 1;
+            for (int pos = offsets[v]; pos < offsets[v + 1]; pos++)
+                if (residuals[pos] > 0)
+                    lowest = min(lowest, labels[heads[pos]]);
+            setLabel(v, lowest + 1);
+            current[v] = offsets[v];
+            relabels++;
+            if (gaps && old < getNodeCount() && label_count[old] == 0)
+                gap(old);
+            if (labels[v] >= limit)
+                return;
+            continue;
+        }
+        int pos = current[v];
+        int w = heads[pos];
+        if (residuals[pos] > 0 && labels[v] == labels[w] + 1) {
+            double delta = min(excess[v], residuals[pos]);
+            residuals[pos] -= delta;
+            residuals[reverses[pos]] += delta;
+            excess[v] -= delta;
+            if (excess[w] == 0)
+                activate(w, method);
+            excess[w] += delta;
+            if (excess[v] == 0)
+                return;
+        }
+        current[v]++;
+    }
+}
+
+inline double MaxFlow::solve(int from, int to, METHOD method) {
+    int n = getNodeCount();
+    residuals = capacities;
+    flow_value = 0;
+    source_side.assign(n, 0);
+    if (from < 0 || to < 0 || from >= n || to >= n || from == to)
+        return 0;
+    source = from;
+    sink = to;
+    excess.assign(n, 0);
+    current.assign(n, 0);
+    resetActive();
+
+    // Phase one, labels are distances to the sink.
+    globalRelabel(sink, 0);
+    setLabel(source, n);
+    for (int pos = offsets[source]; pos < offsets[source + 1]; pos++) {
+        double delta = residuals[pos];
+        int w = heads[pos];
+        if (delta <= 0 || w == source)
+            continue;
+        residuals[pos] = 0;
+        residuals[reverses[pos]] += delta;
+        if (excess[w] == 0)
+            activate(w, method);
+        excess[w] += delta;
+    }
+
+    int relabels = 0;
+    for (int v = nextActive(method, n); v != -1; v = nextActive(method, n)) {
+        discharge(v, n, method, true, relabels);
+        if (relabels >= n) {
+            relabels = 0;
+            globalRelabel(sink, 0);
+            setLabel(source, n);
+            resetActive();
+            for (int u = 0; u < n; u++)
+                if (excess[u] > 0 && labels[u] < n)
+                    activate(u, method);
+        }
+    }
+    flow_value = excess[sink];
+
+    // Min cut from what can still reach the sink.
+    globalRelabel(sink, 0);
+    for (int v = 0; v < n; v++)
+        source_side[v] = labels[v] == 2 * n;
+
+    // Phase two, labels are n plus distance to the source and excess
+    // flows back to it. Gaps do not apply above n.
+    globalRelabel(source, n);
+    resetActive();
+    for (int v = 0; v < n; v++)
+        if (excess[v] > 0)
+            activate(v, method);
+    for (int v = nextActive(method, 2 * n); v != -1; v = nextActive(method, 2 * n))
+        discharge(v, 2 * n, method, false, relabels);
+    return flow_value;
+}
+
+inline void MaxFlow::getCutArcs(vector<int>& arcs) const {
+    arcs.clear();
+    for (int v = 0; v < getNodeCount(); v++)
+        if (source_side[v])
+            for (int pos = offsets[v]; pos < offsets[v + 1]; pos++)
+                if (!source_side[heads[pos]] && capacities[pos] > 0)
+                    arcs.push_back(pos);
+}
+#endif
@@ -2,6 +2,7 @@
 #include<time.h>
 #include<stdlib.h>
 #include "edge.hpp"     //forward declaration will not work, because in decructor we call method of edge.
+#include "label_pool.hpp"
 #ifndef __NODE__
 #define __NODE__
 using namespace std;
@@ -22,14 +23,14 @@ template<class V, class E> class GraphBase;
 template<typename T>
 class Node {
     protected:
-        enum COLOR {WHITE, GRAY, BLACK};
         enum RESET {HARD_RESET, SOFT_RESET};
     public:
         static string DEFAULT_LABEL;
 
         Node(T& value);
-        Node(T& value, string label);
+        Node(T& value, const string& label);
         Node(const Node& node);
+        virtual ~Node() { LabelPool::shared().release(label);}
 
         // Populate node with random label
         virtual void populateNode(int graph_size);
@@ -51,7 +52,7 @@ class Node {
         // Its not in user domain
         int getId() const {return id;}
         T& getValue() const {return value;}
-        string getLabel() const {return label;}
+        const string& getLabel() const {return LabelPool::shared().get(label);}
 
         bool operator ==(const Node& node2);
         bool operator !=(const Node& node2);
@@ -59,43 +60,43 @@ class Node {
 
     private:
         static int count;
-        string label;   // labels are unique
+        LabelPool::Handle label;   // labels are unique, interned and counted
         T& value;      // need not be unique
         int id;
 
         int adj_index;
 
         Edge* edge_list;     // linked list of edges.
+        Edge* in_edge_list;  // edges into node, directed graphs only.
         int out_deg;
         int in_deg;
 
-        // Traversal Specific Variabls
-        COLOR color;
-        Node* parent;
-        Node* source;
-
-        // Populated with BFS
-        int dist2s;
-
-        // Populated while DFS
-        int entry_index;    // Global Count of nodes processed, when encountered
-        int exit_index;     // Global count of nodes when blackened.
-        int component_id;
-
-        // Spanning Tree Related
-        bool in_tree;
+        // Traversal state (color, parent, distance, entry/exit time...)
+        // is not kept here but in a TraversalWorkspace per run.
 
     protected:
 
 
         virtual void reset(RESET reset);
         void setValue(T& val) {value = val;}
-        void setLabel(string lbl) {label = lbl;}
+        void setLabel(const string& lbl) {
+            LabelPool::Handle old = label;
+            label = LabelPool::shared().intern(lbl);
+            LabelPool::shared().release(old);
+        }
+        LabelPool::Handle getLabelHandle() const {return label;}
 
         static string createRandomLabels(int nVertices);
 
         Edge* getEdgeList() const {return edge_list;}
         void setEdgeList(Edge* edge) {edge_list = edge;}
+        Edge* getInEdgeList() const {return in_edge_list;}
+        void setInEdgeList(Edge* edge) {in_edge_list = edge;}
+        // Out and in edges trade places, for transposing directed graphs.
+        void swapEdgeLists() {
+            swap(edge_list, in_edge_list);
+            swap(out_deg, in_deg);
+        }
 
         int getAdjecencyIndex() const {return adj_index;}
         void setAdjecencyIndex(int index) {adj_index = index;}
@@ -109,32 +110,6 @@ class Node {
         int getInDegree() const {return in_deg;}
         int getOutDegree() const {return out_deg;}
 
-        // Traversal Specific
-        COLOR getColor() const {return color;}
-        void setColor(COLOR color) {this->color = color;}
-
-        Node* getParent() const {return parent;}
-        void setParent(Node& node) {this->parent = &node;}
-
-        Node* getSource() const {return source;}
-        void setSource(Node& node) {this->source = &node;}
-
-        // BFS specific
-        int getDist2Source() const {return dist2s;}
-        void setDist2Source(int dist) {this->dist2s = dist;}
-
-        // DFS Specific
-        int getEntryTime() const { return entry_index;}
-        void setEntryTime(int entry_idx) { entry_index = entry_idx;}
-
-        int getExitTime() const { return exit_index;}
-        void setExitTime(int exit_idx) { exit_index = exit_idx;}
-
-        void setInTree(bool in_tree) {this->in_tree = in_tree;}
-        bool isInTree() const {return in_tree;}
-
-        int getComponentId() const {return component_id;}
-        void setComponentId(int component_id) {this->component_id = component_id;}
         friend ostream& operator <<(ostream& os, const Node& node);
         template<class V, class E> friend class GraphBase;
         friend class TestNode;
@@ -148,106 +123,49 @@ template<typename T>
 string Node<T>::DEFAULT_LABEL = "";
 
 template<typename T>
-Node<T>::Node(T& val, string lbl):
+Node<T>::Node(T& val, const string& lbl):
     value(val),
-    label(lbl),
+    label(LabelPool::shared().intern(lbl)),
     id(count++),
     adj_index(-1),
     edge_list(NULL),
+    in_edge_list(NULL),
     out_deg(0),
-    in_deg(0),
-
-    // Traversal Specific
-    color(WHITE),
-    parent(NULL),
-    source(NULL),
-
-    // BFS specific
-    dist2s(-1),
-
-    // DFS specific
-    entry_index(-1),
-    exit_index(-1),
-    component_id(-1),
-
-    // Spanning Tree Related
-    in_tree(false) {}
+    in_deg(0) {}
 
+// Only structure lives in node, so soft reset has nothing to do.
 template<typename T>
 void Node<T>::reset(RESET reset) {
     if (reset == HARD_RESET) {
         edge_list = NULL;
+        in_edge_list = NULL;
         adj_index = -1;
         in_deg = 0;
         out_deg = 0;
     }
-    color = WHITE;
-    parent = NULL;
-    source = NULL;
-
-    // BFS specific
-    dist2s = -1;
-
-    // DFS specific
-    entry_index = -1;
-    exit_index = -1;
-    component_id = -1;
-
-    // Spanning Tree Related
-    bool in_tree = false;
 }
 
 template<typename T>
 Node<T>::Node(T& val):
     value(val),
-    label(DEFAULT_LABEL),
+    label(LabelPool::DEFAULT),
     edge_list(NULL),
+    in_edge_list(NULL),
     adj_index(-1),
     id(count++),
     in_deg(0),
-    out_deg(0),
-
-    // Traversal Specific
-    color(WHITE),
-    parent(NULL),
-    source(NULL),
-
-    // BFS specific
-    dist2s(-1),
-
-    // DFS specific
-    entry_index(-1),
-    exit_index(-1),
-    component_id(-1),
-
-    // Spanning Tree Related
-    in_tree(false) {}
+    out_deg(0) {}
 
 template<typename T>
 Node<T>::Node(const Node<T>& node):
     value(node.getValue()),
-    label(node.getLabel()),
+    label(LabelPool::shared().retain(node.getLabelHandle())),
     id(node.getId()),
     edge_list(node.getEdgeList()),
+    in_edge_list(node.getInEdgeList()),
     adj_index(node.getAdjecencyIndex()),
     in_deg(node.getInDegree()),
-    out_deg(node.getOutDegree()),
-
-    // Traversal Specific
-    color(node.getColor()),
-    parent(node.getParent()),
-    source(node.getSource()),
-
-    // BFS specific
-    dist2s(node.getDist2Source()),
-
-    // DFS specific
-    entry_index(node.getEntryTime()),
-    exit_index(node.getExitTime()),
-    component_id(node.getComponentId()),
-
-    // Spanning Tree Related
-    in_tree(node.isInTree()) {}
+    out_deg(node.getOutDegree()) {}
 
 
 // nodes are equal if either they are same or have same label.
@@ -259,10 +177,8 @@ bool Node<T>::operator==(const Node<T>& node2) {
             id == node2.getId() ||
             // else value should match and
             (getValue() == node2.getValue() &&
-            // and label too if not default
-             ((getLabel() == DEFAULT_LABEL &&
-              node2.getLabel() == DEFAULT_LABEL) ||
-             getLabel() == node2.getLabel())));
+            // and label, handles are equal iff labels are
+             label == node2.getLabelHandle()));
 }
 
 template<typename T>
@@ -273,28 +189,16 @@ bool Node<T>::operator!=(const Node<T>& node2) {
 template<typename T>
 Node<T>& Node<T>::operator =(const Node<T>& node) {
     value = node.getValue();
-    label = node.getLabel();
+    // Retained first, node may be this.
+    LabelPool::Handle old = label;
+    label = LabelPool::shared().retain(node.getLabelHandle());
+    LabelPool::shared().release(old);
     id = node.getId();
     edge_list = node.getEdgeList();
+    in_edge_list = node.getInEdgeList();
     adj_index = node.getAdjecencyIndex();
     in_deg = node.getInDegree();
     out_deg = node.getOutDegree();
-
-    // Traversal Specific
-    color = node.getColor();
-    parent = node.getParent();
-    source = node.getSource();
-
-    // BFS specific
-    dist2s = node.getDist2Source();
-
-    // DFS specific
-    entry_index = node.getEntryTime();
-    exit_index = node.getExitTime();
-    component_id = node.getComponentId();
-
-    // Spanning Tree Related
-    in_tree = node.isInTree();
     return *this;
 }
 template<typename T>
@@ -323,6 +227,6 @@ void Node<T>::populateNode(int graph_size) {
 
 template<typename T>
 ostream& operator <<(ostream& os, const Node<T>& node) {
-    os << node.label;
+    os << node.getLabel();
 }
 #endif
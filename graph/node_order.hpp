@@ -0,0 +1,245 @@
+#include<vector>
+#include<algorithm>
+#include<math.h>
+#ifndef __NODE_ORDER__
+#define __NODE_ORDER__
+using namespace std;
+
+/*
+ * Node orderings that place nodes used together close to each other.
+ *
+ * Every function takes the graph as symmetric CSR (neighbours of i are
+ * targets[offsets[i]] .. targets[offsets[i + 1] - 1]) and fills order
+ * so that new position p holds old index order[p], the form
+ * GraphBase::permuteNodes takes. Ties keep the old order.
+ */
+class NodeOrder {
+    public:
+        // Reverse Cuthill-McKee: BFS from a low degree peripheral node of
+        // every component, neighbours by increasing degree, reversed.
+        // Keeps the ends of every edge close, small bandwidth.
+        static void reverseCuthillMcKee(const vector<int>& offsets, const vector<int>& targets, vector<int>& order);
+        // Highest degree first.
+        static void degree(const vector<int>& offsets, const vector<int>& targets, vector<int>& order);
+        // Nodes of above average degree first, everything else after,
+        // each group in the old order. Packs the hot nodes together
+        // without disturbing any locality the input already has.
+        static void hubCluster(const vector<int>& offsets, const vector<int>& targets, vector<int>& order);
+        // Gorder: greedily appends the node sharing most neighbours with,
+        // or adjacent to, the last window nodes placed.
+        static void gorder(const vector<int>& offsets, const vector<int>& targets, vector<int>& order, int window = 5);
+
+    private:
+        // Max priority queue over node ids with keys changed by one at a
+        // time, O(1) per change (unit heap from the Gorder paper).
+        class UnitHeap;
+
+        // BFS from root marking level of every node reached, returns the
+        // last node of the deepest level with smallest degree.
+        static int farthest(const vector<int>& offsets, const vector<int>& targets, int root,
+                            vector<int>& level, vector<int>& queue, int& depth);
+};
+
+class NodeOrder::UnitHeap {
+    public:
+        UnitHeap(int n) : key(n, 0), prev(n), next(n), head(1, -1), top(0) {
+            for (int i = 0; i < n; i++)
+                link(i);
+        }
+
+        int getKey(int node) const { return key[node];}
+        void increment(int node) { unlink(node); key[node]++; link(node);}
+        void decrement(int node) { unlink(node); key[node]--; link(node);}
+        void remove(int node) { unlink(node); key[node] = -1;}
+        bool contains(int node) const { return key[node] >= 0;}
+
+        int extractMax() {
+            while (top >= 0 && head[top] == -1)
+                top--;
+            int node = head[top];
+            remove(node);
+            while (top >= 0 && head[top] == -1)
+                top--;
+            return node;
+        }
+
+    private:
+        vector<int> key;
+        vector<int> prev;
+        vector<int> next;
+        // First node of each key, -1 if none.
+        vector<int> head;
+        int top;
+
+        void link(int node) {
+            int k = key[node];
+            if (k >= (int)head.size())
+                head.resize(k + 1, -1);
+            prev[node] = -1;
+            next[node] = head[k];
+            if (head[k] != -1)
+                prev[head[k]] = node;
+            head[k] = node;
+            top = max(top, k);
+        }
+
+        void unlink(int node) {
+            int k = key[node];
+            if (prev[node] != -1)
+                next[prev[node]] = next[node];
+            else
+                head[k] = next[node];
+            if (next[node] != -1)
+                prev[next[node]] = prev[node];
+        }
+};
+
+inline int NodeOrder::farthest(const vector<int>& offsets, const vector<int>& targets, int root,
+                               vector<int>& level, vector<int>& queue, int& depth) {
+    queue.clear();
+    queue.push_back(root);
+    level[root] = 0;
+    for (size_t head = 0; head < queue.size(); head++) {
+        int u = queue[head];
+        for (int pos = offsets[u]; pos < offsets[u + 1]; pos++) {
+            if (level[targets[pos]] == -1) {
+                level[targets[pos]] = level[u] + 1;
+                queue.push_back(targets[pos]);
+            }
+        }
+    }
+    depth = level[queue.back()];
+    int best = queue.back();
+    for (size_t i = queue.size(); i-- > 0 && level[queue[i]] == depth; )
+        if (offsets[queue[i] + 1] - offsets[queue[i]] < offsets[best + 1] - offsets[best])
+            best = queue[i];
+    // Leave level clean for the next search.
+    for (size_t i = 0; i < queue.size(); i++)
+        level[queue[i]] = -1;
+    return best;
+}
+
+inline void NodeOrder::reverseCuthillMcKee(const vector<int>& offsets, const vector<int>& targets, vector<int>& order) {
+    int n = offsets.size() - 1;
+    order.clear();
+    order.reserve(n);
+    vector<char> placed(n, 0);
+    vector<int> level(n, -1), queue;
+    vector< pair<int, int> > neighbours;
+    for (int start = 0; start < n; start++) {
+        if (placed[start])
+            continue;
+        // Pseudo peripheral root: hop to the far end while that
+        // increases the eccentricity.
+        int root = start, depth = 0, far_depth = 0;
+        int far = farthest(offsets, targets, root, level, queue, depth);
+        for (int i = 0; i < 8; i++) {
+            int next = farthest(offsets, targets, far, level, queue, far_depth);
+            if (far_depth <= depth)
+                break;
+            root = far;
+            depth = far_depth;
+            far = next;
+        }
+
+        size_t first = order.size();
+        placed[root] = 1;
+        order.push_back(root);
+        for (size_t head = first; head < order.size(); head++) {
+            int u = order[head];
+            neighbours.clear();
+            for (int pos = offsets[u]; pos < offsets[u + 1]; pos++) {
+                int v = targets[pos];
+                if (!placed[v]) {
+                    placed[v] = 1;
+                    neighbours.push_back(pair<int, int>(offsets[v + 1] - offsets[v], v));
+                }
+            }
+            sort(neighbours.begin(), neighbours.end());
+            for (size_t i = 0; i < neighbours.size(); i++)
+                order.push_back(neighbours[i].second);
+        }
+    }
+    reverse(order.begin(), order.end());
+}
+
+inline void NodeOrder::degree(const vector<int>& offsets, const vector<int>&, vector<int>& order) {
+    int n = offsets.size() - 1;
+    int max_degree = 0;
+    for (int i = 0; i < n; i++)
+        max_degree = max(max_degree, offsets[i + 1] - offsets[i]);
+    // Counting sort, stable.
+    vector<int> start(max_degree + 2, 0);
+    for (int i = 0; i < n; i++)
+        start[max_degree - (offsets[i + 1] - offsets[i]) + 1]++;
+    for (int d = 0; d <= max_degree; d++)
+        start[d + 1] += start[d];
+    order.resize(n);
+    for (int i = 0; i < n; i++)
+        order[start[max_degree - (offsets[i + 1] - offsets[i])]++] = i;
+}
+
+inline void NodeOrder::hubCluster(const vector<int>& offsets, const vector<int>&, vector<int>& order) {
+    int n = offsets.size() - 1;
+    order.clear();
+    order.reserve(n);
+    // deg > average, as deg * n > total
+    long long total = offsets[n];
+    for (int i = 0; i < n; i++)
+        if ((long long)(offsets[i + 1] - offsets[i]) * n > total)
+            order.push_back(i);
+    for (int i = 0; i < n; i++)
+        if ((long long)(offsets[i + 1] - offsets[i]) * n <= total)
+            order.push_back(i);
+}
+
+// Placing v raises the key of its neighbours (adjacency score) and of
+// its neighbours' neighbours (shared neighbour score); v leaving the
+// window lowers them again. Nodes of degree above sqrt(n) are not
+// expanded for the shared neighbour score, as in the paper, or a hub
+// would touch most of the graph every step.
+inline void NodeOrder::gorder(const vector<int>& offsets, const vector<int>& targets, vector<int>& order, int window) {
+    int n = offsets.size() - 1;
+    order.clear();
+    if (n == 0)
+        return;
+    order.reserve(n);
+    int hub = max(1, (int)sqrt((double)n));
+    UnitHeap heap(n);
+
+    int first = 0;
+    for (int i = 1; i < n; i++)
+        if (offsets[i + 1] - offsets[i] > offsets[first + 1] - offsets[first])
+            first = i;
+    heap.remove(first);
+    order.push_back(first);
+
+    for (int placed = 1; placed < n; placed++) {
+        int enter = order.back();
+        int leave = placed > window ? order[placed - window - 1] : -1;
+        for (int pos = offsets[enter]; pos < offsets[enter + 1]; pos++) {
+            int u = targets[pos];
+            if (heap.contains(u))
+                heap.increment(u);
+            if (offsets[u + 1] - offsets[u] > hub)
+                continue;
+            for (int pos2 = offsets[u]; pos2 < offsets[u + 1]; pos2++)
+                if (heap.contains(targets[pos2]))
+                    heap.increment(targets[pos2]);
+        }
+        if (leave != -1) {
+            for (int pos = offsets[leave]; pos < offsets[leave + 1]; pos++) {
+                int u = targets[pos];
+                if (heap.contains(u))
+                    heap.decrement(u);
+                if (offsets[u + 1] - offsets[u] > hub)
+                    continue;
+                for (int pos2 = offsets[u]; pos2 < offsets[u + 1]; pos2++)
+                    if (heap.contains(targets[pos2]))
+                        heap.decrement(targets[pos2]);
+            }
+        }
+        order.push_back(heap.extractMax());
+    }
+}
+#endif
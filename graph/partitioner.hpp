@@ -0,0 +1,527 @@
+#include<vector>
+#include<queue>
+#include<random>
+#include<algorithm>
+#include "graph.hpp"
+#ifndef __PARTITIONER__
+#define __PARTITIONER__
+using namespace std;
+
+/*
+ * Splits the nodes of a graph into a fixed number of parts of about
+ * equal size with few edges between them.
+ *
+ * MULTILEVEL coarsens the graph by heavy edge matching, partitions the
+ * coarsest graph by growing parts along BFS order, then projects the
+ * partition back level by level, refining each with Fiduccia-Mattheyses
+ * moves. LABEL_PROPAGATION skips coarsening: nodes repeatedly join the
+ * part most of their neighbours are in, which is a few linear passes and
+ * gives a worse cut.
+ *
+ * Edge direction and weight are ignored, the cut is the number of graph
+ * edges whose ends are in different parts. A part holds at most
+ * (1 + imbalance) * ceil(V / parts) nodes unless that is impossible.
+ */
+class Partitioner {
+    public:
+        enum METHOD {MULTILEVEL, LABEL_PROPAGATION};
+
+        // imbalance 0.03 allows parts 3% above the average.
+        Partitioner(int nParts, float imbalance) :
+            nParts(max(nParts, 1)), imbalance(max(imbalance, 0.0f)), seed(1) {}
+
+        int getPartCount() const { return nParts;}
+        float getImbalance() const { return imbalance;}
+        // Same seed and graph give the same partition.
+        void setSeed(unsigned seed) { this->seed = seed;}
+
+        // Fills parts with the part of every node, by iteration index,
+        // and returns the edge cut.
+        template<class V, class E>
+        int partition(const GraphBase<V,E>& graph, vector<int>& parts, METHOD method = MULTILEVEL) const;
+
+    private:
+        // Undirected graph in CSR form with node and edge weights. Nodes
+        // of a coarse graph stand for several nodes, edges for several
+        // edges.
+        struct WeightedGraph {
+            vector<int> offsets;
+            vector<int> targets;
+            vector<int> weights;
+            vector<int> node_weights;
+            int total_weight;
+
+            WeightedGraph() : offsets(1, 0), total_weight(0) {}
+            int size() const { return node_weights.size();}
+        };
+
+        struct Move {
+            int gain;
+            int node;
+            int to;
+            int stamp;
+            Move() : gain(0), node(-1), to(-1), stamp(0) {}
+            Move(int gain, int node, int to) : gain(gain), node(node), to(to), stamp(0) {}
+            bool operator <(const Move& move) const { return gain < move.gain;}
+        };
+
+        // Coarsening stops at this many nodes per part.
+        static const int COARSEST_PER_PART = 20;
+        static const int INITIAL_TRIES = 4;
+        static const int MAX_PASSES = 8;
+        // FM gives up after this many moves without a better cut.
+        static const int STALL_MOVES = 64;
+        static const int LABEL_ROUNDS = 10;
+
+        int nParts;
+        float imbalance;
+        unsigned seed;
+
+        int maxPartWeight(int total) const;
+        // Coarse nodes are heavier than the allowed imbalance, so coarse
+        // levels may exceed it by one node and are balanced at the end.
+        int coarseLimit(const WeightedGraph& graph) const;
+        int multilevel(const WeightedGraph& graph, vector<int>& parts, mt19937& rng) const;
+        int labelPropagation(const WeightedGraph& graph, vector<int>& parts, mt19937& rng) const;
+        // False when matching no longer shrinks the graph.
+        bool coarsen(const WeightedGraph& graph, WeightedGraph& coarse, vector<int>& cmap, mt19937& rng) const;
+        void growParts(const WeightedGraph& graph, vector<int>& parts, mt19937& rng) const;
+        int refine(const WeightedGraph& graph, vector<int>& parts, int max_weight) const;
+        // Moves nodes out of parts heavier than max_weight.
+        void rebalance(const WeightedGraph& graph, vector<int>& parts, int max_weight) const;
+        bool bestMove(const WeightedGraph& graph, const vector<int>& parts, const vector<int>& part_weights,
+                      int max_weight, int node, vector<int>& conn, Move& move) const;
+        static int cut(const WeightedGraph& graph, const vector<int>& parts);
+        // Sums weights of repeated targets in each list, drops self loops.
+        static void mergeEdges(WeightedGraph& graph);
+};
+
+template<class V, class E>
+int Partitioner::partition(const GraphBase<V,E>& graph, vector<int>& parts, METHOD method) const {
+    int n = graph.getNodeCount();
+    WeightedGraph g;
+    g.node_weights.assign(n, 1);
+    g.total_weight = n;
+    g.offsets.assign(n + 1, 0);
+    for (int i = 0; i < n; i++) {
+        g.offsets[i + 1] += graph.getOutDegreeAt(i);
+        if (graph.isDirected()) {
+            EdgeRange<const E> range = graph.neighborsAt(i);
+            for (typename EdgeRange<const E>::iterator it = range.begin(); it != range.end(); ++it)
+                g.offsets[it.otherIndex() + 1]++;
+        }
+    }
+    for (int i = 0; i < n; i++)
+        g.offsets[i + 1] += g.offsets[i];
+    g.targets.resize(g.offsets[n]);
+    g.weights.assign(g.offsets[n], 1);
+    vector<int> cursor(g.offsets.begin(), g.offsets.end() - 1);
+    for (int i = 0; i < n; i++) {
+        EdgeRange<const E> range = graph.neighborsAt(i);
+        for (typename EdgeRange<const E>::iterator it = range.begin(); it != range.end(); ++it) {
+            g.targets[cursor[i]++] = it.otherIndex();
+            // Undirected edges already appear from both ends.
+            if (graph.isDirected())
+                g.targets[cursor[it.otherIndex()]++] = i;
+        }
+    }
+    mergeEdges(g);
+
+    mt19937 rng(seed);
+    parts.assign(n, 0);
+    if (nParts == 1 || n == 0)
+        return 0;
+    if (method == LABEL_PROPAGATION)
+        return labelPropagation(g, parts, rng);
+    return multilevel(g, parts, rng);
+}
+
+inline int Partitioner::maxPartWeight(int total) const {
+    int average = (total + nParts - 1) / nParts;
+    return max(average, (int)((1.0 + imbalance) * average));
+}
+
+inline int Partitioner::coarseLimit(const WeightedGraph& graph) const {
+    int heaviest = 0;
+    for (int i = 0; i < graph.size(); i++)
+        heaviest = max(heaviest, graph.node_weights[i]);
+    return maxPartWeight(graph.total_weight) + heaviest;
+}
+
+inline void Partitioner::mergeEdges(WeightedGraph& graph) {
+    int n = graph.size();
+    vector<int> slot(n, -1);
+    int out = 0;
+    int start = 0;
+    for (int i = 0; i < n; i++) {
+        int first = out;
+        for (int pos = start; pos < graph.offsets[i + 1]; pos++) {
+            int other = graph.targets[pos];
+            if (other == i)
+                continue;
+            if (slot[other] >= first) {
+                graph.weights[slot[other]] += graph.weights[pos];
+            } else {
+                slot[other] = out;
+                graph.targets[out] = other;
+                graph.weights[out++] = graph.weights[pos];
+            }
+        }
+        start = graph.offsets[i + 1];
+        graph.offsets[i + 1] = out;
+    }
+    graph.targets.resize(out);
+    graph.weights.resize(out);
+}
+
+inline int Partitioner::cut(const WeightedGraph& graph, const vector<int>& parts) {
+    int sum = 0;
+    for (int i = 0; i < graph.size(); i++)
+        for (int pos = graph.offsets[i]; pos < graph.offsets[i + 1]; pos++)
+            if (parts[i] != parts[graph.targets[pos]])
+                sum += graph.weights[pos];
+    return sum / 2;
+}
+
+// Partition the coarsest graph a few times, keep the best, then project
+// back and refine on every level.
+inline int Partitioner::multilevel(const WeightedGraph& graph, vector<int>& parts, mt19937& rng) const {
+    vector<WeightedGraph> levels(1, graph);
+    vector< vector<int> > cmaps;
+    while (levels.back().size() > COARSEST_PER_PART * nParts) {
+        WeightedGraph coarse;
+        vector<int> cmap;
+        if (!coarsen(levels.back(), coarse, cmap, rng))
+            break;
+        levels.push_back(coarse);
+        cmaps.push_back(cmap);
+    }
+
+    const WeightedGraph& coarsest = levels.back();
+    vector<int> best, tried;
+    int best_cut = -1;
+    for (int i = 0; i < INITIAL_TRIES; i++) {
+        growParts(coarsest, tried, rng);
+        int tried_cut = refine(coarsest, tried, coarseLimit(coarsest));
+        if (best_cut == -1 || tried_cut < best_cut) {
+            best_cut = tried_cut;
+            best.swap(tried);
+        }
+    }
+
+    for (int level = levels.size() - 2; level >= 0; level--) {
+        const vector<int>& cmap = cmaps[level];
+        vector<int> fine(levels[level].size());
+        for (size_t i = 0; i < fine.size(); i++)
+            fine[i] = best[cmap[i]];
+        best.swap(fine);
+        if (level == 0) {
+            rebalance(levels[level], best, maxPartWeight(graph.total_weight));
+            best_cut = refine(levels[level], best, maxPartWeight(graph.total_weight));
+        } else {
+            best_cut = refine(levels[level], best, coarseLimit(levels[level]));
+        }
+    }
+    if (levels.size() == 1) {
+        rebalance(graph, best, maxPartWeight(graph.total_weight));
+        best_cut = refine(graph, best, maxPartWeight(graph.total_weight));
+    }
+    parts.swap(best);
+    return best_cut;
+}
+
+// Nodes visited in random order are matched with the unmatched
+// neighbour they share the heaviest edge with. Matched pairs become one
+// coarse node, capped in weight so the coarsest graph can still be
+// balanced.
+inline bool Partitioner::coarsen(const WeightedGraph& graph, WeightedGraph& coarse, vector<int>& cmap, mt19937& rng) const {
+    int n = graph.size();
+    int max_node_weight = max(1, (int)(1.5 * graph.total_weight / (COARSEST_PER_PART * nParts)));
+    vector<int> order(n);
+    for (int i = 0; i < n; i++)
+        order[i] = i;
+    shuffle(order.begin(), order.end(), rng);
+
+    vector<int> match(n, -1);
+    for (int k = 0; k < n; k++) {
+        int u = order[k];
+        if (match[u] != -1)
+            continue;
+        int best = u, best_weight = 0;
+        for (int pos = graph.offsets[u]; pos < graph.offsets[u + 1]; pos++) {
+            int v = graph.targets[pos];
+            if (match[v] == -1 && graph.weights[pos] > best_weight &&
+                graph.node_weights[u] + graph.node_weights[v] <= max_node_weight) {
+                best = v;
+                best_weight = graph.weights[pos];
+            }
+        }
+        match[u] = best;
+        match[best] = u;
+    }
+
+    cmap.assign(n, -1);
+    int count = 0;
+    for (int u = 0; u < n; u++) {
+        if (cmap[u] == -1) {
+            cmap[u] = cmap[match[u]] = count++;
+        }
+    }
+    // Not worth another level.
+    if (count > 0.95 * n)
+        return false;
+
+    coarse.node_weights.assign(count, 0);
+    coarse.total_weight = graph.total_weight;
+    coarse.offsets.assign(count + 1, 0);
+    for (int u = 0; u < n; u++) {
+        coarse.node_weights[cmap[u]] += graph.node_weights[u];
+        coarse.offsets[cmap[u] + 1] += graph.offsets[u + 1] - graph.offsets[u];
+    }
+    for (int c = 0; c < count; c++)
+        coarse.offsets[c + 1] += coarse.offsets[c];
+    coarse.targets.resize(coarse.offsets[count]);
+    coarse.weights.resize(coarse.offsets[count]);
+    vector<int> cursor(coarse.offsets.begin(), coarse.offsets.end() - 1);
+    for (int u = 0; u < n; u++) {
+        int c = cmap[u];
+        for (int pos = graph.offsets[u]; pos < graph.offsets[u + 1]; pos++) {
+            coarse.targets[cursor[c]] = cmap[graph.targets[pos]];
+            coarse.weights[cursor[c]++] = graph.weights[pos];
+        }
+    }
+    mergeEdges(coarse);
+    return true;
+}
+
+// Walks the graph in BFS order from a random root, continuing from a
+// random unvisited node when a component runs out, and cuts the order
+// into consecutive runs of equal weight.
+inline void Partitioner::growParts(const WeightedGraph& graph, vector<int>& parts, mt19937& rng) const {
+    int n = graph.size();
+    vector<int> roots(n);
+    for (int i = 0; i < n; i++)
+        roots[i] = i;
+    shuffle(roots.begin(), roots.end(), rng);
+
+    parts.assign(n, -1);
+    vector<char> seen(n, 0);
+    vector<int> q;
+    q.reserve(n);
+    long long before = 0;
+    for (int r = 0; r < n; r++) {
+        if (seen[roots[r]])
+            continue;
+        seen[roots[r]] = 1;
+        q.push_back(roots[r]);
+        for (size_t head = q.size() - 1; head < q.size(); head++) {
+            int u = q[head];
+            // Part by weight of the node's middle along the order.
+            parts[u] = min(nParts - 1, (int)((2 * before + graph.node_weights[u]) * nParts / (2LL * graph.total_weight)));
+            before += graph.node_weights[u];
+            for (int pos = graph.offsets[u]; pos < graph.offsets[u + 1]; pos++) {
+                int v = graph.targets[pos];
+                if (!seen[v]) {
+                    seen[v] = 1;
+                    q.push_back(v);
+                }
+            }
+        }
+    }
+}
+
+// Move of node to the part it has most edges into, among parts with
+// room for it. Gain is the drop in cut, may be negative.
+inline bool Partitioner::bestMove(const WeightedGraph& graph, const vector<int>& parts, const vector<int>& part_weights,
+                                  int max_weight, int node, vector<int>& conn, Move& move) const {
+    int from = parts[node];
+    int internal = 0;
+    move = Move();
+    for (int pos = graph.offsets[node]; pos < graph.offsets[node + 1]; pos++) {
+        int p = parts[graph.targets[pos]];
+        if (p == from)
+            internal += graph.weights[pos];
+        else
+            conn[p] += graph.weights[pos];
+    }
+    for (int pos = graph.offsets[node]; pos < graph.offsets[node + 1]; pos++) {
+        int p = parts[graph.targets[pos]];
+        if (p == from || conn[p] == 0)
+            continue;
+        if (part_weights[p] + graph.node_weights[node] <= max_weight &&
+            (move.to == -1 || conn[p] - internal > move.gain ||
+             (conn[p] - internal == move.gain && part_weights[p] < part_weights[move.to])))
+            move = Move(conn[p] - internal, node, p);
+    }
+    for (int pos = graph.offsets[node]; pos < graph.offsets[node + 1]; pos++)
+        conn[parts[graph.targets[pos]]] = 0;
+    return move.to != -1;
+}
+
+// k-way FM: boundary moves are taken best gain first from a heap,
+// each node moves at most once per pass, and the pass is rolled back to
+// the lowest cut seen.
+//
+// Recomputing the gain of every neighbour after a move costs degree
+// squared, which dominates on dense coarse graphs. Instead a neighbour's
+// entry is raised to an upper bound (a move of weight w changes a gain
+// by at most 2w) and the exact gain is only computed when the entry
+// reaches the top. Each node's newest entry carries a stamp, older ones
+// are dropped when popped.
+inline int Partitioner::refine(const WeightedGraph& graph, vector<int>& parts, int max_weight) const {
+    int n = graph.size();
+    vector<int> part_weights(nParts, 0);
+    for (int i = 0; i < n; i++)
+        part_weights[parts[i]] += graph.node_weights[i];
+
+    vector<int> conn(nParts, 0);
+    vector<char> locked(n);
+    // Gain of the newest entry, 0 stamp when a node has none.
+    vector<int> keys(n), stamps(n);
+    vector< pair<int, int> > moves;
+    for (int pass = 0; pass < MAX_PASSES; pass++) {
+        priority_queue<Move> heap;
+        Move move;
+        locked.assign(n, 0);
+        stamps.assign(n, 0);
+        for (int i = 0; i < n; i++) {
+            if (bestMove(graph, parts, part_weights, max_weight, i, conn, move)) {
+                move.stamp = stamps[i] = 1;
+                keys[i] = move.gain;
+                heap.push(move);
+            }
+        }
+
+        moves.clear();
+        int gained = 0, best_gain = 0;
+        size_t best_moves = 0;
+        while (!heap.empty() && moves.size() - best_moves < STALL_MOVES) {
+            Move top = heap.top();
+            heap.pop();
+            int u = top.node;
+            if (locked[u] || top.stamp != stamps[u])
+                continue;
+            if (!bestMove(graph, parts, part_weights, max_weight, u, conn, move)) {
+                stamps[u] = 0;
+                continue;
+            }
+            if (move.gain < top.gain) {
+                move.stamp = ++stamps[u];
+                keys[u] = move.gain;
+                heap.push(move);
+                continue;
+            }
+
+            int from = parts[u];
+            moves.push_back(pair<int, int>(u, from));
+            part_weights[from] -= graph.node_weights[u];
+            part_weights[move.to] += graph.node_weights[u];
+            parts[u] = move.to;
+            locked[u] = 1;
+            gained += move.gain;
+            if (gained > best_gain) {
+                best_gain = gained;
+                best_moves = moves.size();
+            }
+            for (int pos = graph.offsets[u]; pos < graph.offsets[u + 1]; pos++) {
+                int v = graph.targets[pos];
+                // Gains in the target part only dropped.
+                if (locked[v] || parts[v] == move.to)
+                    continue;
+                Move bound(keys[v] + 2 * graph.weights[pos], v, move.to);
+                if (stamps[v] == 0 && !bestMove(graph, parts, part_weights, max_weight, v, conn, bound))
+                    continue;
+                bound.stamp = ++stamps[v];
+                keys[v] = bound.gain;
+                heap.push(bound);
+            }
+        }
+
+        while (moves.size() > best_moves) {
+            int u = moves.back().first;
+            part_weights[parts[u]] -= graph.node_weights[u];
+            part_weights[moves.back().second] += graph.node_weights[u];
+            parts[u] = moves.back().second;
+            moves.pop_back();
+        }
+        if (best_gain == 0)
+            break;
+    }
+    return cut(graph, parts);
+}
+
+// Best gain moves out of overweight parts into neighbouring parts with
+// room, then, if a part has no such boundary node left, any of its nodes
+// into the lightest part.
+inline void Partitioner::rebalance(const WeightedGraph& graph, vector<int>& parts, int max_weight) const {
+    int n = graph.size();
+    vector<int> part_weights(nParts, 0);
+    for (int i = 0; i < n; i++)
+        part_weights[parts[i]] += graph.node_weights[i];
+
+    vector<int> conn(nParts, 0);
+    priority_queue<Move> heap;
+    Move move;
+    for (int i = 0; i < n; i++)
+        if (part_weights[parts[i]] > max_weight && bestMove(graph, parts, part_weights, max_weight, i, conn, move))
+            heap.push(move);
+    while (!heap.empty()) {
+        Move top = heap.top();
+        heap.pop();
+        if (part_weights[parts[top.node]] <= max_weight ||
+            !bestMove(graph, parts, part_weights, max_weight, top.node, conn, move))
+            continue;
+        if (move.gain != top.gain || move.to != top.to) {
+            heap.push(move);
+            continue;
+        }
+        part_weights[parts[move.node]] -= graph.node_weights[move.node];
+        part_weights[move.to] += graph.node_weights[move.node];
+        parts[move.node] = move.to;
+    }
+
+    for (int i = 0; i < n; i++) {
+        if (part_weights[parts[i]] <= max_weight)
+            continue;
+        int lightest = min_element(part_weights.begin(), part_weights.end()) - part_weights.begin();
+        if (part_weights[lightest] + graph.node_weights[i] > max_weight)
+            continue;
+        part_weights[parts[i]] -= graph.node_weights[i];
+        part_weights[lightest] += graph.node_weights[i];
+        parts[i] = lightest;
+    }
+}
+
+// Size constrained label propagation, starting from BFS runs. A node
+// only moves for a strictly better connection, so rounds converge.
+inline int Partitioner::labelPropagation(const WeightedGraph& graph, vector<int>& parts, mt19937& rng) const {
+    int n = graph.size();
+    int max_weight = maxPartWeight(graph.total_weight);
+    growParts(graph, parts, rng);
+    vector<int> part_weights(nParts, 0);
+    for (int i = 0; i < n; i++)
+        part_weights[parts[i]] += graph.node_weights[i];
+
+    vector<int> order(n);
+    for (int i = 0; i < n; i++)
+        order[i] = i;
+    vector<int> conn(nParts, 0);
+    Move move;
+    for (int round = 0; round < LABEL_ROUNDS; round++) {
+        shuffle(order.begin(), order.end(), rng);
+        int moved = 0;
+        for (int k = 0; k < n; k++) {
+            int u = order[k];
+            if (!bestMove(graph, parts, part_weights, max_weight, u, conn, move) || move.gain <= 0)
+                continue;
+            part_weights[parts[u]] -= graph.node_weights[u];
+            part_weights[move.to] += graph.node_weights[u];
+            parts[u] = move.to;
+            moved++;
+        }
+        if (moved == 0)
+            break;
+    }
+    return cut(graph, parts);
+}
+#endif
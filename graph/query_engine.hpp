@@ -0,0 +1,231 @@
+#include<vector>
+#include<deque>
+#include<thread>
+#include<mutex>
+#include<condition_variable>
+#include<future>
+#include<functional>
+#include<memory>
+#include<utility>
+#include "graph.hpp"
+#ifndef __QUERY_ENGINE__
+#define __QUERY_ENGINE__
+using namespace std;
+
+/*
+ * Runs read only queries against one graph on a pool of worker threads.
+ *
+ * The engine only uses the const traversals of GraphBase, so queries do
+ * not need a lock around the graph. Every worker owns a workspace that is
+ * reused by all queries it runs, a query allocates nothing once the
+ * workspaces have grown to the graph size.
+ *
+ * Queries name nodes by id. Results come back as futures, a query on an
+ * id not in graph resolves to -1, false or an empty vector.
+ *
+ * The graph must not be modified while the engine is alive.
+ */
+template<class V, class E=Edge>
+class QueryEngine {
+    public:
+        typedef GraphBase<V,E> GraphType;
+        typedef typename GraphType::Workspace Workspace;
+
+        QueryEngine(const GraphType& graph);
+        QueryEngine(const GraphType& graph, int nThreads);
+        // Finishes queued queries before returning.
+        ~QueryEngine();
+
+        int getThreadCount() const { return workers.size();}
+
+        // Number of edges on shortest path, -1 if target is not reachable.
+        future<int> distance(int source_id, int target_id);
+        future<bool> reachable(int source_id, int target_id);
+        // BFS level of every node in iteration order, -1 if not reached.
+        future< vector<int> > levels(int source_id);
+
+        // Batch of (source id, target id) distance queries, queued under
+        // a single lock. Futures are in order of queries.
+        vector< future<int> > distances(const vector< pair<int, int> >& queries);
+
+        // Any other read only query. Task is called as
+        // task(graph, workspace) on a worker thread.
+        template<class Task>
+        future<typename result_of<Task(const GraphType&, Workspace&)>::type> submit(Task task);
+
+    private:
+        typedef function<void(Workspace&)> Job;
+
+        // Stops BFS once target is taken off the queue.
+        class TargetVisitor : public GraphVisitor<V,E> {
+            public:
+                int target_id;
+                bool found;
+                TargetVisitor(int target_id) : target_id(target_id), found(false) {}
+                void processOnGrey(const V& node) {
+                    if (node.getId() == target_id)
+                        found = true;
+                }
+                bool finished() const { return found;}
+        };
+
+        static int runDistance(const GraphType& graph, Workspace& ws, int source_id, int target_id);
+        static vector<int> runLevels(const GraphType& graph, Workspace& ws, int source_id);
+
+        void start(int nThreads);
+        void work();
+        template<class R> future<R> enqueue(const function<R(Workspace&)>& task, bool notify);
+
+        const GraphType& graph;
+        vector<thread> workers;
+        deque<Job> jobs;
+        mutex lock;
+        condition_variable available;
+        bool stopping;
+};
+
+template<class V, class E>
+QueryEngine<V,E>::QueryEngine(const GraphType& graph) :
+    graph(graph),
+    stopping(false) {
+    int nThreads = thread::hardware_concurrency();
+    start(nThreads > 0 ? nThreads : 1);
+}
+
+template<class V, class E>
+QueryEngine<V,E>::QueryEngine(const GraphType& graph, int nThreads) :
+    graph(graph),
+    stopping(false) {
+    start(nThreads > 0 ? nThreads : 1);
+}
+
+template<class V, class E>
+void QueryEngine<V,E>::start(int nThreads) {
+    for (int i = 0; i < nThreads; i++)
+        workers.push_back(thread(&QueryEngine::work, this));
+}
+
+template<class V, class E>
+QueryEngine<V,E>::~QueryEngine() {
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    available.notify_all();
+    for (size_t i = 0; i < workers.size(); i++)
+        workers[i].join();
+}
+
+template<class V, class E>
+void QueryEngine<V,E>::work() {
+    Workspace ws;
+    while (true) {
+        Job job;
+        {
+            unique_lock<mutex> guard(lock);
+            while (!stopping && jobs.empty())
+                available.wait(guard);
+            if (jobs.empty())
+                return;
+            job = jobs.front();
+            jobs.pop_front();
+        }
+        job(ws);
+    }
+}
+
+// packaged_task is move only and function needs a copyable target,
+// so the task is shared between the job and nobody else.
+template<class V, class E>
+template<class R>
+future<R> QueryEngine<V,E>::enqueue(const function<R(Workspace&)>& task, bool notify) {
+    shared_ptr< packaged_task<R(Workspace&)> > job(new packaged_task<R(Workspace&)>(task));
+    future<R> result = job->get_future();
+    jobs.push_back([job](Workspace& ws) { (*job)(ws); });
+    if (notify)
+        available.notify_one();
+    return result;
+}
+
+template<class V, class E>
+template<class Task>
+future<typename result_of<Task(const typename QueryEngine<V,E>::GraphType&, typename QueryEngine<V,E>::Workspace&)>::type>
+QueryEngine<V,E>::submit(Task task) {
+    typedef typename result_of<Task(const GraphType&, Workspace&)>::type R;
+    const GraphType& g = graph;
+    lock_guard<mutex> guard(lock);
+    return enqueue(function<R(Workspace&)>([task, &g](Workspace& ws) { return task(g, ws); }), true);
+}
+
+template<class V, class E>
+int QueryEngine<V,E>::runDistance(const GraphType& graph, Workspace& ws, int source_id, int target_id) {
+    int source = graph.indexOf(source_id);
+    int target = graph.indexOf(target_id);
+    if (source == -1 || target == -1)
+        return -1;
+
+    TargetVisitor visitor(target_id);
+    NoTraversalStats stats;
+    graph.breadthFirstVisit(ws, *(graph.cbegin() + source), visitor, stats);
+    return ws.getDist2Source(target);
+}
+
+template<class V, class E>
+vector<int> QueryEngine<V,E>::runLevels(const GraphType& graph, Workspace& ws, int source_id) {
+    vector<int> levels;
+    int source = graph.indexOf(source_id);
+    if (source == -1)
+        return levels;
+
+    graph.breadthFirstSearch(ws, *(graph.cbegin() + source));
+    levels.resize(graph.getNodeCount());
+    for (int i = 0; i < graph.getNodeCount(); i++)
+        levels[i] = ws.getDist2Source(i);
+    return levels;
+}
+
+template<class V, class E>
+future<int> QueryEngine<V,E>::distance(int source_id, int target_id) {
+    const GraphType& g = graph;
+    lock_guard<mutex> guard(lock);
+    return enqueue(function<int(Workspace&)>([&g, source_id, target_id](Workspace& ws) {
+        return runDistance(g, ws, source_id, target_id);
+    }), true);
+}
+
+template<class V, class E>
+future<bool> QueryEngine<V,E>::reachable(int source_id, int target_id) {
+    const GraphType& g = graph;
+    lock_guard<mutex> guard(lock);
+    return enqueue(function<bool(Workspace&)>([&g, source_id, target_id](Workspace& ws) {
+        return runDistance(g, ws, source_id, target_id) >= 0;
+    }), true);
+}
+
+template<class V, class E>
+future< vector<int> > QueryEngine<V,E>::levels(int source_id) {
+    const GraphType& g = graph;
+    lock_guard<mutex> guard(lock);
+    return enqueue(function<vector<int>(Workspace&)>([&g, source_id](Workspace& ws) {
+        return runLevels(g, ws, source_id);
+    }), true);
+}
+
+template<class V, class E>
+vector< future<int> > QueryEngine<V,E>::distances(const vector< pair<int, int> >& queries) {
+    vector< future<int> > results;
+    results.reserve(queries.size());
+    const GraphType& g = graph;
+    {
+        lock_guard<mutex> guard(lock);
+        for (size_t i = 0; i < queries.size(); i++) {
+            int source_id = queries[i].first, target_id = queries[i].second;
+            results.push_back(enqueue(function<int(Workspace&)>([&g, source_id, target_id](Workspace& ws) {
+                return runDistance(g, ws, source_id, target_id);
+            }), false));
+        }
+    }
+    available.notify_all();
+    return results;
+}
+#endif
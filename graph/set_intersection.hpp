@@ -0,0 +1,47 @@
+#ifdef __SSE2__
+#include<emmintrin.h>
+#endif
+#ifndef __SET_INTERSECTION__
+#define __SET_INTERSECTION__
+
+/*
+ * Size of the intersection of two strictly increasing int arrays.
+ *
+ * With SSE2 the arrays are merged 4 by 4: every value of a block of a is
+ * compared against the 4 rotations of a block of b, and the block with
+ * the smaller last value moves on. The rest is a scalar merge.
+ */
+inline int intersectionSize(const int* a, int na, const int* b, int nb) {
+    int count = 0, i = 0, j = 0;
+#ifdef __SSE2__
+    int na4 = na & ~3, nb4 = nb & ~3;
+    while (i < na4 && j < nb4) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + j));
+        __m128i match = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi32(va, vb),
+                         _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1)))),
+            _mm_or_si128(_mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))),
+                         _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3)))));
+        count += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(match)));
+        int a_last = a[i + 3], b_last = b[j + 3];
+        if (a_last <= b_last)
+            i += 4;
+        if (b_last <= a_last)
+            j += 4;
+    }
+#endif
+    while (i < na && j < nb) {
+        if (a[i] < b[j]) {
+            i++;
+        } else if (b[j] < a[i]) {
+            j++;
+        } else {
+            count++;
+            i++;
+            j++;
+        }
+    }
+    return count;
+}
+#endif
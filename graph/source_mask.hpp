@@ -0,0 +1,59 @@
+#include<stdint.h>
+#ifndef __SOURCE_MASK__
+#define __SOURCE_MASK__
+
+/*
+ * Fixed width bitset, one bit per concurrent search of multi source BFS.
+ *
+ * Operations are plain loops over the words so that the compiler can turn
+ * them into vector instructions, 4 words fit one AVX2 register.
+ */
+template<int WORDS>
+struct SourceMask {
+    enum { BITS = 64 * WORDS };
+    uint64_t words[WORDS];
+
+    void clear() {
+        for (int i = 0; i < WORDS; i++)
+            words[i] = 0;
+    }
+
+    void set(int bit) { words[bit >> 6] |= (uint64_t)1 << (bit & 63);}
+
+    bool empty() const {
+        uint64_t any = 0;
+        for (int i = 0; i < WORDS; i++)
+            any |= words[i];
+        return any == 0;
+    }
+
+    void operator |=(const SourceMask& mask) {
+        for (int i = 0; i < WORDS; i++)
+            words[i] |= mask.words[i];
+    }
+
+    // Keep only bits not in mask.
+    void remove(const SourceMask& mask) {
+        for (int i = 0; i < WORDS; i++)
+            words[i] &= ~mask.words[i];
+    }
+
+    // Calls fn(bit) for every set bit in increasing order.
+    template<class F>
+    void forEach(F& fn) const {
+        for (int i = 0; i < WORDS; i++) {
+            uint64_t word = words[i];
+            while (word != 0) {
+                fn(64 * i + __builtin_ctzll(word));
+                word &= word - 1;
+            }
+        }
+    }
+};
+
+#ifdef __AVX2__
+typedef SourceMask<4> DefaultSourceMask;
+#else
+typedef SourceMask<1> DefaultSourceMask;
+#endif
+#endif
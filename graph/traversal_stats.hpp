@@ -0,0 +1,168 @@
+#include<iostream>
+#include<string>
+#include<vector>
+#include<memory>
+#include<chrono>
+#ifndef __TRAVERSAL_STATS__
+#define __TRAVERSAL_STATS__
+using namespace std;
+
+/*
+ * Statistics policies for graph traversals.
+ *
+ * Traversals are templated on a stats policy and call its hooks from the
+ * innermost loops. NoTraversalStats only has empty inline hooks and
+ * std::allocator, so a traversal instantiated with it compiles to the same
+ * code as an uninstrumented one. TraversalStats collects the counters.
+ *
+ * A policy provides
+ *      edgeScanned()           every edge looked at
+ *      idLookup()              every node id to adjacency index lookup
+ *      push() / pop()          queue or stack (recursion) depth
+ *      reachedLevel(level)     a node was discovered at BFS level
+ *      allocated(bytes)        traversal storage grew
+ *      Allocator<T>::type      allocator used for traversal containers
+ *      allocator<T>()          instance of above
+ *      Phase                   scoped wall clock timer for a named phase
+ */
+
+class NoTraversalStats {
+    public:
+        template<class T> struct Allocator { typedef std::allocator<T> type; };
+
+        class Phase {
+            public:
+                Phase(NoTraversalStats&, const char*) {}
+        };
+
+        template<class T> std::allocator<T> allocator() { return std::allocator<T>(); }
+
+        void edgeScanned() {}
+        void idLookup() {}
+        void push() {}
+        void pop() {}
+        void reachedLevel(int) {}
+        void allocated(size_t) {}
+};
+
+class TraversalStats;
+
+// Allocator reporting every allocation to a TraversalStats.
+template<class T>
+class CountingAllocator {
+    public:
+        typedef T value_type;
+        template<class U> struct rebind { typedef CountingAllocator<U> other; };
+
+        CountingAllocator(TraversalStats* stats) : stats(stats) {}
+        template<class U>
+        CountingAllocator(const CountingAllocator<U>& alloc) : stats(alloc.stats) {}
+
+        T* allocate(size_t n);
+        void deallocate(T* ptr, size_t n) { ::operator delete(ptr); }
+
+        template<class U>
+        bool operator ==(const CountingAllocator<U>& alloc) const { return stats == alloc.stats;}
+        template<class U>
+        bool operator !=(const CountingAllocator<U>& alloc) const { return stats != alloc.stats;}
+
+        TraversalStats* stats;
+};
+
+class TraversalStats {
+    public:
+        template<class T> struct Allocator { typedef CountingAllocator<T> type; };
+
+        // Records wall time spent between construction and destruction.
+        class Phase {
+            private:
+                TraversalStats& stats;
+                const char* name;
+                std::chrono::steady_clock::time_point start;
+            public:
+                Phase(TraversalStats& stats, const char* name) :
+                    stats(stats),
+                    name(name),
+                    start(std::chrono::steady_clock::now()) {}
+                ~Phase() {
+                    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                    stats.phases.push_back(pair<string, double>(name, secs));
+                }
+        };
+
+        TraversalStats() { reset(); }
+
+        template<class T> CountingAllocator<T> allocator() { return CountingAllocator<T>(this); }
+
+        void edgeScanned() { edges_scanned++;}
+        void idLookup() { id_lookups++;}
+        void push() {
+            if (++depth > peak_depth)
+                peak_depth = depth;
+        }
+        void pop() { depth--;}
+        void reachedLevel(int level) {
+            if (level >= (int)level_sizes.size())
+                level_sizes.resize(level + 1, 0);
+            level_sizes[level]++;
+        }
+        void allocated(size_t bytes) {
+            allocations++;
+            allocated_bytes += bytes;
+        }
+
+        void reset() {
+            edges_scanned = 0;
+            id_lookups = 0;
+            depth = 0;
+            peak_depth = 0;
+            allocations = 0;
+            allocated_bytes = 0;
+            level_sizes.clear();
+            phases.clear();
+        }
+
+        long getEdgesScanned() const { return edges_scanned;}
+        long getIdLookups() const { return id_lookups;}
+        long getPeakDepth() const { return peak_depth;}
+        long getAllocations() const { return allocations;}
+        long getAllocatedBytes() const { return allocated_bytes;}
+        // Number of nodes discovered on each BFS level, index is the level.
+        const vector<long>& getFrontierSizes() const { return level_sizes;}
+        // (phase name, seconds) in order of completion.
+        const vector< pair<string, double> >& getPhases() const { return phases;}
+
+        void printStats() const;
+
+    private:
+        long edges_scanned;
+        long id_lookups;
+        long depth;
+        long peak_depth;
+        long allocations;
+        long allocated_bytes;
+        vector<long> level_sizes;
+        vector< pair<string, double> > phases;
+};
+
+template<class T>
+T* CountingAllocator<T>::allocate(size_t n) {
+    stats->allocated(n * sizeof(T));
+    return static_cast<T*>(::operator new(n * sizeof(T)));
+}
+
+inline void TraversalStats::printStats() const {
+    cout << "Edges scanned: " << edges_scanned << endl;
+    cout << "Id lookups: " << id_lookups << endl;
+    cout << "Peak queue/stack depth: " << peak_depth << endl;
+    cout << "Allocations: " << allocations << " (" << allocated_bytes << " bytes)" << endl;
+    if (!level_sizes.empty()) {
+        cout << "Frontier sizes:";
+        for (size_t i = 0; i < level_sizes.size(); i++)
+            cout << " " << level_sizes[i];
+        cout << endl;
+    }
+    for (size_t i = 0; i < phases.size(); i++)
+        cout << "Phase " << phases[i].first << ": " << phases[i].second << "s" << endl;
+}
+#endif
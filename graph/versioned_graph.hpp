@@ -0,0 +1,444 @@
+#include<vector>
+#include<atomic>
+#include<mutex>
+#include<memory>
+#include<algorithm>
+#include "graph.hpp"
+#ifndef __VERSIONED_GRAPH__
+#define __VERSIONED_GRAPH__
+using namespace std;
+
+/*
+ * Graph with versioned read only snapshots.
+ *
+ * A writer collects inserts and deletes in a Batch and applies it. The
+ * batch is applied to a private GraphBase under the writer lock, then a
+ * Snapshot of the result is published as the next version with a single
+ * atomic store.
+ *
+ * Snapshots share what a batch did not change. Out edges are kept in
+ * immutable blocks of BLOCK_NODES consecutive nodes and the id to index
+ * map in pages of ID_PAGE ids, both reference counted. A new version
+ * copies the directories of block and page pointers and rebuilds only the
+ * blocks holding a node whose list changed and the pages of ids whose
+ * index changed, so apply costs O(batch + touched blocks and pages) plus
+ * one pointer copy per BLOCK_NODES nodes and per ID_PAGE ids. Removing a
+ * node touches its neighbours and those of the last node, which moves
+ * into its place.
+ *
+ * Readers pin the current version and traverse it without any lock,
+ * writers never wait for readers. A replaced snapshot is freed once no
+ * reader can still hold it, tracked with epochs: a pin announces the
+ * epoch it started in, a snapshot retired in epoch e is freed when every
+ * announced epoch is past e. Pins beyond MAX_READERS do not wait either,
+ * they share one overflow slot holding the epoch of the oldest of them,
+ * so while it stays in use nothing retired after that epoch is freed.
+ */
+template<class V, class E=Edge>
+class VersionedGraph {
+    public:
+        // Pins with a slot of their own, more share the overflow slot.
+        static const int MAX_READERS = 128;
+        static const int BLOCK_NODES = 256;
+        static const int ID_PAGE = 1024;
+
+        class Batch;
+        class Snapshot;
+        class Pin;
+
+        VersionedGraph(bool directed);
+        // No pin may outlive the graph.
+        ~VersionedGraph();
+
+        // Applies batch in order and publishes it. Returns new version.
+        unsigned long apply(const Batch& batch);
+        // Current version, held until the pin is destroyed.
+        Pin pin();
+
+        unsigned long getVersion() const;
+        // Replaced snapshots not freed yet because a reader may hold them.
+        int getRetiredCount() const;
+
+    private:
+        // GraphBase constructors are protected.
+        class Master : public GraphBase<V,E> {
+            public:
+                Master(bool directed) : GraphBase<V,E>(directed) {}
+                // idx and the nodes whose out lists hold an edge to it.
+                void addAdjacent(int idx, vector<int>& touched) const;
+        };
+
+        struct Block {
+            vector<int> ids;
+            vector<int> offsets;
+            vector<int> targets;
+            vector<float> weights;
+            vector<int> edge_ids;
+        };
+
+        struct IdPage {
+            int idx[ID_PAGE];
+            IdPage() { fill(idx, idx + ID_PAGE, -1);}
+        };
+
+        // Overflow slot: pin count above the epoch of its oldest pin.
+        static const int EPOCH_BITS = 40;
+        static const unsigned long EPOCH_MASK = (1UL << EPOCH_BITS) - 1;
+
+        Snapshot* buildNext(const Snapshot& old, vector<int>& touched, vector<int>& moved_ids) const;
+        Block* buildBlock(int b) const;
+        void unpin(int slot);
+        void reclaim();
+
+        Master master;
+        mutable mutex write_lock;
+        atomic<Snapshot*> current;
+        // Version of current, readable without pinning the snapshot.
+        atomic<unsigned long> version;
+        vector<Snapshot*> retired;
+        // Epoch 0 marks a free reader slot.
+        atomic<unsigned long> epoch;
+        atomic<unsigned long> slots[MAX_READERS];
+        atomic<unsigned long> overflow;
+};
+
+template<class V, class E>
+class VersionedGraph<V,E>::Batch {
+    public:
+        void insertNode(V& node) { nodes.push_back(node); ops.push_back(Op(INSERT_NODE, nodes.size() - 1, -1, 0));}
+        void createEdge(int src_id, int dst_id) { createEdge(src_id, dst_id, E::DEFAULT_WEIGHT);}
+        void createEdge(int src_id, int dst_id, float weight) { ops.push_back(Op(CREATE_EDGE, src_id, dst_id, weight));}
+        void removeEdge(int src_id, int dst_id) { ops.push_back(Op(REMOVE_EDGE, src_id, dst_id, 0));}
+        void removeNode(int id) { ops.push_back(Op(REMOVE_NODE, id, -1, 0));}
+        int size() const { return ops.size();}
+
+    private:
+        enum OP {INSERT_NODE, CREATE_EDGE, REMOVE_EDGE, REMOVE_NODE};
+        struct Op {
+            OP type;
+            int first, second;
+            float weight;
+            Op(OP type, int first, int second, float weight) :
+                type(type), first(first), second(second), weight(weight) {}
+        };
+        vector<V> nodes;
+        vector<Op> ops;
+
+        friend class VersionedGraph;
+};
+
+// One version, read like a CSRGraph. Out edges of a node are stored as
+// iteration indices with weights and edge ids alongside.
+template<class V, class E>
+class VersionedGraph<V,E>::Snapshot {
+    public:
+        bool isDirected() const { return directed;}
+        int getNodeCount() const { return node_count;}
+        int getEdgeCount() const { return edge_count;}
+        unsigned long getVersion() const { return version;}
+
+        int getNodeId(int idx) const { return block(idx).ids[idx % BLOCK_NODES];}
+        // Iteration index of node id, -1 if not present.
+        int indexOf(int id) const;
+
+        int getOutDegree(int idx) const { return offset(idx, 1) - offset(idx, 0);}
+        const int* neighborsBegin(int idx) const { return block(idx).targets.data() + offset(idx, 0);}
+        const int* neighborsEnd(int idx) const { return block(idx).targets.data() + offset(idx, 1);}
+        // Weights and edge ids of the out edges of idx, in neighbour order.
+        const float* weightsBegin(int idx) const { return block(idx).weights.data() + offset(idx, 0);}
+        const int* edgeIdsBegin(int idx) const { return block(idx).edge_ids.data() + offset(idx, 0);}
+
+        // Hop count from source index in iteration order, -1 if not reached.
+        void breadthFirstSearch(int source, vector<int>& dist) const;
+
+    private:
+        Snapshot(bool directed, int node_count, int edge_count, unsigned long version) :
+            directed(directed), node_count(node_count), edge_count(edge_count),
+            version(version), retired_epoch(0) {}
+
+        const Block& block(int idx) const { return *blocks[idx / BLOCK_NODES];}
+        int offset(int idx, int next) const { return block(idx).offsets[idx % BLOCK_NODES + next];}
+
+        bool directed;
+        int node_count;
+        int edge_count;
+        unsigned long version;
+        unsigned long retired_epoch;
+        vector< shared_ptr<const Block> > blocks;
+        vector< shared_ptr<const IdPage> > pages;
+
+        friend class VersionedGraph;
+};
+
+template<class V, class E>
+class VersionedGraph<V,E>::Pin {
+    public:
+        Pin(Pin&& pin) : owner(pin.owner), slot(pin.slot), snapshot(pin.snapshot) { pin.owner = NULL;}
+        ~Pin() {
+            if (owner != NULL)
+                owner->unpin(slot);
+        }
+
+        const Snapshot& getGraph() const { return *snapshot;}
+        unsigned long getVersion() const { return snapshot->version;}
+
+    private:
+        Pin(VersionedGraph* owner, int slot, const Snapshot* snapshot) :
+            owner(owner), slot(slot), snapshot(snapshot) {}
+        Pin(const Pin& pin);
+        Pin& operator =(const Pin& pin);
+
+        VersionedGraph* owner;
+        // MAX_READERS for the overflow slot.
+        int slot;
+        const Snapshot* snapshot;
+
+        friend class VersionedGraph;
+};
+
+template<class V, class E>
+int VersionedGraph<V,E>::Snapshot::indexOf(int id) const {
+    if (id < 0 || id / ID_PAGE >= (int)pages.size() || !pages[id / ID_PAGE])
+        return -1;
+    return pages[id / ID_PAGE]->idx[id % ID_PAGE];
+}
+
+template<class V, class E>
+void VersionedGraph<V,E>::Snapshot::breadthFirstSearch(int source, vector<int>& dist) const {
+    dist.assign(getNodeCount(), -1);
+    if (source < 0 || source >= getNodeCount())
+        return;
+
+    vector<int> q;
+    q.reserve(getNodeCount());
+    dist[source] = 0;
+    q.push_back(source);
+    for (size_t head = 0; head < q.size(); head++) {
+        int idx = q[head];
+        for (const int* it = neighborsBegin(idx); it != neighborsEnd(idx); it++) {
+            if (dist[*it] == -1) {
+                dist[*it] = dist[idx] + 1;
+                q.push_back(*it);
+            }
+        }
+    }
+}
+
+// Undirected edges are in the lists of both ends already.
+template<class V, class E>
+void VersionedGraph<V,E>::Master::addAdjacent(int idx, vector<int>& touched) const {
+    touched.push_back(idx);
+    if (!this->isDirected()) {
+        EdgeRange<const E> range = this->neighborsAt(idx);
+        for (typename EdgeRange<const E>::iterator it = range.begin(); it != range.end(); ++it)
+            touched.push_back(it.otherIndex());
+        return;
+    }
+    this->addSourcesAt(idx, touched);
+}
+
+template<class V, class E>
+VersionedGraph<V,E>::VersionedGraph(bool directed) :
+    master(directed),
+    version(0),
+    epoch(1),
+    overflow(0) {
+    for (int i = 0; i < MAX_READERS; i++)
+        slots[i].store(0);
+    current.store(new Snapshot(directed, 0, 0, 0));
+}
+
+template<class V, class E>
+VersionedGraph<V,E>::~VersionedGraph() {
+    delete current.load();
+    for (size_t i = 0; i < retired.size(); i++)
+        delete retired[i];
+}
+
+template<class V, class E>
+unsigned long VersionedGraph<V,E>::getVersion() const {
+    return version.load();
+}
+
+template<class V, class E>
+int VersionedGraph<V,E>::getRetiredCount() const {
+    lock_guard<mutex> guard(write_lock);
+    return retired.size();
+}
+
+// Announce before loading the snapshot. A writer swapping it out after
+// the load retires it in an epoch not before the announced one, so it
+// is kept. An announced epoch gone stale before the CAS is only more
+// conservative, which is also why a pin joining the overflow slot may
+// keep the older epoch already there.
+template<class V, class E>
+typename VersionedGraph<V,E>::Pin VersionedGraph<V,E>::pin() {
+    for (int i = 0; i < MAX_READERS; i++) {
+        unsigned long free_slot = 0;
+        if (slots[i].load(memory_order_relaxed) != 0)
+            continue;
+        if (slots[i].compare_exchange_strong(free_slot, epoch.load()))
+            return Pin(this, i, current.load());
+    }
+
+    unsigned long word = overflow.load(), next;
+    do {
+        unsigned long count = word >> EPOCH_BITS;
+        unsigned long announced = count == 0 ? epoch.load() : word & EPOCH_MASK;
+        next = ((count + 1) << EPOCH_BITS) | announced;
+    } while (!overflow.compare_exchange_weak(word, next));
+    return Pin(this, MAX_READERS, current.load());
+}
+
+template<class V, class E>
+void VersionedGraph<V,E>::unpin(int slot) {
+    if (slot < MAX_READERS) {
+        slots[slot].store(0, memory_order_release);
+        return;
+    }
+    unsigned long word = overflow.load(), next;
+    do {
+        unsigned long count = (word >> EPOCH_BITS) - 1;
+        next = count == 0 ? 0 : (count << EPOCH_BITS) | (word & EPOCH_MASK);
+    } while (!overflow.compare_exchange_weak(word, next));
+}
+
+template<class V, class E>
+unsigned long VersionedGraph<V,E>::apply(const Batch& batch) {
+    lock_guard<mutex> guard(write_lock);
+    // Indices whose out lists may differ from the current version, and
+    // ids whose index may.
+    vector<int> touched, moved_ids;
+    for (size_t i = 0; i < batch.ops.size(); i++) {
+        const typename Batch::Op& op = batch.ops[i];
+        int n = master.getNodeCount();
+        int first = -1, second = -1;
+        if (op.type != Batch::INSERT_NODE) {
+            first = master.indexOf(op.first);
+            second = master.indexOf(op.second);
+        }
+        switch (op.type) {
+            case Batch::INSERT_NODE:
+                master.insertNode(const_cast<V&>(batch.nodes[op.first]));
+                if (master.getNodeCount() > n) {
+                    touched.push_back(n);
+                    moved_ids.push_back(batch.nodes[op.first].getId());
+                }
+                break;
+            case Batch::CREATE_EDGE:
+            case Batch::REMOVE_EDGE:
+                if (first == -1 || second == -1)
+                    break;
+                touched.push_back(first);
+                if (!master.isDirected())
+                    touched.push_back(second);
+                if (op.type == Batch::CREATE_EDGE)
+                    master.createEdge(*(master.begin() + first), *(master.begin() + second), op.weight);
+                else
+                    master.removeEdge(*(master.begin() + first), *(master.begin() + second));
+                break;
+            case Batch::REMOVE_NODE:
+                if (first == -1)
+                    break;
+                master.addAdjacent(first, touched);
+                master.addAdjacent(n - 1, touched);
+                moved_ids.push_back(op.first);
+                moved_ids.push_back((master.begin() + (n - 1))->getId());
+                master.removeNode(*(master.begin() + first));
+                break;
+        }
+    }
+
+    // Only writers replace current, so it is safe to read under the lock.
+    Snapshot* fresh = buildNext(*current.load(), touched, moved_ids);
+    Snapshot* old = current.exchange(fresh);
+    version.store(fresh->version);
+    old->retired_epoch = epoch.fetch_add(1);
+    retired.push_back(old);
+    reclaim();
+    return fresh->version;
+}
+
+// Blocks past the old end are new, and the last block changes size with
+// the node count.
+template<class V, class E>
+typename VersionedGraph<V,E>::Snapshot* VersionedGraph<V,E>::buildNext(const Snapshot& old, vector<int>& touched, vector<int>& moved_ids) const {
+    int n = master.getNodeCount();
+    Snapshot* fresh = new Snapshot(master.isDirected(), n, master.getEdgeCount(), old.version + 1);
+
+    int blocks = (n + BLOCK_NODES - 1) / BLOCK_NODES;
+    vector<char> dirty(blocks, 0);
+    fresh->blocks.assign(old.blocks.begin(), old.blocks.begin() + min(blocks, (int)old.blocks.size()));
+    fresh->blocks.resize(blocks);
+    for (size_t i = 0; i < touched.size(); i++)
+        if (touched[i] < n)
+            dirty[touched[i] / BLOCK_NODES] = 1;
+    if (n != old.node_count && n > 0)
+        dirty[(n - 1) / BLOCK_NODES] = 1;
+    for (int b = 0; b < blocks; b++)
+        if (dirty[b] || !fresh->blocks[b])
+            fresh->blocks[b].reset(buildBlock(b));
+
+    fresh->pages = old.pages;
+    sort(moved_ids.begin(), moved_ids.end());
+    for (size_t i = 0; i < moved_ids.size(); ) {
+        int p = moved_ids[i] / ID_PAGE;
+        if (p >= (int)fresh->pages.size())
+            fresh->pages.resize(p + 1);
+        IdPage* page = fresh->pages[p] ? new IdPage(*fresh->pages[p]) : new IdPage();
+        for (; i < moved_ids.size() && moved_ids[i] / ID_PAGE == p; i++)
+            page->idx[moved_ids[i] % ID_PAGE] = master.indexOf(moved_ids[i]);
+        fresh->pages[p].reset(page);
+    }
+    return fresh;
+}
+
+template<class V, class E>
+typename VersionedGraph<V,E>::Block* VersionedGraph<V,E>::buildBlock(int b) const {
+    int first = b * BLOCK_NODES;
+    int count = min(master.getNodeCount() - first, (int)BLOCK_NODES);
+    Block* block = new Block();
+    block->ids.resize(count);
+    block->offsets.assign(count + 1, 0);
+    for (int i = 0; i < count; i++)
+        block->offsets[i + 1] = block->offsets[i] + master.getOutDegreeAt(first + i);
+    block->targets.resize(block->offsets[count]);
+    block->weights.resize(block->offsets[count]);
+    block->edge_ids.resize(block->offsets[count]);
+
+    typename GraphBase<V,E>::const_iterator node = master.cbegin() + first;
+    for (int i = 0; i < count; i++, node++) {
+        block->ids[i] = node->getId();
+        EdgeRange<const E> range = master.neighborsAt(first + i);
+        int pos = block->offsets[i];
+        for (typename EdgeRange<const E>::iterator it = range.begin(); it != range.end(); ++it, pos++) {
+            block->targets[pos] = it.otherIndex();
+            block->weights[pos] = it->getWeight();
+            block->edge_ids[pos] = it->getId();
+        }
+    }
+    return block;
+}
+
+template<class V, class E>
+void VersionedGraph<V,E>::reclaim() {
+    unsigned long oldest = epoch.load();
+    for (int i = 0; i < MAX_READERS; i++) {
+        unsigned long announced = slots[i].load();
+        if (announced != 0 && announced < oldest)
+            oldest = announced;
+    }
+    unsigned long word = overflow.load();
+    if (word != 0 && (word & EPOCH_MASK) < oldest)
+        oldest = word & EPOCH_MASK;
+
+    size_t kept = 0;
+    for (size_t i = 0; i < retired.size(); i++) {
+        if (retired[i]->retired_epoch < oldest)
+            delete retired[i];
+        else
+            retired[kept++] = retired[i];
+    }
+    retired.resize(kept);
+}
+#endif
@@ -0,0 +1,32 @@
+#ifndef __VISITOR__
+#define __VISITOR__
+
+/*
+ * Compile time visitor for graph traversals.
+ *
+ * breadthFirstVisit and depthFirstVisit are templated on the visitor type
+ * and call its hooks directly, so hooks that are left empty inline away
+ * and the traversal loop carries no call at all.
+ *
+ * Derive from GraphVisitor and redefine only the hooks needed, the rest
+ * stay as the empty defaults below. Hooks are plain member functions,
+ * they must not be virtual or the point is lost.
+ *
+ *      processOnGrey(node)         node is discovered
+ *      processOnBlack(node)        node is completely processed
+ *      processEdge(edge, type)     DFS examines edge, type is its classification
+ *      finished()                  true stops the traversal early, checked as
+ *                                  BFS takes a node off the queue and after
+ *                                  every DFS edge
+ *
+ * Traversals may run on a const graph so hooks only get const access.
+ */
+template<class V, class E>
+class GraphVisitor {
+    public:
+        void processOnGrey(const V&) {}
+        void processOnBlack(const V&) {}
+        void processEdge(const E*, typename E::EDGE_TYPE) {}
+        bool finished() const { return false;}
+};
+#endif
@@ -0,0 +1,175 @@
+#include<vector>
+#include<utility>
+#include "traversal_stats.hpp"
+#ifndef __WORKSPACE__
+#define __WORKSPACE__
+using namespace std;
+
+template<class V, class E> class GraphBase;
+class IndexTraversal;
+
+/*
+ * Per run traversal state, kept out of Node.
+ *
+ * State is stored as one array per field indexed by the adjacency index
+ * of the node, so a traversal touches only the fields it uses and any
+ * number of traversals can run over the same graph, each with its own
+ * workspace.
+ *
+ * Every slot carries the generation it was last written in. A slot from
+ * an older generation reads as default (WHITE, -1 everywhere), so
+ * starting a new run or a soft reset is a counter increment instead of a
+ * pass over all nodes.
+ */
+template<class E>
+class TraversalWorkspace {
+    public:
+        enum COLOR {WHITE, GRAY, BLACK};
+
+        TraversalWorkspace() : generation(1), clock(0) {}
+
+        // Start a new run over nNodes nodes. O(1) unless arrays have to grow.
+        void prepare(int nNodes);
+        template<class Stats> void prepare(int nNodes, Stats& stats);
+
+        // Forget everything recorded so far.
+        void clear();
+        // Room for nNodes keeping what was recorded, new nodes are white.
+        // True if the arrays grew.
+        bool grow(int nNodes);
+
+        int size() const { return stamp.size();}
+
+        COLOR getColor(int idx) const { return fresh(idx) ? (COLOR)color[idx] : WHITE;}
+        // Adjacency index of the parent in traversal tree, -1 for roots.
+        int getParent(int idx) const { return fresh(idx) ? parent[idx] : -1;}
+        // Id of the edge through which the node was discovered.
+        int getParentEdge(int idx) const { return fresh(idx) ? parent_edge[idx] : -1;}
+        // Populated with BFS
+        int getDist2Source(int idx) const { return fresh(idx) ? dist2s[idx] : -1;}
+        // Populated while DFS
+        int getEntryTime(int idx) const { return fresh(idx) ? entry_index[idx] : -1;}
+        int getExitTime(int idx) const { return fresh(idx) ? exit_index[idx] : -1;}
+        int getComponentId(int idx) const { return fresh(idx) ? component_id[idx] : -1;}
+
+        void setColor(int idx, COLOR clr) { touch(idx); color[idx] = clr;}
+        void setParent(int idx, int parent_idx, int edge_id) {
+            touch(idx);
+            parent[idx] = parent_idx;
+            parent_edge[idx] = edge_id;
+        }
+        void setDist2Source(int idx, int dist) { touch(idx); dist2s[idx] = dist;}
+        void setEntryTime(int idx, int entry_idx) { touch(idx); entry_index[idx] = entry_idx;}
+        void setExitTime(int idx, int exit_idx) { touch(idx); exit_index[idx] = exit_idx;}
+        void setComponentId(int idx, int component) { touch(idx); component_id[idx] = component;}
+
+        // Rearrange slots after nodes were reordered, order[new] = old.
+        void permute(const vector<int>& order);
+
+    private:
+        bool fresh(int idx) const { return stamp[idx] == generation;}
+        void touch(int idx);
+
+        unsigned generation;
+        vector<unsigned> stamp;
+        vector<char> color;
+        vector<int> parent;
+        vector<int> parent_edge;
+        vector<int> dist2s;
+        vector<int> entry_index;
+        vector<int> exit_index;
+        vector<int> component_id;
+
+        // Scratch space reused across runs.
+        int clock;
+        vector<int> queue;
+        vector< pair<int, const E*> > stack;
+
+        template<class V, class F> friend class GraphBase;
+        friend class IndexTraversal;
+};
+
+template<class E>
+void TraversalWorkspace<E>::touch(int idx) {
+    if (stamp[idx] != generation) {
+        stamp[idx] = generation;
+        color[idx] = WHITE;
+        parent[idx] = -1;
+        parent_edge[idx] = -1;
+        dist2s[idx] = -1;
+        entry_index[idx] = -1;
+        exit_index[idx] = -1;
+        component_id[idx] = -1;
+    }
+}
+
+template<class E>
+void TraversalWorkspace<E>::clear() {
+    clock = 0;
+    if (++generation == 0) {
+        // Wrapped around, old stamps could look fresh again.
+        stamp.assign(stamp.size(), 0);
+        generation = 1;
+    }
+}
+
+template<class E>
+void TraversalWorkspace<E>::prepare(int nNodes) {
+    NoTraversalStats stats;
+    prepare(nNodes, stats);
+}
+
+// New slots get stamp 0 which is never a live generation.
+template<class E>
+bool TraversalWorkspace<E>::grow(int nNodes) {
+    if (size() >= nNodes)
+        return false;
+    stamp.resize(nNodes, 0);
+    color.resize(nNodes);
+    parent.resize(nNodes);
+    parent_edge.resize(nNodes);
+    dist2s.resize(nNodes);
+    entry_index.resize(nNodes);
+    exit_index.resize(nNodes);
+    component_id.resize(nNodes);
+    return true;
+}
+
+template<class E>
+template<class Stats>
+void TraversalWorkspace<E>::prepare(int nNodes, Stats& stats) {
+    if (grow(nNodes))
+        stats.allocated(nNodes * (sizeof(unsigned) + sizeof(char) + 6 * sizeof(int)));
+    // Neither the BFS queue nor the DFS stack can outgrow node count.
+    if ((int)queue.capacity() < nNodes) {
+        queue.reserve(nNodes);
+        stack.reserve(nNodes);
+        stats.allocated(nNodes * (sizeof(int) + sizeof(pair<int, const E*>)));
+    }
+    clear();
+}
+
+template<class E>
+void TraversalWorkspace<E>::permute(const vector<int>& order) {
+    grow(order.size());
+    TraversalWorkspace<E> old(*this);
+    for (size_t i = 0; i < order.size(); i++) {
+        int from = order[i];
+        stamp[i] = old.stamp[from];
+        color[i] = old.color[from];
+        parent[i] = old.parent[from];
+        parent_edge[i] = old.parent_edge[from];
+        dist2s[i] = old.dist2s[from];
+        entry_index[i] = old.entry_index[from];
+        exit_index[i] = old.exit_index[from];
+        component_id[i] = old.component_id[from];
+    }
+    // Parents refer to adjacency indices too.
+    vector<int> position(order.size());
+    for (size_t i = 0; i < order.size(); i++)
+        position[order[i]] = i;
+    for (size_t i = 0; i < order.size(); i++)
+        if (parent[i] >= 0 && parent[i] < (int)order.size())
+            parent[i] = position[parent[i]];
+}
+#endif
@@ -0,0 +1,42 @@
+#include "../graph/graph.hpp"
+#ifndef __NODE_FIXTURE__
+#define __NODE_FIXTURE__
+using namespace std;
+
+/*
+ * N nodes for the tests of one class, nodeArr[i] holding value i. Graphs
+ * copy the nodes inserted but keep referring to the values, so they must
+ * not outlive the fixture.
+ */
+template<int N>
+class NodeFixture {
+    public:
+        int vals[N];
+        Node<int>* nodeArr[N];
+
+        NodeFixture() {
+            for (int i = 0; i < N; i++) {
+                vals[i] = i;
+                nodeArr[i] = new Node<int>(vals[i]);
+            }
+        }
+
+        ~NodeFixture() {
+            for (int i = 0; i < N; i++)
+                delete nodeArr[i];
+        }
+
+        // Edge from nodeArr[from] to nodeArr[to], both inserted in g.
+        template<class G>
+        void link(G& g, int from, int to, float weight = 0) {
+            g.createEdge(g.getNodeById(nodeArr[from]->getId()), g.getNodeById(nodeArr[to]->getId()), weight);
+        }
+
+        // Iteration index of nodeArr[i] in g.
+        template<class G>
+        int index(const G& g, int i) const { return g.indexOf(nodeArr[i]->getId());}
+
+    private:
+        NodeFixture(const NodeFixture& fixture);
+};
+#endif
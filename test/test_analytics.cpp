@@ -0,0 +1,305 @@
+#include<iostream>
+#include<set>
+#include "../../test/ASSERT.hpp"
+#include "../graph/analytics.hpp"
+
+using namespace std;
+
+class TestAnalytics {
+    public:
+        typedef Graph<int> TGraph;
+
+        void testPageRank() {
+            TGraph g(true);
+            Node<int>* nodeArr[3000];
+            for (int i = 0; i < 3000; i++) {
+                nodeArr[i] = new Node<int>(i);
+                nodeArr[i]->populateNode(true);
+            }
+
+            // Cycle: every node keeps 1/3.
+            for (int i = 0; i < 3; i++)
+                g.insertNode(*nodeArr[i]);
+            for (int i = 0; i < 3; i++)
+                g.createEdge(*nodeArr[i], *nodeArr[(i + 1) % 3]);
+            vector<double> rank;
+            int iters = Analytics::pageRank(g, rank);
+            ASSERT(iters == 1, "Uniform start is already converged, took:" << iters);
+            for (int i = 0; i < 3; i++)
+                ASSERT(fabs(rank[i] - 1.0 / 3) < 1e-12, "Cycle rank should be uniform");
+
+            // Large enough for several threads, with dangling nodes.
+            TGraph big(true);
+            big.createRandomGraph(3000, nodeArr, 0.001);
+            int n = big.getNodeCount();
+            vector<double> expected(n, 1.0 / n), next(n);
+            for (int iter = 0; iter < 50; iter++) {
+                double dangling = 0;
+                next.assign(n, 0);
+                for (int u = 0; u < n; u++) {
+                    if (big.getOutDegreeAt(u) == 0)
+                        dangling += expected[u];
+                    EdgeRange<Edge> range = big.neighborsAt(u);
+                    for (EdgeRange<Edge>::iterator it = range.begin(); it != range.end(); ++it)
+                        next[it.otherIndex()] += expected[u] / big.getOutDegreeAt(u);
+                }
+                for (int v = 0; v < n; v++)
+                    expected[v] = (0.15 + 0.85 * dangling) / n + 0.85 * next[v];
+            }
+            vector<double> serial;
+            ASSERT(Analytics::pageRank(big, serial, 0.85, 0, 50, 1) == 50, "Zero tolerance runs max_iters");
+            ASSERT(Analytics::threadCount(4, n) == 3, "Large enough for 3 threads");
+            ASSERT(Analytics::pageRank(big, rank, 0.85, 0, 50, 4) == 50, "Zero tolerance runs max_iters");
+            double total = 0;
+            for (int v = 0; v < n; v++) {
+                ASSERT(fabs(rank[v] - expected[v]) < 1e-12 && fabs(serial[v] - expected[v]) < 1e-12, "Rank of " << v << ", " << rank[v] << " vs " << expected[v]);
+                total += rank[v];
+            }
+            ASSERT(fabs(total - 1) < 1e-9, "Ranks sum to one, got:" << total);
+
+            iters = Analytics::pageRank(big, rank, 0.85, 1e-8);
+            ASSERT(iters < 100, "Should converge, took:" << iters);
+            for (int v = 0; v < n; v++)
+                ASSERT(fabs(rank[v] - expected[v]) < 1e-6, "Converged rank of " << v);
+            cout << "testPageRank Done!" << endl;
+        }
+
+        void testTriangles() {
+            // K4 minus edge 2-3 plus a pendant node: triangles 012 and 013.
+            TGraph g(false);
+            Node<int>* nodeArr[2500];
+            for (int i = 0; i < 2500; i++) {
+                nodeArr[i] = new Node<int>(i);
+                nodeArr[i]->populateNode(true);
+            }
+            for (int i = 0; i < 5; i++)
+                g.insertNode(*nodeArr[i]);
+            g.createEdge(*nodeArr[0], *nodeArr[1]);
+            g.createEdge(*nodeArr[0], *nodeArr[2]);
+            g.createEdge(*nodeArr[0], *nodeArr[3]);
+            g.createEdge(*nodeArr[1], *nodeArr[2]);
+            g.createEdge(*nodeArr[1], *nodeArr[3]);
+            g.createEdge(*nodeArr[3], *nodeArr[4]);
+            ASSERT(Analytics::countTriangles(g) == 2, "Two triangles, got:" << Analytics::countTriangles(g));
+            vector<double> coefficient;
+            Analytics::localClusteringCoefficient(g, coefficient);
+            ASSERT(fabs(coefficient[0] - 2.0 / 3) < 1e-12 && fabs(coefficient[1] - 2.0 / 3) < 1e-12, "Two of three pairs joined");
+            ASSERT(coefficient[2] == 1 && fabs(coefficient[3] - 1.0 / 3) < 1e-12 && coefficient[4] == 0, "Coefficients of 2, 3, 4");
+
+            // Brute force on random graphs, directed ones count as undirected.
+            // Large enough for 3 threads.
+            for (int round = 0; round < 4; round++) {
+                TGraph r(round % 2 == 1);
+                r.createRandomGraph(2500, nodeArr, 0.004);
+                int n = r.getNodeCount();
+                ASSERT(Analytics::threadCount(3, n) == 3, "Three threads on " << n << " nodes");
+                vector< vector<char> > adjacent(n, vector<char>(n, 0));
+                for (int u = 0; u < n; u++) {
+                    EdgeRange<Edge> range = r.neighborsAt(u);
+                    for (EdgeRange<Edge>::iterator it = range.begin(); it != range.end(); ++it)
+                        if (it.otherIndex() != u)
+                            adjacent[u][it.otherIndex()] = adjacent[it.otherIndex()][u] = 1;
+                }
+                long long expected = 0;
+                vector<long long> at(n, 0);
+                for (int u = 0; u < n; u++)
+                    for (int v = u + 1; v < n; v++)
+                        if (adjacent[u][v])
+                            for (int w = v + 1; w < n; w++)
+                                if (adjacent[u][w] && adjacent[v][w]) {
+                                    expected++;
+                                    at[u]++; at[v]++; at[w]++;
+                                }
+                ASSERT(expected > 0, "Random graph should have triangles");
+                ASSERT(Analytics::countTriangles(r, 1) == expected && Analytics::countTriangles(r, 3) == expected, "Triangles, " << Analytics::countTriangles(r) << " vs " << expected);
+                Analytics::localClusteringCoefficient(r, coefficient, 3);
+                for (int u = 0; u < n; u++) {
+                    long long degree = 0;
+                    for (int v = 0; v < n; v++)
+                        degree += adjacent[u][v];
+                    double local = degree < 2 ? 0 : 2.0 * at[u] / (degree * (degree - 1));
+                    ASSERT(fabs(coefficient[u] - local) < 1e-12, "Coefficient of " << u);
+                }
+            }
+            cout << "testTriangles Done!" << endl;
+        }
+
+        void testCoreNumbers() {
+            // Triangle 012 with a tail 2-3-4 and node 5 alone.
+            TGraph g(false);
+            Node<int>* nodeArr[3000];
+            for (int i = 0; i < 3000; i++) {
+                nodeArr[i] = new Node<int>(i);
+                nodeArr[i]->populateNode(true);
+            }
+            for (int i = 0; i < 6; i++)
+                g.insertNode(*nodeArr[i]);
+            g.createEdge(*nodeArr[0], *nodeArr[1]);
+            g.createEdge(*nodeArr[1], *nodeArr[2]);
+            g.createEdge(*nodeArr[2], *nodeArr[0]);
+            g.createEdge(*nodeArr[2], *nodeArr[3]);
+            g.createEdge(*nodeArr[3], *nodeArr[4]);
+            vector<int> core;
+            Analytics::coreNumbers(g, core);
+            int expected_small[6] = {2, 2, 2, 1, 1, 0};
+            for (int i = 0; i < 6; i++)
+                ASSERT(core[g.indexOf(nodeArr[i]->getId())] == expected_small[i], "Core of " << i << ":" << core[i]);
+
+            // Against peeling one node of least degree at a time.
+            for (int round = 0; round < 4; round++) {
+                TGraph r(round % 2 == 1);
+                r.createRandomGraph(3000, nodeArr, 0.003);
+                int n = r.getNodeCount();
+                vector< set<int> > adjacent(n);
+                for (int u = 0; u < n; u++) {
+                    EdgeRange<Edge> range = r.neighborsAt(u);
+                    for (EdgeRange<Edge>::iterator it = range.begin(); it != range.end(); ++it)
+                        if (it.otherIndex() != u) {
+                            adjacent[u].insert(it.otherIndex());
+                            adjacent[it.otherIndex()].insert(u);
+                        }
+                }
+                vector<int> expected(n, -1);
+                set< pair<int, int> > order;
+                vector<int> degree(n);
+                for (int u = 0; u < n; u++) {
+                    degree[u] = adjacent[u].size();
+                    order.insert(make_pair(degree[u], u));
+                }
+                int k = 0;
+                while (!order.empty()) {
+                    int u = order.begin()->second;
+                    order.erase(order.begin());
+                    k = max(k, degree[u]);
+                    expected[u] = k;
+                    for (set<int>::iterator it = adjacent[u].begin(); it != adjacent[u].end(); ++it) {
+                        if (expected[*it] != -1)
+                            continue;
+                        order.erase(make_pair(degree[*it], *it));
+                        order.insert(make_pair(--degree[*it], *it));
+                    }
+                }
+                Analytics::coreNumbers(r, core, 1);
+                ASSERT(core == expected, "Serial core numbers should match");
+                Analytics::coreNumbers(r, core, 3);
+                ASSERT(core == expected, "Parallel core numbers should match");
+            }
+            cout << "testCoreNumbers Done!" << endl;
+        }
+
+        // Against the definition, with all pairs distances and path
+        // counts from Floyd Warshall on small integer weights.
+        void testBetweenness() {
+            Node<int>* nodeArr[60];
+            for (int i = 0; i < 60; i++) {
+                nodeArr[i] = new Node<int>(i);
+                nodeArr[i]->populateNode(true);
+            }
+            srand(11);
+            for (int round = 0; round < 4; round++) {
+                bool directed = round % 2 == 0, weighted = round >= 2;
+                TGraph g(directed);
+                for (int i = 0; i < 60; i++)
+                    g.insertNode(*nodeArr[i]);
+                int n = g.getNodeCount();
+                const double inf = 1e18;
+                vector< vector<double> > d(n, vector<double>(n, inf)), sigma(n, vector<double>(n, 0));
+                for (int u = 0; u < 60; u++)
+                    for (int v = directed ? 0 : u + 1; v < 60; v++)
+                        if (u != v && rand() % 10 == 0) {
+                            int w = weighted ? 1 + rand() % 3 : 1;
+                            g.createEdge(*nodeArr[u], *nodeArr[v], w);
+                            int a = g.indexOf(nodeArr[u]->getId()), b = g.indexOf(nodeArr[v]->getId());
+                            d[a][b] = w;
+                            if (!directed)
+                                d[b][a] = w;
+                        }
+                for (int v = 0; v < n; v++)
+                    d[v][v] = 0;
+                for (int k = 0; k < n; k++)
+                    for (int i = 0; i < n; i++)
+                        for (int j = 0; j < n; j++)
+                            d[i][j] = min(d[i][j], d[i][k] + d[k][j]);
+                // Path counts in order of distance from each source.
+                for (int s = 0; s < n; s++) {
+                    vector< pair<double, int> > byDist;
+                    for (int t = 0; t < n; t++)
+                        if (d[s][t] < inf)
+                            byDist.push_back(make_pair(d[s][t], t));
+                    sort(byDist.begin(), byDist.end());
+                    sigma[s][s] = 1;
+                    for (size_t i = 1; i < byDist.size(); i++) {
+                        int t = byDist[i].second;
+                        for (int u = 0; u < n; u++) {
+                            if (d[s][u] >= inf)
+                                continue;
+                            EdgeRange<Edge> range = g.neighborsAt(u);
+                            for (EdgeRange<Edge>::iterator it = range.begin(); it != range.end(); ++it)
+                                if (it.otherIndex() == t && d[s][u] + it->getWeight() == d[s][t])
+                                    sigma[s][t] += sigma[s][u];
+                        }
+                    }
+                }
+                vector<double> expected(n, 0);
+                for (int s = 0; s < n; s++)
+                    for (int t = 0; t < n; t++)
+                        for (int v = 0; v < n; v++)
+                            if (s != t && v != s && v != t && d[s][t] < inf && d[s][v] + d[v][t] == d[s][t])
+                                expected[v] += sigma[s][v] * sigma[v][t] / sigma[s][t];
+                if (!directed)
+                    for (int v = 0; v < n; v++)
+                        expected[v] /= 2;
+
+                vector<double> centrality;
+                Analytics::betweennessCentrality(g, centrality, weighted, 0, 3);
+                for (int v = 0; v < n; v++)
+                    ASSERT(fabs(centrality[v] - expected[v]) < 1e-9, "Betweenness of " << v << ", " << centrality[v] << " vs " << expected[v]);
+
+                // All sources sampled is exact, fewer is an estimate.
+                vector<double> sampled;
+                Analytics::betweennessCentrality(g, sampled, weighted, n, 2);
+                for (int v = 0; v < n; v++)
+                    ASSERT(fabs(sampled[v] - expected[v]) < 1e-9, "Sampling every source is exact");
+                Analytics::betweennessCentrality(g, sampled, weighted, 30, 2, 5);
+                double total = 0, sampled_total = 0;
+                for (int v = 0; v < n; v++) {
+                    total += expected[v];
+                    sampled_total += sampled[v];
+                }
+                ASSERT(sampled_total > total / 2 && sampled_total < total * 2, "Estimate near exact total, " << sampled_total << " vs " << total);
+            }
+
+            // Several threads merging partial sums, against one thread on
+            // the same sampled sources.
+            Node<int>* bigArr[2500];
+            for (int i = 0; i < 2500; i++) {
+                bigArr[i] = new Node<int>(i);
+                bigArr[i]->populateNode(true);
+            }
+            for (int round = 0; round < 2; round++) {
+                TGraph g(round == 0);
+                g.createRandomGraph(2500, bigArr, 0.002, round == 1);
+                int n = g.getNodeCount();
+                ASSERT(Analytics::threadCount(3, n) == 3, "Three threads on " << n << " nodes");
+                vector<double> serial, parallel;
+                Analytics::betweennessCentrality(g, serial, round == 1, 500, 1);
+                Analytics::betweennessCentrality(g, parallel, round == 1, 500, 3);
+                double total = 0;
+                for (int v = 0; v < n; v++) {
+                    ASSERT(fabs(parallel[v] - serial[v]) <= 1e-9 * max(1.0, serial[v]), "Parallel betweenness of " << v << ", " << parallel[v] << " vs " << serial[v]);
+                    total += serial[v];
+                }
+                ASSERT(total > 0, "Some paths go through other nodes");
+            }
+            cout << "testBetweenness Done!" << endl;
+        }
+};
+
+int main() {
+    TestAnalytics test;
+    test.testPageRank();
+    test.testTriangles();
+    test.testCoreNumbers();
+    test.testBetweenness();
+    return 0;
+}
@@ -0,0 +1,170 @@
+#include<iostream>
+#include<set>
+#include "../../test/ASSERT.hpp"
+#include "node_fixture.hpp"
+#include "../graph/biconnected.hpp"
+
+using namespace std;
+
+class TestBiconnected : public NodeFixture<200> {
+    public:
+        typedef Graph<int> TGraph;
+
+        // Id of an edge between nodes a and b.
+        int edgeId(TGraph& g, int a, int b) {
+            EdgeRange<Edge> range = g.neighborsAt(index(g, a));
+            for (EdgeRange<Edge>::iterator it = range.begin(); it != range.end(); ++it)
+                if (it.otherIndex() == index(g, b))
+                    return it->getId();
+            return edgeId(g, b, a);
+        }
+
+        // Connected components among nodes not removed, using the edges
+        // other than skip_edge.
+        int countComponents(TGraph& g, int removed, int skip_edge) {
+            int n = g.getNodeCount();
+            vector< vector<int> > adjacency(n);
+            for (int u = 0; u < n; u++) {
+                EdgeRange<Edge> range = g.neighborsAt(u);
+                for (EdgeRange<Edge>::iterator it = range.begin(); it != range.end(); ++it) {
+                    if (it->getId() == skip_edge)
+                        continue;
+                    adjacency[u].push_back(it.otherIndex());
+                    adjacency[it.otherIndex()].push_back(u);
+                }
+            }
+            vector<char> seen(n, 0);
+            int count = 0;
+            for (int root = 0; root < n; root++) {
+                if (seen[root] || root == removed)
+                    continue;
+                count++;
+                seen[root] = 1;
+                vector<int> bfs(1, root);
+                for (size_t head = 0; head < bfs.size(); head++)
+                    for (size_t i = 0; i < adjacency[bfs[head]].size(); i++) {
+                        int v = adjacency[bfs[head]][i];
+                        if (!seen[v] && v != removed) {
+                            seen[v] = 1;
+                            bfs.push_back(v);
+                        }
+                    }
+            }
+            return count;
+        }
+
+        // Triangles {0,1,2} and {3,4,5} joined by bridge 2 - 3, a doubled
+        // edge 5 - 6 (the second of another weight, equal edges are not
+        // added twice), a pendant 6 - 7, a self loop on 0 and node 8 alone.
+        void testSmall() {
+            TGraph g(false);
+            for (int i = 0; i < 9; i++)
+                g.insertNode(*nodeArr[i]);
+            link(g, 0, 1); link(g, 1, 2); link(g, 2, 0);
+            link(g, 3, 4); link(g, 4, 5); link(g, 5, 3);
+            link(g, 2, 3); link(g, 5, 6); link(g, 6, 5, 1); link(g, 6, 7);
+            link(g, 0, 0);
+            Biconnected bc(g);
+
+            ASSERT(bc.getComponentCount() == 5, "Five components, got:" << bc.getComponentCount());
+            ASSERT(bc.getBridgeCount() == 2, "Two bridges, got:" << bc.getBridgeCount());
+            ASSERT(bc.isBridge(edgeId(g, 2, 3)) && bc.isBridge(edgeId(g, 6, 7)), "Bridges 2 - 3 and 6 - 7");
+            ASSERT(!bc.isBridge(edgeId(g, 5, 6)), "Doubled edge is not a bridge");
+            ASSERT(bc.getEdgeComponent(edgeId(g, 0, 0)) == -1, "Self loop in no component");
+            ASSERT(bc.getEdgeComponent(edgeId(g, 0, 1)) == bc.getEdgeComponent(edgeId(g, 2, 0)), "Triangle together");
+            ASSERT(bc.getEdgeComponent(edgeId(g, 0, 1)) != bc.getEdgeComponent(edgeId(g, 3, 4)), "Triangles apart");
+            ASSERT(bc.getComponentSize(bc.getEdgeComponent(edgeId(g, 5, 6))) == 2, "Doubled edge is a component");
+
+            vector<int> points;
+            bc.getArticulationPoints(points);
+            set<int> expected;
+            expected.insert(index(g, 2)); expected.insert(index(g, 3));
+            expected.insert(index(g, 5)); expected.insert(index(g, 6));
+            ASSERT(set<int>(points.begin(), points.end()) == expected, "Articulation points 2, 3, 5, 6");
+            cout << "testSmall Done!" << endl;
+        }
+
+        // Bridges and articulation points against removal, components
+        // checked to be biconnected and to cover every node the right
+        // number of times: sum of (nodes - 1) over components equals nodes
+        // with edges minus their connected components.
+        void testRandom() {
+            srand(11);
+            for (int round = 0; round < 12; round++) {
+                TGraph g(round % 2 == 0);
+                int n = 10 + 5 * (round % 5);
+                for (int i = 0; i < n; i++)
+                    g.insertNode(*nodeArr[i]);
+                for (int i = 0; i < n * 6 / 5; i++) {
+                    int u = rand() % n, v = rand() % n;
+                    if (u != v)
+                        link(g, u, v, rand() % 2);
+                }
+                Biconnected bc(g);
+                // Nodes were inserted in order, index i holds nodeArr[i].
+                int base = countComponents(g, -1, -1);
+
+                set<int> bridge_ids;
+                for (int i = 0; i < bc.getBridgeCount(); i++)
+                    bridge_ids.insert(bc.getBridge(i));
+                int touched = 0;
+                for (int u = 0; u < n; u++) {
+                    EdgeRange<Edge> range = g.neighborsAt(u);
+                    for (EdgeRange<Edge>::iterator it = range.begin(); it != range.end(); ++it) {
+                        bool bridge = countComponents(g, -1, it->getId()) > base;
+                        ASSERT(bc.isBridge(it->getId()) == bridge, "Bridge " << it->getId());
+                        ASSERT(bridge_ids.count(it->getId()) == (bridge ? 1 : 0), "Listed bridge " << it->getId());
+                    }
+                    int degree = g.getOutDegreeAt(u) + (g.isDirected() ? g.getInDegreeAt(u) : 0);
+                    if (degree > 0)
+                        touched++;
+                    bool cut = countComponents(g, u, -1) > base - (degree == 0 ? 1 : 0);
+                    ASSERT(bc.isArticulationPoint(u) == cut, "Articulation point " << u);
+                }
+
+                int spread = 0;
+                for (int c = 0; c < bc.getComponentCount(); c++) {
+                    set<int> members;
+                    for (const int* e = bc.edgesBegin(c); e != bc.edgesEnd(c); e++) {
+                        ASSERT(bc.getEdgeComponent(*e) == c, "Edge maps back to its component");
+                        for (int u = 0; u < n; u++) {
+                            EdgeRange<Edge> range = g.neighborsAt(u);
+                            for (EdgeRange<Edge>::iterator it = range.begin(); it != range.end(); ++it) {
+                                if (it->getId() == *e) {
+                                    members.insert(u);
+                                    members.insert(it.otherIndex());
+                                }
+                            }
+                        }
+                    }
+                    spread += members.size() - 1;
+                    // No single node disconnects a component of 3 nodes or more.
+                    if (members.size() < 3)
+                        continue;
+                    for (set<int>::iterator m = members.begin(); m != members.end(); ++m) {
+                        TGraph sub(false);
+                        for (set<int>::iterator it = members.begin(); it != members.end(); ++it)
+                            if (*it != *m)
+                                sub.insertNode(*nodeArr[*it]);
+                        for (const int* e = bc.edgesBegin(c); e != bc.edgesEnd(c); e++)
+                            for (int u = 0; u < n; u++) {
+                                EdgeRange<Edge> range = g.neighborsAt(u);
+                                for (EdgeRange<Edge>::iterator it = range.begin(); it != range.end(); ++it)
+                                    if (it->getId() == *e && u != *m && it.otherIndex() != *m)
+                                        link(sub, u, it.otherIndex());
+                            }
+                        ASSERT(countComponents(sub, -1, -1) == 1, "Component " << c << " stays connected");
+                    }
+                }
+                ASSERT(spread == touched - (base - (n - touched)), "Components cover the nodes, " << spread);
+            }
+            cout << "testRandom Done!" << endl;
+        }
+};
+
+int main() {
+    TestBiconnected test;
+    test.testSmall();
+    test.testRandom();
+    return 0;
+}
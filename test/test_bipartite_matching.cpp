@@ -0,0 +1,205 @@
+#include<iostream>
+#include<math.h>
+#include "../../test/ASSERT.hpp"
+#include "node_fixture.hpp"
+#include "../graph/bipartite_matching.hpp"
+#include "../graph/max_flow.hpp"
+
+using namespace std;
+
+// Nodes with even value on the left.
+struct EvenLeft {
+    bool operator()(const Node<int>& node) const { return node.getValue() % 2 == 0;}
+};
+
+class TestBipartiteMatching : public NodeFixture<400> {
+    public:
+        typedef Graph<int> TGraph;
+
+        // Mates are symmetric, on opposite sides, joined by an edge, and
+        // count up to the size.
+        void checkMatching(const TGraph& g, const BipartiteMatching& matching) {
+            int matched = 0;
+            for (int u = 0; u < g.getNodeCount(); u++) {
+                int mate = matching.getMate(u);
+                if (mate == -1)
+                    continue;
+                matched++;
+                ASSERT(matching.getMate(mate) == u, "Mates are symmetric");
+                ASSERT(matching.isLeft(u) != matching.isLeft(mate), "Mates on opposite sides");
+                bool joined = false;
+                EdgeRange<const Edge> range = g.neighborsAt(u);
+                for (EdgeRange<const Edge>::iterator it = range.begin(); it != range.end(); ++it)
+                    joined |= it.otherIndex() == mate;
+                range = g.neighborsAt(mate);
+                for (EdgeRange<const Edge>::iterator it = range.begin(); it != range.end(); ++it)
+                    joined |= it.otherIndex() == u;
+                ASSERT(joined, "Mates are joined by an edge");
+            }
+            ASSERT(matched == 2 * matching.getSize(), "Size counts matched pairs");
+        }
+
+        // Least and greatest total over every way to give each row of w
+        // its own column.
+        void bestAssignment(const vector< vector<double> >& w, int row, double total, vector<char>& taken,
+                            double& best_min, double& best_max) {
+            if (row == (int)w.size()) {
+                best_min = min(best_min, total);
+                best_max = max(best_max, total);
+                return;
+            }
+            for (size_t col = 0; col < taken.size(); col++) {
+                if (taken[col])
+                    continue;
+                taken[col] = 1;
+                bestAssignment(w, row + 1, total + w[row][col], taken, best_min, best_max);
+                taken[col] = 0;
+            }
+        }
+
+        // Random bipartite graphs, size against unit capacity max flow.
+        void testRandom() {
+            srand(5);
+            for (int round = 0; round < 10; round++) {
+                TGraph g(round % 2 == 0);
+                int n = 100 + 30 * round;
+                for (int i = 0; i < n; i++)
+                    g.insertNode(*nodeArr[i]);
+                for (int u = 0; u < n; u += 2)
+                    for (int v = 1; v < n; v += 2)
+                        if (rand() % (n / 4) == 0)
+                            link(g, u, v, 1);
+                EvenLeft side;
+                BipartiteMatching matching(g, side);
+                int size = matching.solve();
+                checkMatching(g, matching);
+
+                // Nodes were inserted in order, index i holds nodeArr[i].
+                TGraph flowGraph(true);
+                for (int i = 0; i < n + 2; i++)
+                    flowGraph.insertNode(*nodeArr[i]);
+                for (int u = 0; u < n; u += 2) {
+                    link(flowGraph, n, u, 1);
+                    EdgeRange<Edge> range = g.neighborsAt(u);
+                    for (EdgeRange<Edge>::iterator it = range.begin(); it != range.end(); ++it)
+                        link(flowGraph, u, it.otherIndex(), 1);
+                }
+                for (int v = 1; v < n; v += 2)
+                    link(flowGraph, v, n + 1, 1);
+                MaxFlow flow(flowGraph);
+                double expected = flow.solve(flowGraph.indexOf(nodeArr[n]->getId()), flowGraph.indexOf(nodeArr[n + 1]->getId()));
+                ASSERT(size == expected, "Matching size should equal max flow, " << size << " vs " << expected);
+
+                BipartiteMatching coloured(g);
+                ASSERT(coloured.isBipartite(), "Graph with edges only across is bipartite");
+                ASSERT(coloured.solve() == size, "Same size with 2-colouring");
+                checkMatching(g, coloured);
+            }
+            cout << "testRandom Done!" << endl;
+        }
+
+        // Against every permutation on small complete bipartite graphs.
+        void testWeighted() {
+            srand(9);
+            for (int round = 0; round < 10; round++) {
+                TGraph g(false);
+                int k = 3 + round % 4;
+                for (int i = 0; i < 2 * k; i++)
+                    g.insertNode(*nodeArr[i]);
+                vector< vector<double> > w(k, vector<double>(k, 0));
+                for (int a = 0; a < k; a++)
+                    for (int b = 0; b < k; b++) {
+                        w[a][b] = rand() % 50;
+                        link(g, 2 * a, 2 * b + 1, w[a][b]);
+                    }
+                vector<int> perm(k);
+                for (int i = 0; i < k; i++)
+                    perm[i] = i;
+                double best_min = 1e300, best_max = -1e300;
+                do {
+                    double total = 0;
+                    for (int a = 0; a < k; a++)
+                        total += w[a][perm[a]];
+                    best_min = min(best_min, total);
+                    best_max = max(best_max, total);
+                } while (next_permutation(perm.begin(), perm.end()));
+
+                EvenLeft side;
+                BipartiteMatching matching(g, side);
+                ASSERT(matching.solveWeighted() == best_min, "Least weight assignment, " << matching.solveWeighted() << " vs " << best_min);
+                ASSERT(matching.getSize() == k, "Complete assignment");
+                checkMatching(g, matching);
+                ASSERT(matching.solveWeighted(true) == best_max, "Greatest weight assignment");
+                checkMatching(g, matching);
+            }
+
+            // Rectangular, both ways round: every node of the small side
+            // gets one of the large side.
+            for (int round = 0; round < 6; round++) {
+                bool few_left = round % 2 == 0;
+                int small = 2 + round / 2, large = 7;
+                int left_count = few_left ? small : large, right_count = few_left ? large : small;
+                TGraph g(false);
+                for (int a = 0; a < left_count; a++)
+                    g.insertNode(*nodeArr[2 * a]);
+                for (int b = 0; b < right_count; b++)
+                    g.insertNode(*nodeArr[2 * b + 1]);
+                vector< vector<double> > w(small, vector<double>(large, 0));
+                for (int a = 0; a < left_count; a++)
+                    for (int b = 0; b < right_count; b++) {
+                        double weight = rand() % 50;
+                        link(g, 2 * a, 2 * b + 1, weight);
+                        if (few_left)
+                            w[a][b] = weight;
+                        else
+                            w[b][a] = weight;
+                    }
+                double best_min = 1e300, best_max = -1e300;
+                vector<char> taken(large, 0);
+                bestAssignment(w, 0, 0, taken, best_min, best_max);
+
+                EvenLeft side;
+                BipartiteMatching matching(g, side);
+                ASSERT(matching.solveWeighted() == best_min, "Least weight rectangular, " << matching.solveWeighted() << " vs " << best_min);
+                ASSERT(matching.getSize() == small, "Small side matched");
+                checkMatching(g, matching);
+                ASSERT(matching.solveWeighted(true) == best_max, "Greatest weight rectangular");
+                checkMatching(g, matching);
+            }
+
+            // Missing edges: a cheap edge may not cost the cardinality.
+            TGraph g(false);
+            for (int i = 0; i < 4; i++)
+                g.insertNode(*nodeArr[i]);
+            link(g, 0, 1, 1);
+            link(g, 0, 3, 100);
+            link(g, 2, 1, 100);
+            EvenLeft side;
+            BipartiteMatching matching(g, side);
+            ASSERT(matching.solveWeighted() == 200 && matching.getSize() == 2, "Cardinality before weight");
+            cout << "testWeighted Done!" << endl;
+        }
+
+        void testNotBipartite() {
+            TGraph g(false);
+            for (int i = 0; i < 5; i++)
+                g.insertNode(*nodeArr[i]);
+            link(g, 0, 1, 1); link(g, 1, 2, 1); link(g, 2, 0, 1); link(g, 3, 4, 1);
+            BipartiteMatching matching(g);
+            ASSERT(!matching.isBipartite() && matching.solve() == 0, "Odd cycle is not bipartite");
+            ASSERT(matching.getMate(3) == -1, "Nothing matched");
+
+            TGraph empty(false);
+            BipartiteMatching none(empty);
+            ASSERT(none.isBipartite() && none.solve() == 0 && none.solveWeighted() == 0, "Empty graph");
+            cout << "testNotBipartite Done!" << endl;
+        }
+};
+
+int main() {
+    TestBipartiteMatching test;
+    test.testRandom();
+    test.testWeighted();
+    test.testNotBipartite();
+    return 0;
+}
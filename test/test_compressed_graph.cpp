@@ -0,0 +1,224 @@
+#include<iostream>
+#include "../../test/ASSERT.hpp"
+#include "node_fixture.hpp"
+#include "../graph/compressed_graph.hpp"
+#include "../graph/index_traversal.hpp"
+#include "../graph/analytics.hpp"
+
+using namespace std;
+
+class TestCompressedGraph : public NodeFixture<4096> {
+    public:
+        typedef Graph<int> TGraph;
+
+        // Neighbours from the iterator, from decodeNeighbors and from the
+        // graph itself, sorted, must all agree.
+        void checkLists(const TGraph& g, const CompressedGraph& compressed) {
+            ASSERT(compressed.getNodeCount() == g.getNodeCount(), "Node count");
+            ASSERT(compressed.getEdgeCount() == g.getEdgeCount(), "Edge count, " << compressed.getEdgeCount() << " vs " << g.getEdgeCount());
+            vector<int> buffer;
+            typename TGraph::const_iterator node = g.cbegin();
+            for (int i = 0; i < g.getNodeCount(); i++, node++) {
+                ASSERT(compressed.getNodeId(i) == node->getId() && compressed.indexOf(node->getId()) == i, "Ids follow iteration order");
+                vector<int> expected;
+                EdgeRange<const Edge> range = g.neighborsAt(i);
+                for (EdgeRange<const Edge>::iterator it = range.begin(); it != range.end(); ++it)
+                    expected.push_back(it.otherIndex());
+                sort(expected.begin(), expected.end());
+
+                vector<int> iterated;
+                CompressedGraph::Range neighbors = compressed.neighborsAt(i);
+                for (CompressedGraph::iterator it = neighbors.begin(); it != neighbors.end(); ++it)
+                    iterated.push_back(*it);
+                ASSERT(iterated == expected, "Iterator should give sorted neighbours of " << i);
+
+                ASSERT(compressed.getOutDegreeAt(i) == (int)expected.size(), "Degree of " << i);
+                buffer.assign(expected.size() + 1, -1);
+                int count = compressed.decodeNeighbors(i, buffer.data());
+                buffer.resize(count);
+                ASSERT(buffer == expected, "Decoded neighbours of " << i);
+            }
+        }
+
+        void testRandom() {
+            for (int round = 0; round < 4; round++) {
+                TGraph g(round % 2 == 0);
+                g.createRandomGraph(300, nodeArr, 0.05);
+                CompressedGraph compressed(g);
+                ASSERT(compressed.isDirected() == g.isDirected(), "Direction kept");
+                checkLists(g, compressed);
+
+                TGraph::Workspace ws;
+                vector<int> dist;
+                compressed.breadthFirstSearch(0, dist);
+                g.breadthFirstSearch(ws, *g.cbegin());
+                for (int i = 0; i < g.getNodeCount(); i++)
+                    ASSERT(dist[i] == ws.getDist2Source(i), "BFS distance of " << i);
+            }
+            cout << "testRandom Done!" << endl;
+        }
+
+        // Hub linked to everything: gaps of one in long runs take the 8 at
+        // a time path, the far neighbours need multi byte gaps and a
+        // negative first difference.
+        void testGaps() {
+            TGraph g(true);
+            for (int i = 0; i < 4096; i++)
+                g.insertNode(*nodeArr[i]);
+            for (int i = 0; i < 4095; i++)
+                link(g, 4095, i);
+            link(g, 0, 4095);
+            link(g, 0, 1);
+            link(g, 0, 300);
+            link(g, 0, 2000);
+            link(g, 100, 3);
+            CompressedGraph compressed(g);
+            checkLists(g, compressed);
+            // One degree byte per node, one byte per unit gap of the hub.
+            ASSERT(compressed.getEncodedSize() < 2 * 4096 + 32, "Unit gaps take one byte, size:" << compressed.getEncodedSize());
+            cout << "testGaps Done!" << endl;
+        }
+
+        void testGrid() {
+            TGraph g(false);
+            int side = 64;
+            for (int i = 0; i < side * side; i++)
+                g.insertNode(*nodeArr[i]);
+            for (int r = 0; r < side; r++)
+                for (int c = 0; c < side; c++) {
+                    if (c + 1 < side)
+                        link(g, r * side + c, r * side + c + 1);
+                    if (r + 1 < side)
+                        link(g, r * side + c, (r + 1) * side + c);
+                }
+            CompressedGraph compressed(g);
+            checkLists(g, compressed);
+            double per_edge = (double)compressed.getEncodedSize() / (2 * g.getEdgeCount());
+            ASSERT(per_edge < 2.5, "Grid should take under 2.5 bytes per edge direction, got:" << per_edge);
+
+            TGraph empty(false);
+            CompressedGraph none(empty);
+            ASSERT(none.getNodeCount() == 0 && none.getEncodedSize() == 0, "Empty graph");
+            cout << "testGrid Done!" << endl;
+        }
+
+        // Sorted edge list of g with ids in iteration order, both
+        // directions of undirected edges.
+        void encodeEdges(const TGraph& g, CompressedGraph& compressed) {
+            vector<int> ids;
+            vector< pair<int, int> > edges;
+            typename TGraph::const_iterator node = g.cbegin();
+            for (int i = 0; i < g.getNodeCount(); i++, node++) {
+                ids.push_back(node->getId());
+                EdgeRange<const Edge> range = g.neighborsAt(i);
+                for (EdgeRange<const Edge>::iterator it = range.begin(); it != range.end(); ++it)
+                    edges.push_back(make_pair(i, it.otherIndex()));
+            }
+            sort(edges.begin(), edges.end());
+            CompressedGraph::Builder builder(g.isDirected(), ids);
+            for (size_t k = 0; k < edges.size(); k++)
+                ASSERT(builder.addEdge(edges[k].first, edges[k].second), "Sorted edge " << k << " accepted");
+            builder.build(compressed);
+        }
+
+        void testBuilder() {
+            for (int round = 0; round < 2; round++) {
+                TGraph g(round == 0);
+                g.createRandomGraph(300, nodeArr, 0.05);
+                // Trailing nodes without edges.
+                g.insertNode(*nodeArr[300]);
+                g.insertNode(*nodeArr[301]);
+                CompressedGraph compressed;
+                encodeEdges(g, compressed);
+                ASSERT(compressed.isDirected() == g.isDirected(), "Direction kept");
+                checkLists(g, compressed);
+                CompressedGraph copied(g);
+                ASSERT(compressed.getEncodedSize() == copied.getEncodedSize(), "Same encoding as from the graph");
+            }
+
+            CompressedGraph::Builder builder(true, 4);
+            ASSERT(builder.addEdge(1, 2) && builder.addEdge(1, 2) && builder.addEdge(1, 3), "Parallel edges allowed");
+            ASSERT(!builder.addEdge(1, 0), "Target out of order");
+            ASSERT(!builder.addEdge(0, 3), "Source out of order");
+            ASSERT(!builder.addEdge(2, 4) && !builder.addEdge(4, 0) && !builder.addEdge(2, -1), "Index out of range");
+            ASSERT(builder.addEdge(3, 0), "Next source");
+            CompressedGraph small;
+            builder.build(small);
+            ASSERT(small.getNodeCount() == 4 && small.getEdgeCount() == 4 && small.indexOf(3) == 3, "Ids are indices by default");
+            ASSERT(small.getOutDegreeAt(0) == 0 && small.getOutDegreeAt(1) == 3 && small.getOutDegreeAt(2) == 0, "Lists by source");
+            ASSERT(*small.neighborsAt(3).begin() == 0, "Negative first difference");
+            cout << "testBuilder Done!" << endl;
+        }
+
+        // Index traversals on the graph match its own workspace traversals,
+        // and on the compressed copy they find the same distances and
+        // components.
+        void testIndexTraversal() {
+            for (int round = 0; round < 2; round++) {
+                TGraph g(round == 0);
+                g.createRandomGraph(400, nodeArr, 0.004);
+                CompressedGraph compressed(g);
+                TGraph::Workspace own, onGraph, onCompressed;
+
+                g.breadthFirstSearch(own, *g.cbegin());
+                IndexTraversal::breadthFirstSearch(g, onGraph, 0);
+                IndexTraversal::breadthFirstSearch(compressed, onCompressed, 0);
+                for (int i = 0; i < g.getNodeCount(); i++) {
+                    ASSERT(onGraph.getDist2Source(i) == own.getDist2Source(i), "BFS distance of " << i);
+                    ASSERT(onCompressed.getDist2Source(i) == own.getDist2Source(i), "Compressed BFS distance of " << i);
+                    int parent = onCompressed.getParent(i);
+                    ASSERT(parent == -1 || onCompressed.getDist2Source(parent) + 1 == onCompressed.getDist2Source(i), "BFS parent of " << i);
+                }
+
+                g.depthFirstSearch(own);
+                IndexTraversal::depthFirstSearch(g, onGraph);
+                IndexTraversal::depthFirstSearch(compressed, onCompressed);
+                for (int i = 0; i < g.getNodeCount(); i++) {
+                    ASSERT(onGraph.getEntryTime(i) == own.getEntryTime(i) && onGraph.getExitTime(i) == own.getExitTime(i)
+                           && onGraph.getComponentId(i) == own.getComponentId(i) && onGraph.getParent(i) == own.getParent(i),
+                           "Same DFS as the graph's at " << i);
+                    ASSERT(onCompressed.getColor(i) == TGraph::Workspace::BLACK
+                           && onCompressed.getEntryTime(i) < onCompressed.getExitTime(i), "Compressed DFS finished " << i);
+                    if (!g.isDirected())
+                        ASSERT(onCompressed.getComponentId(i) == own.getComponentId(i), "Compressed DFS component of " << i);
+                }
+            }
+            cout << "testIndexTraversal Done!" << endl;
+        }
+
+        void testAnalytics() {
+            for (int round = 0; round < 2; round++) {
+                TGraph g(round == 0);
+                g.createRandomGraph(300, nodeArr, 0.03);
+                CompressedGraph compressed;
+                encodeEdges(g, compressed);
+
+                vector<double> want, got;
+                Analytics::pageRank(g, want);
+                Analytics::pageRank(compressed, got);
+                for (int i = 0; i < g.getNodeCount(); i++)
+                    ASSERT(fabs(want[i] - got[i]) < 1e-9, "Rank of " << i);
+                ASSERT(Analytics::countTriangles(g) == Analytics::countTriangles(compressed), "Triangles");
+                Analytics::betweennessCentrality(g, want);
+                Analytics::betweennessCentrality(compressed, got);
+                for (int i = 0; i < g.getNodeCount(); i++)
+                    ASSERT(fabs(want[i] - got[i]) < 1e-6, "Betweenness of " << i);
+                vector<int> core, compressedCore;
+                Analytics::coreNumbers(g, core);
+                Analytics::coreNumbers(compressed, compressedCore);
+                ASSERT(core == compressedCore, "Core numbers");
+            }
+            cout << "testAnalytics Done!" << endl;
+        }
+};
+
+int main() {
+    TestCompressedGraph test;
+    test.testRandom();
+    test.testGaps();
+    test.testGrid();
+    test.testBuilder();
+    test.testIndexTraversal();
+    test.testAnalytics();
+    return 0;
+}
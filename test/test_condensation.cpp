@@ -0,0 +1,121 @@
+#include<iostream>
+#include "../../test/ASSERT.hpp"
+#include "node_fixture.hpp"
+#include "../graph/condensation.hpp"
+
+using namespace std;
+
+class TestCondensation : public NodeFixture<200> {
+    public:
+        typedef Graph<int> TGraph;
+
+        int component(const TGraph& g, const Condensation& cond, int i) {
+            return cond.getComponentId(g.indexOf(nodeArr[i]->getId()));
+        }
+
+        // Multiplicity of DAG edge from -> to, 0 if there is none.
+        int multiplicity(const Condensation& cond, int from, int to) {
+            for (const int* it = cond.successorsBegin(from); it != cond.successorsEnd(from); it++)
+                if (*it == to)
+                    return cond.getMultiplicity(cond.getEdgeOffset(from) + (it - cond.successorsBegin(from)));
+            return 0;
+        }
+
+        // Cycles {0,1,2} and {3,4}, node 5 alone, node 6 unconnected.
+        // Two edges from the first cycle into the second.
+        void testSmall() {
+            TGraph g(true);
+            for (int i = 0; i < 7; i++)
+                g.insertNode(*nodeArr[i]);
+            link(g, 0, 1); link(g, 1, 2); link(g, 2, 0);
+            link(g, 3, 4); link(g, 4, 3);
+            link(g, 0, 3); link(g, 2, 4);
+            link(g, 4, 5); link(g, 1, 5);
+
+            Condensation cond(g);
+            ASSERT(cond.getNodeCount() == 7 && cond.getComponentCount() == 4, "Four components, got:" << cond.getComponentCount());
+            int a = component(g, cond, 0), b = component(g, cond, 3), c = component(g, cond, 5), d = component(g, cond, 6);
+            ASSERT(component(g, cond, 1) == a && component(g, cond, 2) == a, "Cycle is one component");
+            ASSERT(component(g, cond, 4) == b, "Two cycle is one component");
+            ASSERT(cond.getComponentSize(a) == 3 && cond.getComponentSize(b) == 2 && cond.getComponentSize(c) == 1, "Component sizes");
+            for (const int* it = cond.membersBegin(a); it != cond.membersEnd(a); it++)
+                ASSERT(cond.getComponentId(*it) == a, "Members belong to their component");
+
+            ASSERT(cond.getDagEdgeCount() == 3, "Parallel edges merged, got:" << cond.getDagEdgeCount());
+            ASSERT(multiplicity(cond, a, b) == 2, "Two edges a -> b");
+            ASSERT(multiplicity(cond, a, c) == 1 && multiplicity(cond, b, c) == 1, "One edge into c each");
+            ASSERT(cond.getInDegree(c) == 2 && cond.getOutDegree(a) == 2 && cond.getInDegree(a) == 0, "DAG degrees");
+
+            ASSERT(cond.getLevelCount() == 3, "Longest path has three levels");
+            ASSERT(cond.getLevel(a) == 0 && cond.getLevel(d) == 0, "Sources on level 0");
+            ASSERT(cond.getLevel(b) == 1 && cond.getLevel(c) == 2, "Longest incoming path decides level");
+            ASSERT(cond.getLevelStart(0) == 0 && cond.getLevelEnd(0) == 2 && cond.getLevelEnd(2) == 4, "Levels are id ranges");
+            cout << "testSmall Done!" << endl;
+        }
+
+        void testRandom() {
+            for (int round = 0; round < 5; round++) {
+                TGraph g(true);
+                g.createRandomGraph(100, nodeArr, 0.015);
+                Condensation cond(g);
+                int n = g.getNodeCount();
+
+                // Same component exactly when mutually reachable.
+                vector< vector<int> > dist(n);
+                TGraph::Workspace ws;
+                for (int i = 0; i < n; i++) {
+                    dist[i].assign(n, -1);
+                    g.breadthFirstSearch(ws, *(g.cbegin() + i));
+                    for (int j = 0; j < n; j++)
+                        dist[i][j] = ws.getDist2Source(j);
+                }
+                for (int i = 0; i < n; i++)
+                    for (int j = 0; j < n; j++) {
+                        bool mutual = dist[i][j] != -1 && dist[j][i] != -1;
+                        ASSERT(mutual == (cond.getComponentId(i) == cond.getComponentId(j)), "Components should match reachability");
+                    }
+
+                int members = 0, edges = 0;
+                for (int c = 0; c < cond.getComponentCount(); c++) {
+                    members += cond.getComponentSize(c);
+                    for (int pos = cond.getEdgeOffset(c); pos < cond.getEdgeOffset(c) + cond.getOutDegree(c); pos++)
+                        edges += cond.getMultiplicity(pos);
+                    for (const int* it = cond.successorsBegin(c); it != cond.successorsEnd(c); it++)
+                        ASSERT(*it > c && cond.getLevel(*it) > cond.getLevel(c), "Ids and levels are topological");
+                    ASSERT(cond.getLevel(c) == 0 || cond.getInDegree(c) > 0, "Only sources on level 0");
+                }
+                int cross = 0;
+                for (int i = 0; i < n; i++) {
+                    EdgeRange<Edge> range = g.neighborsAt(i);
+                    for (EdgeRange<Edge>::iterator it = range.begin(); it != range.end(); ++it)
+                        cross += cond.getComponentId(i) != cond.getComponentId(it.otherIndex());
+                }
+                ASSERT(members == n, "Every node in one component");
+                ASSERT(edges == cross, "Multiplicities count cross edges, " << edges << " vs " << cross);
+            }
+            cout << "testRandom Done!" << endl;
+        }
+
+        void testUndirected() {
+            TGraph g(false);
+            for (int i = 0; i < 6; i++)
+                g.insertNode(*nodeArr[i]);
+            link(g, 0, 1); link(g, 1, 2); link(g, 3, 4);
+            Condensation cond(g);
+            ASSERT(cond.getComponentCount() == 3, "Connected components, got:" << cond.getComponentCount());
+            ASSERT(cond.getDagEdgeCount() == 0 && cond.getLevelCount() == 1, "No edges between components");
+
+            TGraph empty(true);
+            Condensation none(empty);
+            ASSERT(none.getComponentCount() == 0 && none.getLevelCount() == 0, "Empty graph has no components");
+            cout << "testUndirected Done!" << endl;
+        }
+};
+
+int main() {
+    TestCondensation test;
+    test.testSmall();
+    test.testRandom();
+    test.testUndirected();
+    return 0;
+}
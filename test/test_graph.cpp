@@ -28,6 +28,21 @@ class TBFSGraph : public GraphBase<TBFSNode, Edge > {
         TBFSGraph(bool is_directed) :
             GraphBase(is_directed) {};
         TBFSGraph():GraphBase() {};
+        // The protected routine as subclasses call it.
+        void explore(TBFSNode& node, int component_id) {
+            reset();
+            depthFirstRoutine(node, component_id);
+        }
+        int componentOf(int id) { return state.getComponentId(indexOf(id));}
+};
+
+class CountingVisitor : public GraphVisitor<Node<int>, Edge> {
+    public:
+        int grey, black, edges;
+        CountingVisitor() : grey(0), black(0), edges(0) {}
+        void processOnGrey(const Node<int>&) { grey++;}
+        void processOnBlack(const Node<int>&) { black++;}
+        void processEdge(const Edge*, Edge::EDGE_TYPE) { edges++;}
 };
 
 class TestGraph {
@@ -121,6 +136,395 @@ class TestGraph {
             cout << "testCreateDirectedEdge Done!"<<endl;
         }
 
+        void testGetNodeByLabel() {
+            TGraph g(true);
+            int vals[20];
+            Node<int>* nodeArr[20];
+            for (int i = 0; i < 20; i++) {
+                vals[i] = i;
+                nodeArr[i] = new Node<int>(vals[i], "label" + to_string(i));
+                g.insertNode(*nodeArr[i]);
+            }
+            for (int i = 0; i < 19; i++)
+                g.createEdge(*nodeArr[i + 1], *nodeArr[i]);
+
+            for (int i = 0; i < 20; i++)
+                ASSERT(g.getNodeByLabel("label" + to_string(i)).getId() == nodeArr[i]->getId(), "Lookup should find labelled node i:" << i);
+            ASSERT(g.indexOfLabel("missing") == -1, "Unknown label should not be found");
+            ASSERT(g.indexOfLabel("") == -1, "Default label is not indexed");
+
+            // Reordering nodes keeps the index in step.
+            g.topsort();
+            TGraph copy(g);
+            for (int i = 0; i < 20; i++) {
+                string label = "label" + to_string(i);
+                ASSERT(g.getNodeByLabel(label).getId() == nodeArr[i]->getId(), "Lookup should survive topsort i:" << i);
+                ASSERT(&copy.getNodeByLabel(label) != &g.getNodeByLabel(label), "Copy should have its own index");
+                ASSERT(copy.getNodeByLabel(label).getLabel() == label, "Copy should share the interned label");
+            }
+
+            // Nodes in the graph keep the label after the original is gone.
+            int val = 20;
+            Node<int>* transient = new Node<int>(val, "transient");
+            g.insertNode(*transient);
+            int id = transient->getId();
+            delete transient;
+            ASSERT(g.getNodeByLabel("transient").getId() == id, "Label outlives the inserted node");
+
+            cout << "testGetNodeByLabel Done!" << endl;
+        }
+
+        void testNeighbors() {
+            TGraph g(true);
+            Node<int>* nodeArr[30];
+
+            for (int i = 0; i < 30; i++) {
+                nodeArr[i] = new Node<int>(i);
+                nodeArr[i]->populateNode(true);
+            }
+            g.createRandomGraph(30, nodeArr, 0.2);
+            const TGraph& cg = g;
+
+            for (int i = 0; i < 30; i++) {
+                vector<Edge> copied = g.getOutEdgesForNode(*nodeArr[i]);
+                EdgeRange<const Edge> range = cg.neighbors(*nodeArr[i]);
+                ASSERT(range.size() == (int)copied.size(), "Range size should be out degree");
+
+                size_t j = 0;
+                for (EdgeRange<const Edge>::iterator it = range.begin(); it != range.end(); ++it, j++) {
+                    ASSERT(j < copied.size() && it->getOtherNodeId() == copied[j].getOtherNodeId(), "Range should walk edges in list order");
+                    ASSERT((cg.cbegin() + it.otherIndex())->getId() == it->getOtherNodeId(), "Cached index should match other end");
+                }
+                ASSERT(j == copied.size(), "Range should end with edge list");
+            }
+
+            int val = 5;
+            Node<int> stranger(val);
+            ASSERT(g.neighbors(stranger).empty(), "Node not in graph has no neighbors");
+            ASSERT(g.getOutEdgesForNode(stranger).empty(), "Node not in graph has no out edges");
+
+            cout << "testNeighbors Done!" << endl;
+        }
+
+        // Degrees, cached indices and counts should agree with edge lists.
+        void checkStructure(TGraph& g) {
+            int halves = 0;
+            vector<int> in(g.getNodeCount(), 0);
+            map< pair<int, int>, int > undirected;
+            for (int i = 0; i < g.getNodeCount(); i++) {
+                ASSERT(g.indexOf((g.begin() + i)->getId()) == i, "Index map out of step i:" << i);
+                EdgeRange<Edge> range = g.neighborsAt(i);
+                int out = 0;
+                for (EdgeRange<Edge>::iterator it = range.begin(); it != range.end(); ++it, out++) {
+                    ASSERT((g.begin() + it.otherIndex())->getId() == it->getOtherNodeId(), "Stale cached index");
+                    in[it.otherIndex()]++;
+                    undirected[make_pair(min(i, it.otherIndex()), max(i, it.otherIndex()))]++;
+                }
+                halves += out;
+                ASSERT(out == range.size() && out == g.getOutDegreeAt(i), "Out degree should match list i:" << i);
+            }
+            for (int i = 0; i < g.getNodeCount(); i++)
+                ASSERT(in[i] == g.getInDegreeAt(i), "In degree should match edges into node i:" << i);
+            if (!g.isDirected()) {
+                for (map< pair<int, int>, int >::iterator it = undirected.begin(); it != undirected.end(); it++)
+                    ASSERT(it->second % 2 == 0, "Undirected edge should have both halves");
+            }
+            ASSERT(halves == (g.isDirected() ? 1 : 2) * g.getEdgeCount(), "Edge count should match lists");
+        }
+
+        void testRemoveEdge() {
+            for (int d = 0; d < 2; d++) {
+                TGraph g(d == 1);
+                Node<int>* nodeArr[40];
+                for (int i = 0; i < 40; i++) {
+                    nodeArr[i] = new Node<int>(i);
+                    nodeArr[i]->populateNode(true);
+                }
+                g.createRandomGraph(40, nodeArr, 0.2);
+                int edges = g.getEdgeCount();
+
+                // Middle of the list, the case deleteEdge used to get wrong.
+                for (int i = 0; i < 40; i++) {
+                    EdgeRange<Edge> range = g.neighbors(*nodeArr[i]);
+                    if (range.size() < 3)
+                        continue;
+                    EdgeRange<Edge>::iterator it = range.begin();
+                    ++it;
+                    int other = it->getOtherNodeId();
+                    ASSERT(g.removeEdge(*it), "Linked edge is removed");
+                    edges--;
+                    ASSERT(g.getEdgeCount() == edges, "Edge count should drop by one");
+                    ASSERT(g.getOutEdgesForNode(*nodeArr[i]).size() == range.size() - 1, "Only one edge should go");
+                    for (const Edge& edge : g.neighbors(*nodeArr[i]))
+                        ASSERT(edge.getOtherNodeId() != other || g.isDirected() == false, "Removed edge still listed");
+                }
+                checkStructure(g);
+
+                // Copies are not linked into the graph.
+                for (int i = 0; i < 40; i++) {
+                    vector<Edge> copies = g.getOutEdgesForNode(*nodeArr[i]);
+                    if (!copies.empty())
+                        ASSERT(!g.removeEdge(copies[0]), "Copy of an edge is not removed");
+                }
+                ASSERT(g.getEdgeCount() == edges, "Edge count unchanged by copies");
+                checkStructure(g);
+
+                // Edges of a copy have the same node ids but other lists.
+                TGraph clone(g);
+                for (int i = 0; i < 40; i++) {
+                    EdgeRange<Edge> range = clone.neighbors(*nodeArr[i]);
+                    if (range.size() < 2)
+                        continue;
+                    EdgeRange<Edge>::iterator it = range.begin();
+                    ++it;
+                    ASSERT(!g.removeEdge(*it), "Edge of a copy is not removed");
+                }
+                ASSERT(g.getEdgeCount() == edges && clone.getEdgeCount() == edges, "Both graphs unchanged");
+                ASSERT(g == clone, "Graphs still equal");
+                checkStructure(g);
+                checkStructure(clone);
+
+                ASSERT(!g.removeEdge(*nodeArr[0], *nodeArr[0]), "No self loops to remove");
+                for (int i = 0; i < 40; i++)
+                    for (int j = 0; j < 40; j++)
+                        while (g.removeEdge(*nodeArr[i], *nodeArr[j]));
+                ASSERT(g.getEdgeCount() == 0, "All edges should be removed");
+                checkStructure(g);
+            }
+            cout << "testRemoveEdge Done!" << endl;
+        }
+
+        void testRemoveEdges() {
+            for (int d = 0; d < 2; d++) {
+                TGraph g(d == 1);
+                Node<int>* nodeArr[40];
+                for (int i = 0; i < 40; i++) {
+                    nodeArr[i] = new Node<int>(i);
+                    nodeArr[i]->populateNode(true);
+                }
+                g.createRandomGraph(40, nodeArr, 0.2);
+
+                vector< pair<int, int> > batch;
+                for (int i = 0; i < 40; i++) {
+                    for (const Edge& edge : g.neighbors(*nodeArr[i]))
+                        if (rand() % 2)
+                            batch.push_back(make_pair(edge.getCurrentNodeId(), edge.getOtherNodeId()));
+                }
+                batch.push_back(make_pair(-1, nodeArr[0]->getId()));
+
+                TGraph expected(g);
+                for (size_t i = 0; i < batch.size(); i++)
+                    if (batch[i].first != -1)
+                        expected.removeEdge(expected.getNodeById(batch[i].first), expected.getNodeById(batch[i].second));
+
+                int before = g.getEdgeCount();
+                int removed = g.removeEdges(batch);
+                ASSERT(g.getEdgeCount() == before - removed, "Count should drop by removed edges");
+                ASSERT(g == expected, "Batch should match one by one removal");
+                checkStructure(g);
+            }
+            cout << "testRemoveEdges Done!" << endl;
+        }
+
+        void testRemoveNode() {
+            for (int d = 0; d < 2; d++) {
+                TGraph g(d == 1);
+                Node<int>* nodeArr[40];
+                for (int i = 0; i < 40; i++) {
+                    nodeArr[i] = new Node<int>(i);
+                    nodeArr[i]->populateNode(true);
+                }
+                g.createRandomGraph(40, nodeArr, 0.2);
+
+                for (int i = 0; i < 40; i += 3) {
+                    int edges = g.getEdgeCount();
+                    int incident = g.getOutDegreeForNode(*nodeArr[i]) + (g.isDirected() ? g.getInDegreeForNode(*nodeArr[i]) : 0);
+                    ASSERT(g.removeNode(*nodeArr[i]), "Node should be removed");
+                    ASSERT(!g.containsNode(*nodeArr[i]), "Removed node should be gone");
+                    ASSERT(g.getEdgeCount() == edges - incident, "Incident edges should go with node");
+                    checkStructure(g);
+                }
+                ASSERT(!g.removeNode(*nodeArr[0]), "Removing twice should fail");
+                ASSERT(g.getNodeByLabel(nodeArr[1]->getLabel()).getId() == nodeArr[1]->getId() ||
+                       g.indexOfLabel(nodeArr[1]->getLabel()) != -1, "Label index should follow moved nodes");
+
+                TGraph::Workspace ws;
+                g.breadthFirstSearch(ws, *nodeArr[1]);
+                g.depthFirstSearch(ws);
+            }
+
+            // Self loop on the node moved into the freed slot.
+            TGraph g(false);
+            Node<int>* loopArr[3];
+            for (int i = 0; i < 3; i++) {
+                loopArr[i] = new Node<int>(i);
+                g.insertNode(*loopArr[i]);
+            }
+            g.createEdge(*loopArr[2], *loopArr[2]);
+            g.createEdge(*loopArr[2], *loopArr[1]);
+            ASSERT(g.removeNode(*loopArr[0]), "Node should be removed");
+            int moved = g.indexOf(loopArr[2]->getId());
+            for (EdgeRange<Edge>::iterator it = g.neighborsAt(moved).begin(); it != g.neighborsAt(moved).end(); ++it)
+                ASSERT(it.otherIndex() == moved || it.otherIndex() == g.indexOf(loopArr[1]->getId()), "Indices follow the moved node");
+            cout << "testRemoveNode Done!" << endl;
+        }
+
+        void testCopyAndMove() {
+            for (int d = 0; d < 2; d++) {
+                TGraph g(d == 1);
+                Node<int>* nodeArr[40];
+                for (int i = 0; i < 40; i++) {
+                    nodeArr[i] = new Node<int>(i);
+                    nodeArr[i]->populateNode(true);
+                }
+                g.createRandomGraph(40, nodeArr, 0.2, true);
+
+                TGraph copy(g);
+                ASSERT(copy == g && copy.getEdgeCount() == g.getEdgeCount(), "Copy should equal original");
+                checkStructure(copy);
+                ASSERT(copy.getNodeByLabel(nodeArr[3]->getLabel()).getId() == nodeArr[3]->getId(), "Label index copied");
+
+                // Copies share nothing.
+                copy.removeNode(*nodeArr[0]);
+                checkStructure(copy);
+                checkStructure(g);
+                ASSERT(g.containsNode(*nodeArr[0]), "Original keeps its nodes");
+
+                // Assignment replaces what was there.
+                TGraph other(d == 1);
+                int val = 7;
+                Node<int> extra(val);
+                other.insertNode(extra);
+                other = g;
+                ASSERT(!other.containsNode(extra) && other == g, "Assignment should drop old contents");
+                checkStructure(other);
+
+                int edges = g.getEdgeCount();
+                TGraph moved(std::move(g));
+                ASSERT(moved.getEdgeCount() == edges && g.getNodeCount() == 0 && g.getEdgeCount() == 0, "Move should take everything");
+                checkStructure(moved);
+
+                vector<TGraph> graphs;
+                graphs.push_back(std::move(moved));
+                other = std::move(graphs[0]);
+                ASSERT(other.getEdgeCount() == edges, "Move assignment should take everything");
+                checkStructure(other);
+            }
+            cout << "testCopyAndMove Done!" << endl;
+        }
+
+        void testFingerprint() {
+            for (int d = 0; d < 2; d++) {
+                Node<int>* nodeArr[30];
+                for (int i = 0; i < 30; i++) {
+                    nodeArr[i] = new Node<int>(i);
+                    nodeArr[i]->populateNode(true);
+                }
+                TGraph g(d == 1);
+                g.createRandomGraph(30, nodeArr, 0.2, true);
+                ASSERT(g.getFingerprint() == g.computeFingerprint(), "Fingerprint should track inserts");
+
+                // Same graph built in reverse order.
+                TGraph h(d == 1);
+                for (int i = 29; i >= 0; i--)
+                    h.insertNode(*nodeArr[i]);
+                for (int i = 29; i >= 0; i--) {
+                    vector<Edge> edges = g.getOutEdgesForNode(*nodeArr[i]);
+                    for (int j = edges.size() - 1; j >= 0; j--)
+                        h.createEdge(h.getNodeById(edges[j].getCurrentNodeId()),
+                                     h.getNodeById(edges[j].getOtherNodeId()),
+                                     edges[j].getWeight());
+                }
+                ASSERT(g.getFingerprint() == h.getFingerprint(), "Fingerprint should not depend on order");
+                ASSERT(g == h && h == g, "Graphs built in different order should be equal");
+
+                EdgeRange<Edge> range = h.neighbors(*nodeArr[0]);
+                while (range.empty()) {
+                    h.createEdge(*nodeArr[0], *nodeArr[1], 3.0);
+                    range = h.neighbors(*nodeArr[0]);
+                }
+                int other = range.begin()->getOtherNodeId();
+                float weight = range.begin()->getWeight();
+                h.removeEdge(*range.begin());
+                ASSERT(h.getFingerprint() == h.computeFingerprint(), "Fingerprint should track removals");
+                ASSERT(!(g == h), "Graphs differ by an edge");
+                h.createEdge(*nodeArr[0], h.getNodeById(other), weight + 1);
+                ASSERT(!(g == h), "Graphs differ by a weight");
+
+                h.removeNode(*nodeArr[5]);
+                ASSERT(h.getFingerprint() == h.computeFingerprint(), "Fingerprint should track node removal");
+
+                uint64_t before = g.getFingerprint();
+                g.transpose();
+                ASSERT(g.getFingerprint() == g.computeFingerprint(), "Fingerprint should follow transpose");
+                g.transpose();
+                ASSERT(g.getFingerprint() == before, "Transposing twice restores fingerprint");
+            }
+
+            // Both orders of the same two edges, which the old
+            // comparison got wrong.
+            int vals[3] = {0, 1, 2};
+            Node<int>* n[3];
+            for (int i = 0; i < 3; i++)
+                n[i] = new Node<int>(vals[i]);
+            TGraph a(true), b(true);
+            for (int i = 0; i < 3; i++) {
+                a.insertNode(*n[i]);
+                b.insertNode(*n[i]);
+            }
+            a.createEdge(*n[0], *n[1]);
+            a.createEdge(*n[0], *n[2]);
+            b.createEdge(*n[0], *n[2]);
+            b.createEdge(*n[0], *n[1]);
+            ASSERT(a == b, "Edge order should not matter");
+            cout << "testFingerprint Done!" << endl;
+        }
+
+        void testReorder() {
+            TGraph::ORDER strategies[4] = {TGraph::RCM, TGraph::DEGREE, TGraph::HUB, TGraph::GORDER};
+            for (int d = 0; d < 2; d++) {
+                for (int s = 0; s < 4; s++) {
+                    TGraph g(d == 1);
+                    Node<int>* nodeArr[60];
+                    for (int i = 0; i < 60; i++) {
+                        nodeArr[i] = new Node<int>(i);
+                        nodeArr[i]->populateNode(true);
+                    }
+                    g.createRandomGraph(60, nodeArr, 0.05, true);
+                    TGraph before(g);
+                    g.reorder(strategies[s]);
+                    ASSERT(g == before && g.getFingerprint() == before.getFingerprint(), "Reorder should keep the graph, strategy:" << s);
+                    checkStructure(g);
+                    for (int i = 0; i < 60; i++)
+                        ASSERT(g.getNodeByLabel(nodeArr[i]->getLabel()).getId() == nodeArr[i]->getId(), "Labels follow nodes");
+
+                    if (strategies[s] == TGraph::DEGREE) {
+                        for (int i = 0; i + 1 < 60; i++)
+                            ASSERT(g.getInDegreeAt(i) + (d ? g.getOutDegreeAt(i) : 0) >=
+                                   g.getInDegreeAt(i + 1) + (d ? g.getOutDegreeAt(i + 1) : 0), "Degrees should not increase");
+                    }
+                }
+            }
+
+            // Path inserted in shuffled order, RCM lays it out in a line.
+            int vals[50];
+            Node<int>* path[50];
+            TGraph g(false);
+            for (int i = 0; i < 50; i++) {
+                vals[i] = i;
+                path[i] = new Node<int>(vals[i]);
+            }
+            for (int i = 0; i < 50; i++)
+                g.insertNode(*path[(i * 17) % 50]);
+            for (int i = 0; i + 1 < 50; i++)
+                g.createEdge(*path[i], *path[i + 1]);
+            g.reorder(TGraph::RCM);
+            for (int i = 0; i < 50; i++)
+                for (const Edge& edge : g.neighborsAt(i))
+                    ASSERT(abs(g.indexOf(edge.getOtherNodeId()) - i) == 1, "Path should have bandwidth 1");
+            cout << "testReorder Done!" << endl;
+        }
+
         void testRandomGraph() {
         }
 
@@ -163,9 +567,8 @@ class TestGraph {
 
             g->createRandomGraph(100, nodeArr);
             g->topsort();
-            TGraph::iterator it;
-            for (it = g->begin(); it != g->end() - 1; it++) {
-                ASSERT(TGraph::compareExitTimeInc(*it, *(it + 1)), "Top sort should sort in inc order of exit time");
+            for (int i = 0; i < g->getNodeCount() - 1; i++) {
+                ASSERT(g->state.getExitTime(i) < g->state.getExitTime(i + 1), "Top sort should sort in inc order of exit time");
             }
 
             cout << "testTopsort Done!" << endl;
@@ -193,7 +596,177 @@ class TestGraph {
             cout << "testBFS Done!"<< endl;
         }
 
+        // Nodes inserted after the last traversal are past the end of
+        // the state it sized.
         void testDFS() {
+            TBFSGraph g(true);
+            TBFSNode* nodeArr[60];
+            for (int i = 0; i < 60; i++)
+                nodeArr[i] = new TBFSNode(i);
+            for (int i = 0; i < 3; i++)
+                g.insertNode(*nodeArr[i]);
+            g.breadthFirstSearch(*nodeArr[0]);
+
+            for (int i = 3; i < 60; i++) {
+                g.insertNode(*nodeArr[i]);
+                g.createEdge(g.getNodeById(nodeArr[i - 1]->getId()), g.getNodeById(nodeArr[i]->getId()));
+            }
+            g.explore(g.getNodeById(nodeArr[3]->getId()), 7);
+            for (int i = 0; i < 60; i++) {
+                ASSERT(i < 3 || g.getNodeById(nodeArr[i]->getId()).inTree(), "Chain from 3 on is visited i:" << i);
+                ASSERT(g.componentOf(nodeArr[i]->getId()) == (i >= 3 ? 7 : -1), "Component of i:" << i);
+            }
+            cout << "testDFS Done!" << endl;
+        }
+
+        void testTraversalStats() {
+            TGraph g;
+            Node<int>* nodeArr[50];
+
+            for (int i = 0; i < 50; i++) {
+                nodeArr[i] = new Node<int>(i);
+                nodeArr[i]->populateNode(true);
+            }
+            g.createRandomGraph(50, nodeArr, 0.2, false, true);
+
+            TraversalStats stats;
+            g.breadthFirstSearch(*nodeArr[0], stats);
+
+            long reached = 0;
+            for (size_t i = 0; i < stats.getFrontierSizes().size(); i++)
+                reached += stats.getFrontierSizes()[i];
+            ASSERT(stats.getEdgesScanned() == 2 * g.getEdgeCount(), "Every edge should be scanned from both ends, scanned:" << stats.getEdgesScanned());
+            ASSERT(stats.getIdLookups() == 1, "Only the source should be looked up by id, lookups:" << stats.getIdLookups());
+            ASSERT(reached == g.getNodeCount(), "Frontiers should cover connected graph, reached:" << reached);
+            ASSERT(stats.getFrontierSizes()[0] == 1, "Level 0 holds only the source");
+            ASSERT(stats.getPeakDepth() > 0, "Queue should have been used");
+            ASSERT(stats.getAllocations() > 0, "Queue allocations should be counted");
+            ASSERT(stats.getPhases().size() == 1 && stats.getPhases()[0].first == "bfs", "BFS phase should be timed");
+
+            g.reset();
+            stats.reset();
+            TGraph::ComponentGraph comp_graph = g.stronglyConnectedComponents(stats);
+            ASSERT(stats.getPhases().back().first == "scc", "Outermost phase finishes last");
+
+            cout << "testTraversalStats Done!" << endl;
+        }
+
+        void testVisitor() {
+            TGraph g(true);
+            Node<int>* nodeArr[50];
+
+            for (int i = 0; i < 50; i++) {
+                nodeArr[i] = new Node<int>(i);
+                nodeArr[i]->populateNode(true);
+            }
+            g.createRandomGraph(50, nodeArr, 0.1, false, true);
+
+            CountingVisitor bfs;
+            g.breadthFirstVisit(*nodeArr[0], bfs);
+            ASSERT(bfs.grey > 0 && bfs.grey == bfs.black, "Every discovered node should be finished");
+
+            g.reset();
+            CountingVisitor dfs;
+            g.depthFirstVisit(dfs);
+            ASSERT(dfs.grey == g.getNodeCount(), "DFS should visit every node, visited:" << dfs.grey);
+            ASSERT(dfs.black == g.getNodeCount(), "DFS should finish every node");
+            ASSERT(dfs.edges == g.getEdgeCount(), "DFS should process every edge once, processed:" << dfs.edges);
+
+            cout << "testVisitor Done!" << endl;
+        }
+
+        void testWorkspace() {
+            TGraph g(false);
+            Node<int>* nodeArr[50];
+
+            for (int i = 0; i < 50; i++) {
+                nodeArr[i] = new Node<int>(i);
+                nodeArr[i]->populateNode(true);
+            }
+            g.createRandomGraph(50, nodeArr, 0.1, false, true);
+            const TGraph& cg = g;
+
+            TGraph::Workspace ws1, ws2;
+            cg.breadthFirstSearch(ws1, *nodeArr[0]);
+            cg.breadthFirstSearch(ws2, *nodeArr[1]);
+            g.breadthFirstSearch(*nodeArr[0]);
+            const TGraph::Workspace& state = g.getTraversalState();
+            for (int i = 0; i < g.getNodeCount(); i++) {
+                ASSERT(ws1.getColor(i) == TGraph::Workspace::BLACK, "Connected graph, every node should be reached");
+                ASSERT(ws1.getDist2Source(i) == state.getDist2Source(i), "Workspace and graph state should agree");
+                int parent = ws1.getParent(i);
+                ASSERT(parent == -1 || ws1.getDist2Source(parent) == ws1.getDist2Source(i) - 1, "Parent should be one level up");
+            }
+            for (int i = 0; i < g.getNodeCount(); i++) {
+                bool source = (g.begin() + i)->getId() == nodeArr[1]->getId();
+                ASSERT((ws2.getDist2Source(i) == 0) == source, "Only second source at level 0 in its workspace");
+            }
+
+            // Reusing a workspace starts over without stale state.
+            cg.depthFirstSearch(ws1);
+            for (int i = 0; i < g.getNodeCount(); i++) {
+                ASSERT(ws1.getDist2Source(i) == -1, "BFS distances should be gone after DFS");
+                ASSERT(ws1.getEntryTime(i) < ws1.getExitTime(i), "Entry before exit");
+            }
+            ws1.clear();
+            ASSERT(ws1.getColor(0) == TGraph::Workspace::WHITE, "Cleared workspace should read white");
+
+            cout << "testWorkspace Done!" << endl;
+        }
+
+        void testMultiSourceBFS() {
+            TGraph g(true);
+            Node<int>* nodeArr[300];
+
+            for (int i = 0; i < 300; i++) {
+                nodeArr[i] = new Node<int>(i);
+                nodeArr[i]->populateNode(true);
+            }
+            g.createRandomGraph(300, nodeArr, 0.01);
+
+            // More sources than one batch holds, plus an unknown id.
+            vector<int> sources;
+            for (int i = 0; i < 270; i++)
+                sources.push_back(nodeArr[(i * 13) % 300]->getId());
+            sources.push_back(-5);
+
+            vector<int> dist;
+            g.multiSourceBFS(sources, dist);
+            ASSERT(dist.size() == sources.size() * g.getNodeCount(), "One row per source");
+
+            TGraph::Workspace ws;
+            for (int i = 0; i < 270; i++) {
+                g.breadthFirstSearch(ws, *nodeArr[(i * 13) % 300]);
+                for (int v = 0; v < g.getNodeCount(); v++)
+                    ASSERT(dist[i * g.getNodeCount() + v] == ws.getDist2Source(v), "Should match single source BFS, source:" << i << " node:" << v);
+            }
+            for (int v = 0; v < g.getNodeCount(); v++)
+                ASSERT(dist[270 * g.getNodeCount() + v] == -1, "Unknown source reaches nothing");
+
+            cout << "testMultiSourceBFS Done!" << endl;
+        }
+
+        void testShortestPaths() {
+            int vals[4] = {0, 1, 2, 3};
+            Node<int>* nodeArr[4];
+            TGraph g(true);
+            for (int i = 0; i < 4; i++) {
+                nodeArr[i] = new Node<int>(vals[i]);
+                g.insertNode(*nodeArr[i]);
+            }
+            g.createEdge(*nodeArr[0], *nodeArr[1], 4);
+            g.createEdge(*nodeArr[0], *nodeArr[2], 1);
+            g.createEdge(*nodeArr[2], *nodeArr[1], 2);
+
+            vector<float> dist;
+            vector<int> parent;
+            g.shortestPaths(*nodeArr[0], dist, parent);
+            ASSERT(dist[0] == 0 && parent[0] == -1, "Source should be at distance 0");
+            ASSERT(dist[1] == 3 && parent[1] == 2, "Shorter path through node 2 expected, dist:" << dist[1]);
+            ASSERT(dist[2] == 1 && parent[2] == 0, "Direct edge expected");
+            ASSERT(dist[3] == -1 && parent[3] == -1, "Unreachable node should have dist -1");
+
+            cout << "testShortestPaths Done!" << endl;
         }
 
         void testTransposeUndirected() {
@@ -229,6 +802,18 @@ class TestGraph {
 
             ASSERT(*g == g2, "Transpose of transpose should be same");
 
+            // Both directions with equal weight used to lose an edge.
+            int vals[2] = {1, 2};
+            Node<int> a(vals[0]), b(vals[1]);
+            TGraph pair(true);
+            pair.insertNode(a);
+            pair.insertNode(b);
+            pair.createEdge(a, b, 3);
+            pair.createEdge(b, a, 3);
+            pair.transpose();
+            ASSERT(pair.getEdgeCount() == 2 && pair.getOutDegreeForNode(a) == 1 && pair.getInDegreeForNode(a) == 1, "Transpose should keep both edges");
+            checkStructure(pair);
+
             // Test tranpose
             std::cout << "testTransposeDirected Done!"<<endl;
         }
@@ -279,11 +864,25 @@ int main() {
     test.testInsertNode();
     test.testCreateUndirectedEdge();
     test.testCreateDirectedEdge();
+    test.testNeighbors();
+    test.testGetNodeByLabel();
+    test.testRemoveEdge();
+    test.testRemoveEdges();
+    test.testRemoveNode();
+    test.testCopyAndMove();
+    test.testFingerprint();
+    test.testReorder();
     test.testTransposeUndirected();
     test.testTransposeDirected();
     test.testReset(TestGraph::TGraph::HARD_RESET);
     test.testTopsort();
     test.testBFS();
+    test.testDFS();
+    test.testShortestPaths();
+    test.testTraversalStats();
+    test.testVisitor();
+    test.testWorkspace();
+    test.testMultiSourceBFS();
     test.testStronglyConnectedComponent();
     return 0;
 }
@@ -0,0 +1,195 @@
+#include<iostream>
+#include<math.h>
+#include "../../test/ASSERT.hpp"
+#include "node_fixture.hpp"
+#include "../graph/grid_graph.hpp"
+#include "../graph/condensation.hpp"
+
+using namespace std;
+
+class TestGridGraph : public NodeFixture<500> {
+    public:
+        typedef Graph<int> TGraph;
+
+        string path;
+
+        TestGridGraph() : path("test_grid_graph.grid") {}
+
+        ~TestGridGraph() {
+            remove(path.c_str());
+        }
+
+        void testBFS() {
+            int partitions[] = {1, 3, 8};
+            for (int round = 0; round < 6; round++) {
+                TGraph g(round % 2 == 0);
+                g.createRandomGraph(300, nodeArr, 0.01);
+                ASSERT(GridGraph::write(g, path, partitions[round / 2]), "Write should succeed");
+                GridGraph grid;
+                // Buffer of 8 edges, every block takes several reads.
+                ASSERT(grid.open(path, 64), "Open should succeed");
+                ASSERT(grid.getNodeCount() == g.getNodeCount() && grid.getEdgeCount() == g.getEdgeCount(), "Counts kept");
+                ASSERT(grid.isDirected() == g.isDirected() && grid.getPartitionCount() == partitions[round / 2], "Header kept");
+
+                TGraph::Workspace ws;
+                vector<int> dist;
+                typename TGraph::const_iterator node = g.cbegin();
+                for (int i = 0; i < g.getNodeCount(); i += 37, node += 37) {
+                    ASSERT(grid.indexOf(node->getId()) == i && grid.getOutDegree(i) == g.getOutDegreeAt(i), "Node arrays kept");
+                    grid.breadthFirstSearch(i, dist);
+                    g.breadthFirstSearch(ws, *node);
+                    for (int j = 0; j < g.getNodeCount(); j++)
+                        ASSERT(dist[j] == ws.getDist2Source(j), "BFS distance of " << j << " from " << i);
+                }
+            }
+            cout << "testBFS Done!" << endl;
+        }
+
+        void testComponents() {
+            for (int round = 0; round < 4; round++) {
+                TGraph g(false);
+                g.createRandomGraph(400, nodeArr, 0.004);
+                GridGraph::write(g, path, 4);
+                GridGraph grid;
+                grid.open(path, 1 << 10);
+                vector<int> component;
+                int count = grid.connectedComponents(component);
+                Condensation cond(g);
+                ASSERT(count == cond.getComponentCount(), "Component count, " << count << " vs " << cond.getComponentCount());
+                for (int i = 0; i < g.getNodeCount(); i++) {
+                    ASSERT(component[i] >= 0 && component[i] < count, "Dense component ids");
+                    ASSERT(component[i] == component[cond.membersBegin(cond.getComponentId(i))[0]], "Same components as Condensation");
+                }
+            }
+            cout << "testComponents Done!" << endl;
+        }
+
+        void testPageRank() {
+            TGraph g(true);
+            g.createRandomGraph(200, nodeArr, 0.02);
+            GridGraph::write(g, path, 5);
+            GridGraph grid;
+            grid.open(path, 1 << 12);
+            vector<double> rank;
+            grid.pageRank(rank, 30, 0.85);
+
+            // Same iteration in memory.
+            int n = g.getNodeCount();
+            vector<double> expected(n, 1.0 / n), next(n);
+            for (int iter = 0; iter < 30; iter++) {
+                double dangling = 0;
+                next.assign(n, 0);
+                for (int i = 0; i < n; i++) {
+                    if (g.getOutDegreeAt(i) == 0) {
+                        dangling += expected[i];
+                        continue;
+                    }
+                    EdgeRange<Edge> range = g.neighborsAt(i);
+                    for (EdgeRange<Edge>::iterator it = range.begin(); it != range.end(); ++it)
+                        next[it.otherIndex()] += expected[i] / g.getOutDegreeAt(i);
+                }
+                for (int i = 0; i < n; i++)
+                    expected[i] = (0.15 + 0.85 * dangling) / n + 0.85 * next[i];
+            }
+            double total = 0;
+            for (int i = 0; i < n; i++) {
+                ASSERT(fabs(rank[i] - expected[i]) < 1e-9, "Rank of " << i << ", " << rank[i] << " vs " << expected[i]);
+                total += rank[i];
+            }
+            ASSERT(fabs(total - 1) < 1e-9, "Ranks sum to one, got:" << total);
+            cout << "testPageRank Done!" << endl;
+        }
+
+        // Two paths in separate chunks: BFS on one never reads the other.
+        void testBuilder() {
+            GridGraph grid;
+            ASSERT(!grid.open("no_such_file.grid", 1024), "Missing file");
+
+            {
+                GridGraph::Builder builder(path, 8, false, 2);
+                for (int i = 0; i < 8; i++)
+                    builder.setNodeId(i, 100 + i);
+                builder.addEdge(0, 1); builder.addEdge(1, 2); builder.addEdge(2, 3);
+                builder.addEdge(5, 4); builder.addEdge(6, 5); builder.addEdge(7, 6);
+                ASSERT(builder.finish(), "Finish should succeed");
+            }
+            ASSERT(grid.open(path, 1024), "Open should succeed");
+            ASSERT(grid.getEdgeCount() == 6 && grid.indexOf(105) == 5 && grid.getOutDegree(5) == 2, "Builder arrays");
+            vector<int> dist;
+            grid.breadthFirstSearch(0, dist);
+            ASSERT(dist[3] == 3 && dist[4] == -1, "Distances on first path");
+            // Four passes, the last finds nothing, over the 6 edges of row 0.
+            ASSERT(grid.getBytesRead() == 4 * 6 * 8, "Only the first row is read, read:" << grid.getBytesRead());
+            grid.breadthFirstSearch(7, dist);
+            ASSERT(dist[4] == 3 && dist[0] == -1, "Distances on second path");
+
+            vector<int> component;
+            ASSERT(grid.connectedComponents(component) == 2 && component[3] == 0 && component[4] == 1, "Two components");
+            cout << "testBuilder Done!" << endl;
+        }
+
+        // Bad indices fail the builder, a truncated or damaged file fails
+        // the algorithms instead of feeding them stale edges.
+        void testDamaged() {
+            {
+                GridGraph::Builder builder(path, 4, true, 2);
+                builder.addEdge(0, 4);
+                ASSERT(!builder.finish(), "Target out of range");
+            }
+            {
+                GridGraph::Builder builder(path, 4, true, 2);
+                builder.setNodeId(-1, 7);
+                ASSERT(!builder.finish(), "Node index out of range");
+            }
+            {
+                GridGraph::Builder builder(path, 8, false, 2);
+                builder.addEdge(0, 1); builder.addEdge(1, 2); builder.addEdge(2, 3);
+                builder.addEdge(5, 4); builder.addEdge(6, 5); builder.addEdge(7, 6);
+                ASSERT(builder.finish(), "Finish should succeed");
+            }
+            string bytes;
+            {
+                ifstream in(path.c_str(), ios::binary);
+                stringstream ss;
+                ss << in.rdbuf();
+                bytes = ss.str();
+            }
+
+            // Drop the last edge, it is in the last row.
+            {
+                ofstream out(path.c_str(), ios::binary | ios::trunc);
+                out.write(bytes.data(), bytes.size() - 8);
+            }
+            GridGraph grid;
+            vector<int> dist, component;
+            vector<double> rank;
+            ASSERT(grid.open(path, 1024), "Header is intact");
+            ASSERT(grid.breadthFirstSearch(0, dist) && dist[3] == 3, "First row still reads");
+            ASSERT(!grid.breadthFirstSearch(7, dist), "Short read on the last row");
+            ASSERT(grid.connectedComponents(component) == -1, "Components see the short read");
+            ASSERT(!grid.pageRank(rank, 5, 0.85), "PageRank sees the short read");
+
+            // Point the last edge at a node that does not exist.
+            {
+                string damaged = bytes;
+                int32_t bad = 8;
+                memcpy(&damaged[damaged.size() - 4], &bad, sizeof(bad));
+                ofstream out(path.c_str(), ios::binary | ios::trunc);
+                out.write(damaged.data(), damaged.size());
+            }
+            ASSERT(grid.open(path, 1024), "Header is intact");
+            ASSERT(!grid.breadthFirstSearch(7, dist), "Edge end out of range");
+            ASSERT(grid.connectedComponents(component) == -1, "Components see the bad edge");
+            cout << "testDamaged Done!" << endl;
+        }
+};
+
+int main() {
+    TestGridGraph test;
+    test.testBFS();
+    test.testComponents();
+    test.testPageRank();
+    test.testBuilder();
+    test.testDamaged();
+    return 0;
+}
@@ -0,0 +1,126 @@
+#include<iostream>
+#include<math.h>
+#include "../../test/ASSERT.hpp"
+#include "node_fixture.hpp"
+#include "../graph/max_flow.hpp"
+
+using namespace std;
+
+class TestMaxFlow : public NodeFixture<200> {
+    public:
+        typedef Graph<int> TGraph;
+
+        // Edmonds Karp on a capacity matrix.
+        double expectedFlow(const TGraph& g, int source, int sink) {
+            int n = g.getNodeCount();
+            vector< vector<double> > residual(n, vector<double>(n, 0));
+            for (int u = 0; u < n; u++) {
+                EdgeRange<const Edge> range = g.neighborsAt(u);
+                for (EdgeRange<const Edge>::iterator it = range.begin(); it != range.end(); ++it)
+                    residual[u][it.otherIndex()] += it->getWeight();
+            }
+            double total = 0;
+            while (true) {
+                vector<int> parent(n, -1);
+                parent[source] = source;
+                vector<int> bfs(1, source);
+                for (size_t head = 0; head < bfs.size() && parent[sink] == -1; head++)
+                    for (int v = 0; v < n; v++)
+                        if (parent[v] == -1 && residual[bfs[head]][v] > 0) {
+                            parent[v] = bfs[head];
+                            bfs.push_back(v);
+                        }
+                if (parent[sink] == -1)
+                    return total;
+                double push = 1e300;
+                for (int v = sink; v != source; v = parent[v])
+                    push = min(push, residual[parent[v]][v]);
+                for (int v = sink; v != source; v = parent[v]) {
+                    residual[parent[v]][v] -= push;
+                    residual[v][parent[v]] += push;
+                }
+                total += push;
+            }
+        }
+
+        // Capacities hold, flow is conserved away from the terminals and
+        // the cut arcs separate source from sink with capacity = flow.
+        void checkFlow(const MaxFlow& flow, int source, int sink) {
+            int n = flow.getNodeCount();
+            vector<double> balance(n, 0);
+            for (int u = 0; u < n; u++) {
+                for (int pos = flow.getArcOffset(u); pos < flow.getArcOffset(u + 1); pos++) {
+                    ASSERT(flow.getResidual(pos) >= 0, "Residual must not be negative");
+                    ASSERT(flow.getFlow(pos) == -flow.getFlow(flow.getReverse(pos)), "Pair is skew symmetric");
+                    if (flow.getEdgeId(pos) != -1) {
+                        balance[u] -= flow.getFlow(pos);
+                        balance[flow.getArcHead(pos)] += flow.getFlow(pos);
+                    }
+                }
+            }
+            for (int u = 0; u < n; u++)
+                if (u != source && u != sink)
+                    ASSERT(fabs(balance[u]) < 1e-9, "Flow conserved at " << u << ":" << balance[u]);
+            ASSERT(fabs(balance[sink] - flow.getFlowValue()) < 1e-9, "Sink receives the flow value");
+
+            ASSERT(flow.isSourceSide(source) && !flow.isSourceSide(sink), "Cut separates terminals");
+            vector<int> arcs;
+            flow.getCutArcs(arcs);
+            double capacity = 0;
+            for (size_t i = 0; i < arcs.size(); i++) {
+                capacity += flow.getCapacity(arcs[i]);
+                ASSERT(flow.getResidual(arcs[i]) == 0, "Cut arcs are saturated");
+            }
+            ASSERT(fabs(capacity - flow.getFlowValue()) < 1e-9, "Cut capacity equals flow, " << capacity << " vs " << flow.getFlowValue());
+        }
+
+        void testSmall() {
+            // Classic example, max flow 23.
+            TGraph g(true);
+            for (int i = 0; i < 6; i++)
+                g.insertNode(*nodeArr[i]);
+            link(g, 0, 1, 16); link(g, 0, 2, 13); link(g, 1, 2, 10); link(g, 2, 1, 4);
+            link(g, 1, 3, 12); link(g, 3, 2, 9); link(g, 2, 4, 14); link(g, 4, 3, 7);
+            link(g, 3, 5, 20); link(g, 4, 5, 4);
+            MaxFlow flow(g);
+            int s = g.indexOf(nodeArr[0]->getId()), t = g.indexOf(nodeArr[5]->getId());
+            ASSERT(flow.solve(s, t) == 23, "Max flow 23, got:" << flow.getFlowValue());
+            checkFlow(flow, s, t);
+            ASSERT(flow.solve(s, t, MaxFlow::FIFO) == 23, "FIFO max flow 23");
+            checkFlow(flow, s, t);
+            ASSERT(flow.solve(t, s) == 0, "Nothing flows back");
+            ASSERT(flow.solve(s, s) == 0, "Same terminals");
+            cout << "testSmall Done!" << endl;
+        }
+
+        void testRandom() {
+            srand(3);
+            for (int round = 0; round < 12; round++) {
+                TGraph g(round % 3 != 0);
+                int n = 20 + 15 * (round % 4);
+                for (int i = 0; i < n; i++)
+                    g.insertNode(*nodeArr[i]);
+                for (int u = 0; u < n; u++)
+                    for (int v = g.isDirected() ? 0 : u + 1; v < n; v++)
+                        if (u != v && rand() % 6 == 0)
+                            link(g, u, v, 1 + rand() % 20);
+                MaxFlow flow(g);
+                for (int pair = 0; pair < 3; pair++) {
+                    int s = rand() % n, t = (s + 1 + rand() % (n - 1)) % n;
+                    double expected = expectedFlow(g, s, t);
+                    ASSERT(flow.solve(s, t, MaxFlow::HIGHEST_LABEL) == expected, "Highest label flow, " << flow.getFlowValue() << " vs " << expected);
+                    checkFlow(flow, s, t);
+                    ASSERT(flow.solve(s, t, MaxFlow::FIFO) == expected, "FIFO flow, " << flow.getFlowValue() << " vs " << expected);
+                    checkFlow(flow, s, t);
+                }
+            }
+            cout << "testRandom Done!" << endl;
+        }
+};
+
+int main() {
+    TestMaxFlow test;
+    test.testSmall();
+    test.testRandom();
+    return 0;
+}
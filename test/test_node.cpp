@@ -44,9 +44,62 @@ class TestNode {
 
                 node3 = node2;
                 ASSERT(node == node3, "Assignment Operator should give same object");
+                ASSERT(&node.getLabel() == &node3.getLabel(), "Copies should share the interned label");
             }
             cout << "testNodeCopy Done!" << endl;
         }
+
+        // A label lives as long as some node holds it.
+        void testLabelRelease() {
+            size_t before = LabelPool::shared().size();
+            int val = 1;
+            {
+                Node<int> node(val, "released");
+                Node<int> copy(node);
+                Node<int> other(val);
+                other = node;
+                ASSERT(LabelPool::shared().size() == before + 1, "Equal labels stored once");
+                other.setLabel("renamed");
+                other = other;
+                ASSERT(other.getLabel() == "renamed" && LabelPool::shared().size() == before + 2, "Relabelled node");
+            }
+            ASSERT(LabelPool::shared().size() == before, "Labels freed with their nodes, size:" << LabelPool::shared().size());
+            cout << "testLabelRelease Done!" << endl;
+        }
+
+        // Freed slots are reused and the table keeps finding the labels
+        // that stay while others leave.
+        void testLabelSlots() {
+            ASSERT(sizeof(LabelPool::Handle) == 4, "Handles are 32 bit");
+            size_t before = LabelPool::shared().size();
+            int val = 0;
+            vector<Node<int>*> nodes;
+            for (int i = 0; i < 5000; i++)
+                nodes.push_back(new Node<int>(val, "slot" + to_string(i)));
+            LabelPool::Handle highest = 0;
+            for (int i = 0; i < 5000; i++)
+                highest = max(highest, nodes[i]->getLabelHandle());
+            for (int i = 0; i < 5000; i += 2) {
+                delete nodes[i];
+                nodes[i] = NULL;
+            }
+            ASSERT(LabelPool::shared().size() == before + 2500, "Half the labels left");
+            for (int i = 1; i < 5000; i += 2) {
+                Node<int> same(val, "slot" + to_string(i));
+                ASSERT(same.getLabelHandle() == nodes[i]->getLabelHandle(), "Label still interned i:" << i);
+                ASSERT(nodes[i]->getLabel() == "slot" + to_string(i), "Label text kept i:" << i);
+            }
+            // Same labels land in the same shards, whose slots were freed.
+            for (int i = 0; i < 5000; i += 2) {
+                nodes[i] = new Node<int>(val, "slot" + to_string(i));
+                ASSERT(nodes[i]->getLabelHandle() <= highest, "Freed slots are reused");
+                ASSERT(nodes[i]->getLabel() == "slot" + to_string(i), "New label text i:" << i);
+            }
+            for (int i = 0; i < 5000; i++)
+                delete nodes[i];
+            ASSERT(LabelPool::shared().size() == before, "All labels freed");
+            cout << "testLabelSlots Done!" << endl;
+        }
     };
 
 int main() {
@@ -54,6 +107,8 @@ int main() {
     testNode.testUnlabelledNode();
     testNode.testLabelledNode();
     testNode.testNodeCopy();
+    testNode.testLabelRelease();
+    testNode.testLabelSlots();
 
  //   EdgeTest().testEdge();
 }
@@ -0,0 +1,138 @@
+#include<iostream>
+#include "../../test/ASSERT.hpp"
+#include "node_fixture.hpp"
+#include "../graph/partitioner.hpp"
+
+using namespace std;
+
+class TestPartitioner : public NodeFixture<1024> {
+    public:
+        typedef Graph<int> TGraph;
+
+        // side x side grid, node r * side + c.
+        void makeGrid(TGraph& g, int side) {
+            for (int i = 0; i < side * side; i++)
+                g.insertNode(*nodeArr[i]);
+            for (int r = 0; r < side; r++)
+                for (int c = 0; c < side; c++) {
+                    if (c + 1 < side)
+                        link(g, r * side + c, r * side + c + 1);
+                    if (r + 1 < side)
+                        link(g, r * side + c, (r + 1) * side + c);
+                }
+        }
+
+        // Checks parts are in range and balanced and that cut is the
+        // number of edges between parts.
+        void checkPartition(const TGraph& g, const Partitioner& partitioner, const vector<int>& parts, int cut) {
+            int n = g.getNodeCount();
+            int k = partitioner.getPartCount();
+            ASSERT((int)parts.size() == n, "One part per node");
+            vector<int> sizes(k, 0);
+            for (int i = 0; i < n; i++) {
+                ASSERT(parts[i] >= 0 && parts[i] < k, "Part out of range:" << parts[i]);
+                sizes[parts[i]]++;
+            }
+            int average = (n + k - 1) / k;
+            for (int p = 0; p < k; p++)
+                ASSERT(sizes[p] <= (1 + partitioner.getImbalance()) * average, "Part " << p << " too big:" << sizes[p]);
+
+            int counted = 0;
+            for (int i = 0; i < n; i++) {
+                EdgeRange<const Edge> range = g.neighborsAt(i);
+                for (EdgeRange<const Edge>::iterator it = range.begin(); it != range.end(); ++it)
+                    counted += parts[i] != parts[it.otherIndex()];
+            }
+            if (!g.isDirected())
+                counted /= 2;
+            ASSERT(counted == cut, "Cut should count crossing edges, " << counted << " vs " << cut);
+        }
+
+        void testGrid() {
+            TGraph g(false);
+            makeGrid(g, 32);
+            Partitioner partitioner(4, 0.03);
+            vector<int> parts;
+            int cut = partitioner.partition(g, parts);
+            checkPartition(g, partitioner, parts, cut);
+            // Four quadrants cut 64 edges.
+            ASSERT(cut <= 96, "Grid cut too large:" << cut);
+
+            Partitioner halves(2, 0.0);
+            cut = halves.partition(g, parts);
+            checkPartition(g, halves, parts, cut);
+            ASSERT(cut <= 48, "Bisection cut too large:" << cut);
+            cout << "testGrid Done!" << endl;
+        }
+
+        // Dense clusters joined by single directed edges, in both
+        // directions between neighbouring clusters.
+        void testClusters() {
+            TGraph g(true);
+            int clusters = 8, size = 32;
+            for (int i = 0; i < clusters * size; i++)
+                g.insertNode(*nodeArr[i]);
+            srand(7);
+            for (int c = 0; c < clusters; c++) {
+                for (int i = 0; i < size; i++)
+                    for (int j = 0; j < size; j++)
+                        if (i != j && rand() % 4 == 0)
+                            link(g, c * size + i, c * size + j);
+                int next = (c + 1) % clusters;
+                link(g, c * size, next * size + 1);
+                link(g, next * size + 2, c * size + 3);
+            }
+
+            Partitioner partitioner(clusters, 0.05);
+            vector<int> parts;
+            int cut = partitioner.partition(g, parts);
+            checkPartition(g, partitioner, parts, cut);
+            ASSERT(cut == 2 * clusters, "Clusters should be found, cut:" << cut);
+            for (int c = 0; c < clusters; c++)
+                for (int i = 1; i < size; i++)
+                    ASSERT(parts[c * size + i] == parts[c * size], "Cluster split");
+            cout << "testClusters Done!" << endl;
+        }
+
+        void testLabelPropagation() {
+            TGraph g(false);
+            makeGrid(g, 32);
+            Partitioner partitioner(4, 0.03);
+            vector<int> parts;
+            for (int seed = 1; seed <= 3; seed++) {
+                partitioner.setSeed(seed);
+                int cut = partitioner.partition(g, parts, Partitioner::LABEL_PROPAGATION);
+                checkPartition(g, partitioner, parts, cut);
+                // A random assignment cuts three quarters.
+                ASSERT(cut < g.getEdgeCount() / 6, "Label propagation cut too large:" << cut);
+                int again = partitioner.partition(g, parts, Partitioner::LABEL_PROPAGATION);
+                ASSERT(again == cut, "Same seed should give same partition");
+            }
+            cout << "testLabelPropagation Done!" << endl;
+        }
+
+        void testSmall() {
+            TGraph g(false);
+            vector<int> parts;
+            Partitioner partitioner(4, 0.03);
+            ASSERT(partitioner.partition(g, parts) == 0 && parts.empty(), "Empty graph");
+
+            makeGrid(g, 2);
+            int cut = partitioner.partition(g, parts);
+            checkPartition(g, partitioner, parts, cut);
+            ASSERT(cut == 4, "One node per part cuts every edge");
+
+            Partitioner one(1, 0.0);
+            ASSERT(one.partition(g, parts) == 0, "Single part has no cut");
+            cout << "testSmall Done!" << endl;
+        }
+};
+
+int main() {
+    TestPartitioner test;
+    test.testGrid();
+    test.testClusters();
+    test.testLabelPropagation();
+    test.testSmall();
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include<iostream>
+#include "../../test/ASSERT.hpp"
+#include "../graph/query_engine.hpp"
+
+using namespace std;
+
+class TestQueryEngine {
+    public:
+        typedef Graph<int> TGraph;
+        typedef QueryEngine< Node<int> > TEngine;
+
+        Node<int>* nodeArr[100];
+        TGraph* g;
+
+        TestQueryEngine() {
+            g = new TGraph(false);
+            for (int i = 0; i < 100; i++) {
+                nodeArr[i] = new Node<int>(i);
+                nodeArr[i]->populateNode(true);
+            }
+            g->createRandomGraph(100, nodeArr, 0.02, false, true);
+        }
+
+        void testDistances() {
+            TEngine engine(*g, 4);
+            vector< pair<int, int> > queries;
+            for (int i = 0; i < 100; i++)
+                queries.push_back(make_pair(nodeArr[i]->getId(), nodeArr[(i * 7) % 100]->getId()));
+
+            vector< future<int> > results = engine.distances(queries);
+            for (int i = 0; i < 100; i++) {
+                TGraph::Workspace ws;
+                g->breadthFirstSearch(ws, *nodeArr[i]);
+                int target = g->indexOf(queries[i].second);
+                int got = results[i].get();
+                ASSERT(got == ws.getDist2Source(target), "Distance should match serial BFS, query:" << i << " got:" << got);
+            }
+
+            ASSERT(engine.distance(nodeArr[0]->getId(), nodeArr[0]->getId()).get() == 0, "Source is at distance 0");
+            ASSERT(engine.distance(-5, nodeArr[0]->getId()).get() == -1, "Unknown id should give -1");
+            ASSERT(engine.reachable(nodeArr[3]->getId(), nodeArr[97]->getId()).get(), "Connected graph, all reachable");
+            cout << "testDistances Done!" << endl;
+        }
+
+        void testLevels() {
+            TEngine engine(*g, 2);
+            vector< future< vector<int> > > results;
+            for (int i = 0; i < 10; i++)
+                results.push_back(engine.levels(nodeArr[i]->getId()));
+            for (int i = 0; i < 10; i++) {
+                vector<int> levels = results[i].get();
+                ASSERT((int)levels.size() == g->getNodeCount(), "One level per node");
+                ASSERT(levels[g->indexOf(nodeArr[i]->getId())] == 0, "Source at level 0");
+            }
+            ASSERT(engine.levels(-5).get().empty(), "Unknown id should give no levels");
+            cout << "testLevels Done!" << endl;
+        }
+
+        void testSubmit() {
+            TEngine engine(*g, 3);
+            future<int> count = engine.submit([](const TGraph::GraphBase& graph, TEngine::Workspace& ws) {
+                graph.depthFirstSearch(ws);
+                int roots = 0;
+                for (int i = 0; i < graph.getNodeCount(); i++)
+                    if (ws.getParent(i) == -1)
+                        roots++;
+                return roots;
+            });
+            ASSERT(count.get() == 1, "Connected graph has one DFS tree");
+            cout << "testSubmit Done!" << endl;
+        }
+};
+
+int main() {
+    TestQueryEngine test;
+    test.testDistances();
+    test.testLevels();
+    test.testSubmit();
+    return 0;
+}
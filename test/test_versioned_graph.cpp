@@ -0,0 +1,241 @@
+#include<iostream>
+#include<thread>
+#include<set>
+#include<stdlib.h>
+#include "../../test/ASSERT.hpp"
+#include "node_fixture.hpp"
+#include "../graph/versioned_graph.hpp"
+
+using namespace std;
+
+// Plain graph receiving the same changes, to check versions against.
+class Reference : public GraphBase< Node<int> > {
+    public:
+        Reference(bool directed) : GraphBase< Node<int> >(directed) {}
+};
+
+class TestVersionedGraph : public NodeFixture<1200> {
+    public:
+        typedef VersionedGraph< Node<int> > TGraph;
+
+        // Same nodes, and out neighbour ids with weights, per node id.
+        bool sameGraph(const TGraph::Snapshot& snap, const Reference& ref) {
+            if (snap.getNodeCount() != ref.getNodeCount() || snap.getEdgeCount() != ref.getEdgeCount())
+                return false;
+            for (int idx = 0; idx < snap.getNodeCount(); idx++) {
+                int id = snap.getNodeId(idx);
+                if (snap.indexOf(id) != idx || ref.indexOf(id) == -1)
+                    return false;
+                multiset< pair<int, float> > got, want;
+                for (const int* it = snap.neighborsBegin(idx); it != snap.neighborsEnd(idx); it++)
+                    got.insert(make_pair(snap.getNodeId(*it), snap.weightsBegin(idx)[it - snap.neighborsBegin(idx)]));
+                EdgeRange<const Edge> range = ref.neighborsAt(ref.indexOf(id));
+                for (EdgeRange<const Edge>::iterator it = range.begin(); it != range.end(); ++it)
+                    want.insert(make_pair((ref.cbegin() + it.otherIndex())->getId(), it->getWeight()));
+                if (got != want)
+                    return false;
+            }
+            return true;
+        }
+
+        // Path 0 - 1 - ... - n-1
+        void addPath(TGraph& g, int n) {
+            TGraph::Batch batch;
+            for (int i = 0; i < n; i++)
+                batch.insertNode(*nodeArr[i]);
+            for (int i = 0; i + 1 < n; i++)
+                batch.createEdge(nodeArr[i]->getId(), nodeArr[i + 1]->getId());
+            g.apply(batch);
+        }
+
+        void testSnapshotIsolation() {
+            TGraph g(false);
+            ASSERT(g.getVersion() == 0 && g.pin().getGraph().getNodeCount() == 0, "Starts with empty version 0");
+
+            addPath(g, 10);
+            TGraph::Pin before = g.pin();
+            ASSERT(before.getVersion() == 1, "One batch applied");
+            ASSERT(before.getGraph().getEdgeCount() == 9, "Path has 9 edges");
+
+            TGraph::Batch cut;
+            cut.removeEdge(nodeArr[4]->getId(), nodeArr[5]->getId());
+            cut.removeNode(nodeArr[9]->getId());
+            cut.createEdge(nodeArr[0]->getId(), nodeArr[8]->getId(), 2.5);
+            ASSERT(g.apply(cut) == 2, "Second version");
+
+            // Pinned version does not see the batch.
+            const TGraph::Snapshot& old = before.getGraph();
+            vector<int> dist;
+            old.breadthFirstSearch(old.indexOf(nodeArr[0]->getId()), dist);
+            ASSERT(dist[old.indexOf(nodeArr[9]->getId())] == 9, "Old version keeps the whole path");
+            ASSERT(g.getRetiredCount() == 1, "Pinned version must not be freed");
+
+            TGraph::Pin after = g.pin();
+            const TGraph::Snapshot& now = after.getGraph();
+            ASSERT(now.getNodeCount() == 9 && now.indexOf(nodeArr[9]->getId()) == -1, "Node 9 removed");
+            now.breadthFirstSearch(now.indexOf(nodeArr[0]->getId()), dist);
+            ASSERT(dist[now.indexOf(nodeArr[8]->getId())] == 1, "New shortcut visible");
+            ASSERT(dist[now.indexOf(nodeArr[5]->getId())] == 4, "Path cut at 4 - 5, reached through 8");
+            cout << "testSnapshotIsolation Done!" << endl;
+        }
+
+        // Random batches of inserts and removals, each version checked
+        // against a plain graph given the same changes. Nodes far from a
+        // batch keep the lists of the previous version.
+        void testBlockSharing() {
+            bool directed[] = {false, true};
+            for (int d = 0; d < 2; d++) {
+                TGraph g(directed[d]);
+                Reference ref(directed[d]);
+                vector<int> live;
+                int next = 0;
+                srand(7);
+                for (int round = 0; round < 40; round++) {
+                    TGraph::Batch batch;
+                    for (int k = 0; k < 30 && next < 1200; k++, next++) {
+                        batch.insertNode(*nodeArr[next]);
+                        ref.insertNode(*nodeArr[next]);
+                        live.push_back(next);
+                    }
+                    for (int k = 0; k < 60; k++) {
+                        int a = live[rand() % live.size()], b = live[rand() % live.size()];
+                        batch.createEdge(nodeArr[a]->getId(), nodeArr[b]->getId(), k);
+                        link(ref, a, b, k);
+                    }
+                    for (int k = 0; k < 10; k++) {
+                        int a = live[rand() % live.size()], b = live[rand() % live.size()];
+                        batch.removeEdge(nodeArr[a]->getId(), nodeArr[b]->getId());
+                        ref.removeEdge(ref.getNodeById(nodeArr[a]->getId()), ref.getNodeById(nodeArr[b]->getId()));
+                    }
+                    for (int k = 0; k < 5; k++) {
+                        int pos = rand() % live.size();
+                        batch.removeNode(nodeArr[live[pos]]->getId());
+                        ref.removeNode(ref.getNodeById(nodeArr[live[pos]]->getId()));
+                        live[pos] = live.back();
+                        live.pop_back();
+                    }
+                    g.apply(batch);
+                    ASSERT(sameGraph(g.pin().getGraph(), ref), "Version " << g.getVersion() << " should match, directed:" << d);
+                }
+                // One removal per batch, so only its own blocks are rebuilt.
+                for (int round = 0; round < 40; round++) {
+                    TGraph::Batch batch;
+                    int pos = rand() % live.size();
+                    batch.removeNode(nodeArr[live[pos]]->getId());
+                    ref.removeNode(ref.getNodeById(nodeArr[live[pos]]->getId()));
+                    live[pos] = live.back();
+                    live.pop_back();
+                    g.apply(batch);
+                    ASSERT(sameGraph(g.pin().getGraph(), ref), "Version " << g.getVersion() << " should match after one removal, directed:" << d);
+                }
+
+                TGraph::Pin before = g.pin();
+                TGraph::Batch one;
+                one.createEdge(nodeArr[live[0]]->getId(), nodeArr[live[0]]->getId());
+                g.apply(one);
+                TGraph::Pin after = g.pin();
+                int far = after.getGraph().getNodeCount() - 1;
+                int changed = after.getGraph().indexOf(nodeArr[live[0]]->getId());
+                ASSERT(changed / TGraph::BLOCK_NODES != far / TGraph::BLOCK_NODES, "Test needs nodes in two blocks");
+                ASSERT(before.getGraph().neighborsBegin(far) == after.getGraph().neighborsBegin(far), "Untouched block should be shared");
+                ASSERT(before.getGraph().neighborsBegin(changed) != after.getGraph().neighborsBegin(changed), "Touched block should be copied");
+            }
+            cout << "testBlockSharing Done!" << endl;
+        }
+
+        // Pins past the reader slots go to the overflow slot and still
+        // hold their version.
+        void testOverflowPins() {
+            TGraph g(true);
+            addPath(g, 3);
+            {
+                vector<TGraph::Pin> slotted, extra;
+                for (int i = 0; i < TGraph::MAX_READERS; i++)
+                    slotted.push_back(g.pin());
+                for (int i = 0; i < 20; i++)
+                    extra.push_back(g.pin());
+                TGraph::Batch batch;
+                batch.removeNode(nodeArr[2]->getId());
+                g.apply(batch);
+                ASSERT(g.getRetiredCount() == 1, "Version held by overflow pins must be kept");
+                ASSERT(extra.back().getGraph().getNodeCount() == 3, "Overflow pin keeps its version");
+
+                // Slots freed, the overflow pins keep everything retired
+                // since they joined.
+                slotted.clear();
+                g.apply(TGraph::Batch());
+                ASSERT(g.getRetiredCount() == 2, "Versions retired after the overflow pins must be kept, retired:" << g.getRetiredCount());
+            }
+            g.apply(TGraph::Batch());
+            ASSERT(g.getRetiredCount() == 0, "Released versions should be freed");
+            cout << "testOverflowPins Done!" << endl;
+        }
+
+        void testReclamation() {
+            TGraph g(true);
+            addPath(g, 5);
+            {
+                TGraph::Pin pin = g.pin();
+                TGraph::Batch batch;
+                batch.createEdge(nodeArr[4]->getId(), nodeArr[0]->getId());
+                g.apply(batch);
+                ASSERT(g.getRetiredCount() == 1, "Held version retired but kept");
+            }
+            TGraph::Batch empty;
+            g.apply(empty);
+            ASSERT(g.getRetiredCount() == 0, "Released versions should be freed");
+            cout << "testReclamation Done!" << endl;
+        }
+
+        // Readers check every version they pin is a path of that many
+        // nodes while the writer keeps growing it.
+        void testConcurrentReaders() {
+            TGraph g(false);
+            addPath(g, 2);
+            atomic<bool> done(false);
+            atomic<int> failures(0);
+
+            vector<thread> readers;
+            for (int r = 0; r < 4; r++) {
+                readers.push_back(thread([&g, &done, &failures]() {
+                    vector<int> dist;
+                    while (!done.load()) {
+                        TGraph::Pin pin = g.pin();
+                        const TGraph::Snapshot& graph = pin.getGraph();
+                        int n = graph.getNodeCount();
+                        if (n != (int)pin.getVersion() + 1 || graph.getEdgeCount() != n - 1)
+                            failures++;
+                        // Unpinned read, never behind what is pinned.
+                        if (g.getVersion() < pin.getVersion())
+                            failures++;
+                        graph.breadthFirstSearch(0, dist);
+                        for (int i = 0; i < n; i++)
+                            if (dist[i] < 0)
+                                failures++;
+                    }
+                }));
+            }
+
+            for (int i = 2; i < 200; i++) {
+                TGraph::Batch batch;
+                batch.insertNode(*nodeArr[i]);
+                batch.createEdge(nodeArr[i - 1]->getId(), nodeArr[i]->getId());
+                g.apply(batch);
+            }
+            done.store(true);
+            for (size_t r = 0; r < readers.size(); r++)
+                readers[r].join();
+            ASSERT(failures.load() == 0, "Readers should only see whole versions, failures:" << failures.load());
+            cout << "testConcurrentReaders Done!" << endl;
+        }
+};
+
+int main() {
+    TestVersionedGraph test;
+    test.testSnapshotIsolation();
+    test.testReclamation();
+    test.testBlockSharing();
+    test.testOverflowPins();
+    test.testConcurrentReaders();
+    return 0;
+}